@@ -319,16 +319,16 @@ static void DisplayConstantTab(AddonImGui::AddonUIData& instance, ShaderToggler:
             ImGui::SameLine();
             ImGui::InputText("Offset", offsetInputBuf, offsetInputBufSize, ImGuiInputTextFlags_CharsHexadecimal);
 
-            static bool prevValue = false;
+            static int prevValue = 0;
 
-            ImGui::Checkbox("Use previous value", &prevValue);
+            ImGui::SliderInt("Previous value", &prevValue, 0, Shim::Constants::MAX_CONSTANT_HISTORY, "%d frames back", ImGuiSliderFlags_AlwaysClamp);
 
             ImGui::Separator();
 
             ImGui::SetCursorPosX(ImGui::GetWindowWidth() / 2 - 120 - ImGui::GetStyle().ItemSpacing.x / 2 - ImGui::GetStyle().FramePadding.x / 2);
             if (ImGui::Button("OK", ImVec2(120, 0))) {
                 if (varSelectedItem.size() > 0) {
-                    group->SetVarMapping(std::stoul(std::string(offsetInputBuf), nullptr, 16), varSelectedItem, prevValue);
+                    group->SetVarMapping(std::stoul(std::string(offsetInputBuf), nullptr, 16), varSelectedItem, static_cast<uint32_t>(prevValue));
                 }
                 ImGui::CloseCurrentPopup();
             }
@@ -341,7 +341,7 @@ static void DisplayConstantTab(AddonImGui::AddonUIData& instance, ShaderToggler:
             ImGui::EndPopup();
         }
 
-        const char* varColumns[] = { "Variable", "Offset", "Type", "Use Previous Value" };
+        const char* varColumns[] = { "Variable", "Offset", "Type", "Frames Back" };
         std::vector<std::string> removal;
 
         if (varMap.size() > 0 &&
@@ -357,7 +357,7 @@ static void DisplayConstantTab(AddonImGui::AddonUIData& instance, ShaderToggler:
             for (const auto& [varName, varData] : varMap) {
                 if (!instance.GetRESTVariables()->contains(varName))
                     continue;
-                const auto& [varOffset, varEnabled] = varData;
+                const auto& [varOffset, varFramesBack] = varData;
                 ImGui::TableNextColumn();
                 ImGui::Text(varName.c_str());
                 ImGui::TableNextColumn();
@@ -365,7 +365,7 @@ static void DisplayConstantTab(AddonImGui::AddonUIData& instance, ShaderToggler:
                 ImGui::TableNextColumn();
                 ImGui::Text(Shim::Constants::type_desc[static_cast<uint32_t>(std::get<0>(instance.GetRESTVariables()->at(varName)))]);
                 ImGui::TableNextColumn();
-                ImGui::Text(std::format("{}", varEnabled).c_str());
+                ImGui::Text(std::format("{}", varFramesBack).c_str());
                 ImGui::TableNextColumn();
                 if (ImGui::Button(std::format("Remove##{}", varName).c_str())) {
                     removal.push_back(varName);
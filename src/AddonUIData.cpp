@@ -81,13 +81,15 @@ void AddonUIData::SignalToggleGroupRemoved(reshade::api::effect_runtime* runtime
     {
         func(runtime, group);
     }
+
+    ToggleGroup::releaseGroupIndex(group->getIndex());
 }
 
-void AddonUIData::AssignPreferredGroupTechniques(std::unordered_map<std::string, EffectData>& allTechniques)
+void AddonUIData::AssignPreferredGroupTechniques(std::unordered_map<std::string, EffectData>& allTechniques, const std::vector<EffectData*>& allSortedTechniques)
 {
     for (auto& it : _toggleGroups)
     {
-        it.second.AssignPreferredTechniqueData(allTechniques);
+        it.second.AssignPreferredTechniqueData(allTechniques, allSortedTechniques);
     }
 }
 
@@ -127,8 +129,97 @@ const vector<ToggleGroup*>* AddonUIData::GetToggleGroupsForComputeShaderHash(uin
     return nullptr;
 }
 
+void AddonUIData::AddPipelineDispatchData(uint64_t pipelineHandle, uint32_t psHash, uint32_t vsHash, uint32_t csHash)
+{
+    if (pipelineHandle == 0 || (psHash == 0 && vsHash == 0 && csHash == 0))
+    {
+        return;
+    }
+
+    unique_ptr<PipelineDispatchRecord> record = make_unique<PipelineDispatchRecord>();
+    record->psHash = psHash;
+    record->vsHash = vsHash;
+    record->csHash = csHash;
+
+    unique_lock<mutex> lock(_pipelineDispatchMutex);
+
+    record->psGroups = psHash > 0 ? GetToggleGroupsForPixelShaderHash(psHash) : nullptr;
+    record->vsGroups = vsHash > 0 ? GetToggleGroupsForVertexShaderHash(vsHash) : nullptr;
+    record->csGroups = csHash > 0 ? GetToggleGroupsForComputeShaderHash(csHash) : nullptr;
+
+    _pipelineDispatchData.insert_or_assign(pipelineHandle, record.get());
+
+    // Handles can be reused by the application, readers might still be looking at the record previously stored for it
+    unique_ptr<PipelineDispatchRecord>& owner = _pipelineDispatchRecords[pipelineHandle];
+    if (owner != nullptr)
+    {
+        _pipelineDispatchData.retire(shared_ptr<PipelineDispatchRecord>(std::move(owner)));
+    }
+    owner = std::move(record);
+}
+
+void AddonUIData::RemovePipelineDispatchData(uint64_t pipelineHandle)
+{
+    unique_lock<mutex> lock(_pipelineDispatchMutex);
+
+    const auto& it = _pipelineDispatchRecords.find(pipelineHandle);
+    if (it == _pipelineDispatchRecords.end())
+    {
+        return;
+    }
+
+    _pipelineDispatchData.erase(pipelineHandle);
+    _pipelineDispatchData.retire(shared_ptr<PipelineDispatchRecord>(std::move(it.value())));
+    _pipelineDispatchRecords.erase(it);
+}
+
+bool AddonUIData::GetPipelineDispatchData(uint64_t pipelineHandle, PipelineDispatchData& data) const
+{
+    PipelineDispatchRecord* record = nullptr;
+    if (!_pipelineDispatchData.find(pipelineHandle, record))
+    {
+        return false;
+    }
+
+    data.psHash = record->psHash;
+    data.vsHash = record->vsHash;
+    data.csHash = record->csHash;
+    data.psGroups = record->psGroups.load(memory_order_acquire);
+    data.vsGroups = record->vsGroups.load(memory_order_acquire);
+    data.csGroups = record->csGroups.load(memory_order_acquire);
+
+    return true;
+}
+
+void AddonUIData::ReclaimRetiredPipelineDispatchData()
+{
+    unique_lock<mutex> lock(_pipelineDispatchMutex);
+    _pipelineDispatchData.reclaim();
+}
+
+void AddonUIData::ForEachPipelineDispatchData(const function<void(uint64_t, const PipelineDispatchData&)>& func)
+{
+    unique_lock<mutex> lock(_pipelineDispatchMutex);
+
+    for (const auto& [handle, record] : _pipelineDispatchRecords)
+    {
+        PipelineDispatchData data;
+        data.psHash = record->psHash;
+        data.vsHash = record->vsHash;
+        data.csHash = record->csHash;
+        data.psGroups = record->psGroups.load(memory_order_acquire);
+        data.vsGroups = record->vsGroups.load(memory_order_acquire);
+        data.csGroups = record->csGroups.load(memory_order_acquire);
+
+        func(handle, data);
+    }
+}
+
 void AddonUIData::UpdateToggleGroupsForShaderHashes()
 {
+    // The dispatch records point into the hash to group maps, keep pipeline creation out until they have been refreshed
+    unique_lock<mutex> lock(_pipelineDispatchMutex);
+
     _pixelShaderHashToToggleGroups.clear();
     _vertexShaderHashToToggleGroups.clear();
     _computeShaderHashToToggleGroups.clear();
@@ -171,6 +262,13 @@ void AddonUIData::UpdateToggleGroupsForShaderHashes()
             _computeShaderHashToToggleGroups[h].push_back(&group);
         }
     }
+
+    for (auto& [_, record] : _pipelineDispatchRecords)
+    {
+        record->psGroups.store(record->psHash > 0 ? GetToggleGroupsForPixelShaderHash(record->psHash) : nullptr, memory_order_release);
+        record->vsGroups.store(record->vsHash > 0 ? GetToggleGroupsForVertexShaderHash(record->vsHash) : nullptr, memory_order_release);
+        record->csGroups.store(record->csHash > 0 ? GetToggleGroupsForComputeShaderHash(record->csHash) : nullptr, memory_order_release);
+    }
 }
 
 const atomic_int& AddonUIData::GetToggleGroupIdShaderEditing() const
@@ -185,6 +283,24 @@ void AddonUIData::StopHuntingMode()
     _computeShaderManager->stopHuntingMode();
 }
 
+bool AddonUIData::IsHotPathRequired() const
+{
+    if (*_activeCollectorFrameCounter > 0 || _toggleGroupIdShaderEditing >= 0 || _toggleGroupIdEffectEditing >= 0 || _toggleGroupIdConstantEditing >= 0)
+    {
+        return true;
+    }
+
+    for (const auto& [_, group] : _toggleGroups)
+    {
+        if (group.isActive())
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 
 /// <summary>
 /// Adds a default group with VK_CAPITAL as toggle key. Only used if there aren't any groups defined in the ini file.
@@ -193,6 +309,7 @@ void AddonUIData::AddDefaultGroup()
 {
     ToggleGroup toAdd("Default", ToggleGroup::getNewGroupId());
     toAdd.setToggleKey(0);
+    toAdd.setIndex(ToggleGroup::acquireGroupIndex());
     _toggleGroups.emplace(toAdd.getId(), toAdd);
 }
 
@@ -235,6 +352,13 @@ void AddonUIData::LoadShaderTogglerIniFile(const string& fileName)
     }
 
     _preventRuntimeReload = iniFile.GetBoolOrDefault("PreventRuntimeReload", "General", false);
+    _dynamicHotPathEvents = iniFile.GetBoolOrDefault("DynamicHotPathEvents", "General", true);
+
+    _constReadbackLatency = iniFile.GetInt("ConstantReadbackLatency", "General");
+    if (_constReadbackLatency < 0 || _constReadbackLatency > 3)
+    {
+        _constReadbackLatency = 2;
+    }
 
     for (uint32_t i = 0; i < ARRAYSIZE(KeybindNames); i++)
     {
@@ -259,6 +383,7 @@ void AddonUIData::LoadShaderTogglerIniFile(const string& fileName)
         {
             int nId = ToggleGroup::getNewGroupId();
             const auto& xx = _toggleGroups.emplace(nId, ToggleGroup{"", nId });
+            xx.first->second.setIndex(ToggleGroup::acquireGroupIndex());
         }
     }
     for (auto& [_,group] : _toggleGroups)
@@ -299,6 +424,8 @@ void AddonUIData::SaveShaderTogglerIniFile(const string& fileName)
     iniFile.SetValue("ConstantBufferHookCopyType", _constHookCopyType, "", "General");
     iniFile.SetBool("TrackDescriptors", _trackDescriptors, "", "General");
     iniFile.SetBool("PreventRuntimeReload", _preventRuntimeReload, "", "General");
+    iniFile.SetBool("DynamicHotPathEvents", _dynamicHotPathEvents, "", "General");
+    iniFile.SetInt("ConstantReadbackLatency", _constReadbackLatency, "", "General");
 
     for (uint32_t i = 0; i < ARRAYSIZE(KeybindNames); i++)
     {
@@ -38,6 +38,8 @@
 #include "ToggleGroup.h"
 #include <filesystem>
 #include <reshade.hpp>
+#include <mutex>
+#include <tsl/robin_map.h>
 #include <unordered_map>
 
 constexpr auto FRAMECOUNT_COLLECTION_PHASE_DEFAULT = 10;
@@ -74,6 +76,30 @@ enum TabType : uint32_t {
     TAB_CONSTANT_BUFFER,
 };
 
+/// <summary>
+/// Precomputed per-pipeline data consumed by bind_pipeline: the shader hashes of the pipeline plus the toggle groups those hashes belong to.
+/// </summary>
+struct PipelineDispatchData {
+    uint32_t psHash = 0;
+    uint32_t vsHash = 0;
+    uint32_t csHash = 0;
+    const std::vector<ShaderToggler::ToggleGroup*>* psGroups = nullptr;
+    const std::vector<ShaderToggler::ToggleGroup*>* vsGroups = nullptr;
+    const std::vector<ShaderToggler::ToggleGroup*>* csGroups = nullptr;
+};
+
+/// <summary>
+/// Shared storage behind PipelineDispatchData. The hashes never change after creation, the group lists are swapped in place when groups change.
+/// </summary>
+struct PipelineDispatchRecord {
+    uint32_t psHash = 0;
+    uint32_t vsHash = 0;
+    uint32_t csHash = 0;
+    std::atomic<const std::vector<ShaderToggler::ToggleGroup*>*> psGroups = nullptr;
+    std::atomic<const std::vector<ShaderToggler::ToggleGroup*>*> vsGroups = nullptr;
+    std::atomic<const std::vector<ShaderToggler::ToggleGroup*>*> csGroups = nullptr;
+};
+
 class AddonUIData {
   private:
     ShaderToggler::ShaderManager* _pixelShaderManager;
@@ -90,6 +116,9 @@ class AddonUIData {
     std::unordered_map<uint32_t, std::vector<ShaderToggler::ToggleGroup*>> _pixelShaderHashToToggleGroups;
     std::unordered_map<uint32_t, std::vector<ShaderToggler::ToggleGroup*>> _vertexShaderHashToToggleGroups;
     std::unordered_map<uint32_t, std::vector<ShaderToggler::ToggleGroup*>> _computeShaderHashToToggleGroups;
+    tsl::robin_map<uint64_t, std::unique_ptr<PipelineDispatchRecord>> _pipelineDispatchRecords; // owning side, only touched by writers
+    ShaderToggler::ConcurrentHandleMap<PipelineDispatchRecord*> _pipelineDispatchData;           // lock-free read side used by bind_pipeline
+    std::mutex _pipelineDispatchMutex;
     int _startValueFramecountCollectionPhase = FRAMECOUNT_COLLECTION_PHASE_DEFAULT;
     float _overlayOpacity = 0.2f;
     uint32_t _keyBindings[ARRAYSIZE(KeybindNames)];
@@ -98,6 +127,8 @@ class AddonUIData {
     std::string _resourceShim = "none";
     bool _trackDescriptors = true;
     bool _preventRuntimeReload = false;
+    bool _dynamicHotPathEvents = true;
+    int _constReadbackLatency = 2;
     std::filesystem::path _basePath;
     TabType _currentTab = TabType::TAB_NONE;
 
@@ -114,6 +145,20 @@ class AddonUIData {
     const std::vector<ShaderToggler::ToggleGroup*>* GetToggleGroupsForVertexShaderHash(uint32_t hash);
     const std::vector<ShaderToggler::ToggleGroup*>* GetToggleGroupsForComputeShaderHash(uint32_t hash);
     void UpdateToggleGroupsForShaderHashes();
+    /// <summary>
+    /// Stores the dispatch record for a newly created pipeline. The group lists are resolved once here and refreshed whenever the groups change.
+    /// </summary>
+    void AddPipelineDispatchData(uint64_t pipelineHandle, uint32_t psHash, uint32_t vsHash, uint32_t csHash);
+    void RemovePipelineDispatchData(uint64_t pipelineHandle);
+    /// <summary>
+    /// Copies the dispatch record of the passed in pipeline handle into data. Returns false if the pipeline has no known shaders.
+    /// </summary>
+    bool GetPipelineDispatchData(uint64_t pipelineHandle, PipelineDispatchData& data) const;
+    void ReclaimRetiredPipelineDispatchData();
+    /// <summary>
+    /// Calls func for every pipeline with a dispatch record. Blocks pipeline creation and destruction while running.
+    /// </summary>
+    void ForEachPipelineDispatchData(const std::function<void(uint64_t, const PipelineDispatchData&)>& func);
     void AddDefaultGroup();
     const std::atomic_int& GetToggleGroupIdShaderEditing() const;
     void EndShaderEditing(bool acceptCollectedShaderHashes, ShaderToggler::ToggleGroup& groupEditing);
@@ -158,7 +203,15 @@ class AddonUIData {
     void SignalToggleGroupRemoved(reshade::api::effect_runtime*, ShaderToggler::ToggleGroup*);
     bool GetPreventRuntimeReload() const { return _preventRuntimeReload; }
     void SetPreventRuntimeReload(bool reload) { _preventRuntimeReload = reload; }
+    bool GetDynamicHotPathEvents() const { return _dynamicHotPathEvents; }
+    void SetDynamicHotPathEvents(bool dynamic) { _dynamicHotPathEvents = dynamic; }
+    uint32_t GetConstReadbackLatency() const { return static_cast<uint32_t>(_constReadbackLatency); }
+    int* ConstReadbackLatency() { return &_constReadbackLatency; }
+    /// <summary>
+    /// Returns true if anything consumes the draw, dispatch and bind events: an active group, shader hunting or effect/constant editing.
+    /// </summary>
+    bool IsHotPathRequired() const;
 
-    void AssignPreferredGroupTechniques(std::unordered_map<std::string, EffectData>& allTechniques);
+    void AssignPreferredGroupTechniques(std::unordered_map<std::string, EffectData>& allTechniques, const std::vector<EffectData*>& allSortedTechniques);
 };
 }
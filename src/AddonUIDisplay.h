@@ -33,7 +33,9 @@
 #pragma once
 #include "AddonUIAbout.h"
 #include "AddonUIConstants.h"
+#include "CallbackProfiler.h"
 #include "ConstantManager.h"
+#include "EventTrace.h"
 #include "KeyData.h"
 #include "ResourceManager.h"
 #include <cwctype>
@@ -178,10 +180,11 @@ static void DisplayTechniqueSelection(reshade::api::effect_runtime* runtime,
     group->setHasTechniqueExceptions(exceptions);
     group->setAllowAllTechniques(allowAll);
 
-    std::shared_lock<std::shared_mutex> techLock(runtimeData.technique_mutex);
+    // The group schedules are read while scheduling command lists, so rebuild them exclusively
+    std::unique_lock<std::shared_mutex> techLock(runtimeData.technique_mutex);
     if (runtimeData.allTechniques.size() > 0) {
         group->setPreferredTechniques(newTechniques);
-        instance.AssignPreferredGroupTechniques(runtimeData.allTechniques);
+        instance.AssignPreferredGroupTechniques(runtimeData.allTechniques, runtimeData.allSortedTechniques);
     }
 }
 
@@ -1003,6 +1006,106 @@ static void ShowHelpMarker(const char* desc) {
     }
 }
 
+static void DisplayCallbackTimings(AddonImGui::AddonUIData& instance) {
+    if (!ImGui::CollapsingHeader("Callback timings", ImGuiTreeNodeFlags_None)) {
+        return;
+    }
+
+    const ShaderToggler::CallbackFrameStats stats = ShaderToggler::CallbackProfiler::Instance().GetFrameStats();
+
+    if (ImGui::BeginTable("##callbackTimings", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Callback");
+        ImGui::TableSetupColumn("Count");
+        ImGui::TableSetupColumn("Total (us)");
+        ImGui::TableSetupColumn("p50 (us)");
+        ImGui::TableSetupColumn("p99 (us)");
+        ImGui::TableHeadersRow();
+
+        for (uint32_t i = 0; i < ShaderToggler::PROFILE_CALLBACK_COUNT; i++) {
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(ShaderToggler::ProfiledCallbackNames[i]);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", stats[i].count);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", stats[i].totalUs);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", stats[i].p50Us);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", stats[i].p99Us);
+        }
+
+        ImGui::EndTable();
+    }
+
+    static bool csvWritten = true;
+    if (ImGui::Button("Write CSV")) {
+        csvWritten = ShaderToggler::CallbackProfiler::Instance().WriteCsv(instance.GetBasePath() / "ShaderToggler_callbacks.csv");
+    }
+
+    if (!csvWritten) {
+        ImGui::SameLine();
+        ImGui::TextUnformatted("Could not write ShaderToggler_callbacks.csv");
+    }
+}
+
+static void DisplayConstantShadowStats() {
+    if (!ImGui::CollapsingHeader("Constant buffer shadows", ImGuiTreeNodeFlags_None)) {
+        return;
+    }
+
+    const Shim::Constants::HostConstantBufferStats stats = Shim::Constants::ConstantCopyBase::GetHostConstantBufferStats();
+
+    ImGui::Text("Shadowed buffers: %llu", stats.buffers);
+    ImGui::Text("Shadow memory: %.1f KB", static_cast<double>(stats.bytes) / 1024.0);
+    ImGui::Text("Hooked writes last frame: %llu", stats.writes);
+    ImGui::Text("Unshadowed writes last frame: %llu", stats.unshadowedWrites);
+    ImGui::Text("Pending initial data: %llu buffers, %.1f KB", stats.initialDataBuffers, static_cast<double>(stats.initialDataBytes) / 1024.0);
+}
+
+static void DisplayEventTrace(AddonImGui::AddonUIData& instance) {
+    if (!ImGui::CollapsingHeader("Event trace", ImGuiTreeNodeFlags_None)) {
+        return;
+    }
+
+    ShaderToggler::EventTraceRecorder& recorder = ShaderToggler::EventTraceRecorder::Instance();
+    static int traceFrames = 60;
+
+    ImGui::PushItemWidth(ImGui::GetWindowWidth() * 0.35f);
+    ImGui::SliderInt("Frames to capture", &traceFrames, 1, 600, "%d", ImGuiSliderFlags_AlwaysClamp);
+    ImGui::PopItemWidth();
+
+    static std::string validationResult;
+    const std::filesystem::path tracePath = instance.GetBasePath() / "ShaderToggler_trace.bin";
+
+    if (recorder.IsCapturing() || recorder.GetRemainingFrames() > 0) {
+        ImGui::Text("Capturing, %u frames remaining", recorder.GetRemainingFrames());
+        return;
+    }
+
+    if (ImGui::Button("Capture")) {
+        validationResult.clear();
+        recorder.RequestCapture(tracePath, static_cast<uint32_t>(traceFrames));
+    }
+
+    ImGui::SameLine();
+    if (ImGui::Button("Validate trace")) {
+        ShaderToggler::TraceSummary summary;
+        validationResult = ShaderToggler::ValidateEventTrace(tracePath, summary);
+
+        if (validationResult.empty()) {
+            validationResult = std::format("Valid, {} frames, {} draws, {} dispatches",
+                                           summary.frames,
+                                           summary.records[static_cast<size_t>(ShaderToggler::TraceRecordType::DRAW)] +
+                                             summary.records[static_cast<size_t>(ShaderToggler::TraceRecordType::DRAW_INDEXED)],
+                                           summary.records[static_cast<size_t>(ShaderToggler::TraceRecordType::DISPATCH)]);
+        }
+    }
+
+    if (!validationResult.empty()) {
+        ImGui::TextUnformatted(validationResult.c_str());
+    }
+}
+
 static void DisplaySettings(AddonImGui::AddonUIData& instance, reshade::api::effect_runtime* runtime) {
     DisplayAbout();
 
@@ -1071,6 +1174,17 @@ static void DisplaySettings(AddonImGui::AddonUIData& instance, reshade::api::eff
         }
         instance.SetConstHookCopyType(varSelectedCopyMethod);
 
+        if (varSelectedCopyMethod == "gpu_readback") {
+            ImGui::AlignTextToFramePadding();
+            ImGui::PushItemWidth(ImGui::GetWindowWidth() * 0.5f);
+            ImGui::SliderInt("Constant readback latency", instance.ConstReadbackLatency(), 0, 3);
+            ImGui::PopItemWidth();
+            ImGui::SameLine();
+            ShowHelpMarker("Number of frames extracted constants lag behind. 0 reads them back right away, which stalls until the GPU caught up. Higher "
+                           "values avoid the stall at the cost of older values, a copy the GPU hasn't finished yet is never read. If the game's "
+                           "device can't report completed copies, at least 3 frames are used. Takes effect after a restart.");
+        }
+
         ImGui::AlignTextToFramePadding();
         bool trackDescriptors = instance.GetTrackDescriptors();
         ImGui::Checkbox("Track descriptors", &trackDescriptors);
@@ -1079,8 +1193,21 @@ static void DisplaySettings(AddonImGui::AddonUIData& instance, reshade::api::eff
         bool runtimeReload = instance.GetPreventRuntimeReload();
         ImGui::Checkbox("Prevent runtime reload", &runtimeReload);
         instance.SetPreventRuntimeReload(runtimeReload);
+
+        bool dynamicHotPathEvents = instance.GetDynamicHotPathEvents();
+        ImGui::Checkbox("Only process draw calls while needed", &dynamicHotPathEvents);
+        ImGui::SameLine();
+        ShowHelpMarker("Skips the draw, dispatch and pipeline bind handling while no group is active and nothing is being hunted or edited.");
+        instance.SetDynamicHotPathEvents(dynamicHotPathEvents);
     }
 
+#ifdef SHADERTOGGLER_PROFILE_CALLBACKS
+    DisplayCallbackTimings(instance);
+#endif
+
+    DisplayConstantShadowStats();
+    DisplayEventTrace(instance);
+
     if (ImGui::CollapsingHeader("Keybindings", ImGuiTreeNodeFlags_None)) {
         for (uint32_t i = 0; i < IM_ARRAYSIZE(AddonImGui::KeybindNames); i++) {
             uint32_t keys = instance.GetKeybinding(static_cast<AddonImGui::Keybind>(i));
@@ -1094,7 +1221,11 @@ static void DisplaySettings(AddonImGui::AddonUIData& instance, reshade::api::eff
 
     if (ImGui::CollapsingHeader("List of Toggle Groups", ImGuiTreeNodeFlags_DefaultOpen)) {
         if (ImGui::Button(" New ")) {
+            RuntimeDataContainer& runtimeData = runtime->get_private_data<RuntimeDataContainer>();
+            std::unique_lock<std::shared_mutex> techLock(runtimeData.technique_mutex);
+
             instance.AddDefaultGroup();
+            instance.AssignPreferredGroupTechniques(runtimeData.allTechniques, runtimeData.allSortedTechniques);
         }
         ImGui::Separator();
 
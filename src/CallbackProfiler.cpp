@@ -0,0 +1,153 @@
+#include "CallbackProfiler.h"
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <limits>
+
+using namespace ShaderToggler;
+using namespace std;
+
+CallbackProfiler& CallbackProfiler::Instance() {
+    static CallbackProfiler s_profiler;
+    return s_profiler;
+}
+
+CallbackProfiler::ThreadBuffer& CallbackProfiler::GetThreadBuffer() {
+    thread_local shared_ptr<ThreadBuffer> t_buffer;
+
+    if (t_buffer == nullptr) {
+        t_buffer = make_shared<ThreadBuffer>();
+
+        unique_lock<mutex> lock(_buffersMutex);
+        _buffers.push_back(t_buffer);
+    }
+
+    return *t_buffer;
+}
+
+uint32_t CallbackProfiler::GetBucket(uint64_t nanoseconds) {
+    const uint32_t value = static_cast<uint32_t>(std::min<uint64_t>(nanoseconds, numeric_limits<uint32_t>::max()));
+
+    if (value < HISTOGRAM_SUB_BUCKETS) {
+        return value;
+    }
+
+    // The two bits below the highest set one pick the bucket within the octave
+    const uint32_t msb = static_cast<uint32_t>(bit_width(value)) - 1;
+    return (msb - 1) * HISTOGRAM_SUB_BUCKETS + ((value >> (msb - 2)) & (HISTOGRAM_SUB_BUCKETS - 1));
+}
+
+uint64_t CallbackProfiler::GetBucketMidpoint(uint32_t bucket) {
+    if (bucket < HISTOGRAM_SUB_BUCKETS) {
+        return bucket;
+    }
+
+    const uint32_t shift = bucket / HISTOGRAM_SUB_BUCKETS - 1;
+    const uint64_t lower = static_cast<uint64_t>(HISTOGRAM_SUB_BUCKETS + bucket % HISTOGRAM_SUB_BUCKETS) << shift;
+
+    return lower + ((1ull << shift) >> 1);
+}
+
+void CallbackProfiler::Record(ProfiledCallback callback, uint64_t nanoseconds) {
+    ThreadBuffer& buffer = GetThreadBuffer();
+
+    // Single writer, so a plain load and store is enough, OnPresent only reads
+    atomic<uint32_t>& bucket = buffer.buckets[callback][GetBucket(nanoseconds)];
+    bucket.store(bucket.load(memory_order_relaxed) + 1, memory_order_relaxed);
+
+    atomic<uint64_t>& total = buffer.totalNs[callback];
+    total.store(total.load(memory_order_relaxed) + nanoseconds, memory_order_relaxed);
+}
+
+static double percentile(const array<uint64_t, CallbackProfiler::HISTOGRAM_BUCKETS>& histogram, uint64_t count, double p) {
+    const uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(count - 1));
+    uint64_t seen = 0;
+
+    for (uint32_t i = 0; i < CallbackProfiler::HISTOGRAM_BUCKETS; i++) {
+        seen += histogram[i];
+
+        if (seen > rank) {
+            return static_cast<double>(CallbackProfiler::GetBucketMidpoint(i)) / 1000.0;
+        }
+    }
+
+    return static_cast<double>(CallbackProfiler::GetBucketMidpoint(CallbackProfiler::HISTOGRAM_BUCKETS - 1)) / 1000.0;
+}
+
+void CallbackProfiler::OnPresent() {
+    array<array<uint64_t, HISTOGRAM_BUCKETS>, PROFILE_CALLBACK_COUNT> merged = {};
+    array<uint64_t, PROFILE_CALLBACK_COUNT> counts = {};
+    array<uint64_t, PROFILE_CALLBACK_COUNT> totals = {};
+
+    {
+        unique_lock<mutex> lock(_buffersMutex);
+
+        for (auto& buffer : _buffers) {
+            for (uint32_t i = 0; i < PROFILE_CALLBACK_COUNT; i++) {
+                for (uint32_t b = 0; b < HISTOGRAM_BUCKETS; b++) {
+                    const uint32_t value = buffer->buckets[i][b].load(memory_order_relaxed);
+
+                    // Counters wrap around, the difference stays right as long as a bucket sees less than 2^32 samples per frame
+                    merged[i][b] += value - buffer->reportedBuckets[i][b];
+                    counts[i] += value - buffer->reportedBuckets[i][b];
+                    buffer->reportedBuckets[i][b] = value;
+                }
+
+                const uint64_t total = buffer->totalNs[i].load(memory_order_relaxed);
+                totals[i] += total - buffer->reportedTotalNs[i];
+                buffer->reportedTotalNs[i] = total;
+            }
+        }
+
+        // Drop the buffers of threads which have exited and have nothing left to collect
+        erase_if(_buffers, [](const shared_ptr<ThreadBuffer>& buffer) { return buffer.use_count() == 1; });
+    }
+
+    CallbackFrameStats stats;
+
+    for (uint32_t i = 0; i < PROFILE_CALLBACK_COUNT; i++) {
+        if (counts[i] == 0) {
+            continue;
+        }
+
+        stats[i].count = counts[i];
+        stats[i].totalUs = static_cast<double>(totals[i]) / 1000.0;
+        stats[i].p50Us = percentile(merged[i], counts[i], 0.5);
+        stats[i].p99Us = percentile(merged[i], counts[i], 0.99);
+    }
+
+    unique_lock<mutex> lock(_statsMutex);
+
+    _frameStats = stats;
+    _history.emplace_back(_frame++, stats);
+
+    if (_history.size() > HISTORY_FRAMES) {
+        _history.pop_front();
+    }
+}
+
+CallbackFrameStats CallbackProfiler::GetFrameStats() {
+    unique_lock<mutex> lock(_statsMutex);
+    return _frameStats;
+}
+
+bool CallbackProfiler::WriteCsv(const filesystem::path& path) {
+    ofstream file(path, ios::out | ios::trunc);
+
+    if (!file.is_open()) {
+        return false;
+    }
+
+    file << "frame,callback,count,total_us,p50_us,p99_us\n";
+
+    unique_lock<mutex> lock(_statsMutex);
+
+    for (const auto& [frame, stats] : _history) {
+        for (uint32_t i = 0; i < PROFILE_CALLBACK_COUNT; i++) {
+            file << frame << ',' << ProfiledCallbackNames[i] << ',' << stats[i].count << ',' << stats[i].totalUs << ',' << stats[i].p50Us << ','
+                 << stats[i].p99Us << '\n';
+        }
+    }
+
+    return file.good();
+}
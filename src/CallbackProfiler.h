@@ -0,0 +1,133 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Define SHADERTOGGLER_PROFILE_CALLBACKS to time the event handlers registered in Main.cpp and show the results in the settings overlay.
+// Without it PROFILE_CALLBACK compiles to nothing.
+#ifdef SHADERTOGGLER_PROFILE_CALLBACKS
+#define PROFILE_CALLBACK(callback) ShaderToggler::CallbackTimer _callbackTimer(callback)
+#else
+#define PROFILE_CALLBACK(callback)
+#endif
+
+namespace ShaderToggler {
+enum ProfiledCallback : uint32_t {
+    PROFILE_BIND_PIPELINE = 0,
+    PROFILE_DRAW,
+    PROFILE_DRAW_INDEXED,
+    PROFILE_DISPATCH,
+    PROFILE_DRAW_OR_DISPATCH_INDIRECT,
+    PROFILE_BIND_RENDER_TARGETS,
+    PROFILE_BEGIN_RENDER_PASS,
+    PROFILE_RESHADE_PRESENT,
+    PROFILE_MAP_BUFFER_REGION,
+    PROFILE_UNMAP_BUFFER_REGION,
+    PROFILE_UPDATE_BUFFER_REGION,
+    PROFILE_CALLBACK_COUNT
+};
+
+constexpr const char* ProfiledCallbackNames[PROFILE_CALLBACK_COUNT] = {
+    "bind_pipeline",
+    "draw",
+    "draw_indexed",
+    "dispatch",
+    "draw_or_dispatch_indirect",
+    "bind_render_targets_and_depth_stencil",
+    "begin_render_pass",
+    "reshade_present",
+    "map_buffer_region",
+    "unmap_buffer_region",
+    "update_buffer_region",
+};
+
+struct __declspec(novtable) CallbackStats final {
+    uint64_t count = 0;
+    double totalUs = 0.0;
+    double p50Us = 0.0;
+    double p99Us = 0.0;
+};
+
+using CallbackFrameStats = std::array<CallbackStats, PROFILE_CALLBACK_COUNT>;
+
+/// <summary>
+/// Collects the durations of the addon's event handlers. Every thread counts its samples into its own fixed log bucketed histograms, which are
+/// merged once per present into per frame statistics, of which the last HISTORY_FRAMES frames are kept for the CSV export. Percentiles are
+/// taken from the buckets, which are a quarter octave wide.
+/// </summary>
+class __declspec(novtable) CallbackProfiler final {
+  public:
+    static constexpr size_t HISTORY_FRAMES = 600;
+
+    static CallbackProfiler& Instance();
+
+    void Record(ProfiledCallback callback, uint64_t nanoseconds);
+    /// <summary>
+    /// Merges the samples recorded by all threads since the last present into the statistics of a new frame.
+    /// </summary>
+    void OnPresent();
+    CallbackFrameStats GetFrameStats();
+    /// <summary>
+    /// Writes the statistics of the frames in the history to a CSV file, one row per frame and callback. Returns false if the file couldn't be written.
+    /// </summary>
+    bool WriteCsv(const std::filesystem::path& path);
+
+    // Four buckets per power of two of nanoseconds, durations are clamped to 32 bits
+    static constexpr uint32_t HISTOGRAM_SUB_BUCKETS = 4;
+    static constexpr uint32_t HISTOGRAM_BUCKETS = 31 * HISTOGRAM_SUB_BUCKETS;
+
+    static uint32_t GetBucket(uint64_t nanoseconds);
+    static uint64_t GetBucketMidpoint(uint32_t bucket);
+
+  private:
+    // Only the owning thread writes the counters, which only ever grow. OnPresent reports the difference to the counts it saw the last time.
+    struct ThreadBuffer {
+        std::array<std::array<std::atomic<uint32_t>, HISTOGRAM_BUCKETS>, PROFILE_CALLBACK_COUNT> buckets = {};
+        std::array<std::atomic<uint64_t>, PROFILE_CALLBACK_COUNT> totalNs = {};
+
+        // Only touched at present
+        std::array<std::array<uint32_t, HISTOGRAM_BUCKETS>, PROFILE_CALLBACK_COUNT> reportedBuckets = {};
+        std::array<uint64_t, PROFILE_CALLBACK_COUNT> reportedTotalNs = {};
+    };
+
+    ThreadBuffer& GetThreadBuffer();
+
+    std::mutex _buffersMutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> _buffers;
+
+    std::mutex _statsMutex;
+    uint64_t _frame = 0;
+    CallbackFrameStats _frameStats;
+    std::deque<std::pair<uint64_t, CallbackFrameStats>> _history;
+};
+
+/// <summary>
+/// Records the time between its construction and destruction for the given callback.
+/// </summary>
+class __declspec(novtable) CallbackTimer final {
+  public:
+    explicit CallbackTimer(ProfiledCallback callback)
+      : _callback(callback)
+      , _start(std::chrono::steady_clock::now()) {}
+
+    ~CallbackTimer() {
+        CallbackProfiler::Instance().Record(
+          _callback, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start).count()));
+    }
+
+    CallbackTimer(const CallbackTimer&) = delete;
+    CallbackTimer& operator=(const CallbackTimer&) = delete;
+
+  private:
+    ProfiledCallback _callback;
+    std::chrono::steady_clock::time_point _start;
+};
+}
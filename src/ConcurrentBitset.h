@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ShaderToggler {
+/// <summary>
+/// Bitset addressed by dense indices which can be tested, set and reset from any thread without taking locks. Bits live in fixed size blocks
+/// which are allocated on first use and never moved before destruction, so growing never invalidates concurrent readers.
+/// Indices beyond MAX_BLOCKS * BLOCK_BITS are ignored.
+/// </summary>
+class ConcurrentBitset {
+  public:
+    static constexpr size_t BLOCK_WORDS = 64;
+    static constexpr size_t BLOCK_BITS = BLOCK_WORDS * 64;
+    static constexpr size_t MAX_BLOCKS = 64;
+
+    ConcurrentBitset() = default;
+    ConcurrentBitset(const ConcurrentBitset&) = delete;
+    ConcurrentBitset& operator=(const ConcurrentBitset&) = delete;
+
+    ~ConcurrentBitset() {
+        for (auto& block : _blocks) {
+            delete block.load(std::memory_order_relaxed);
+        }
+    }
+
+    bool test(size_t index) const {
+        const Block* block = index < MAX_BLOCKS * BLOCK_BITS ? _blocks[index / BLOCK_BITS].load(std::memory_order_acquire) : nullptr;
+        return block != nullptr && (block->words[(index % BLOCK_BITS) >> 6].load(std::memory_order_acquire) & (1ull << (index & 63))) != 0;
+    }
+
+    void set(size_t index) {
+        if (index >= MAX_BLOCKS * BLOCK_BITS) {
+            return;
+        }
+
+        getOrCreateBlock(index / BLOCK_BITS)->words[(index % BLOCK_BITS) >> 6].fetch_or(1ull << (index & 63), std::memory_order_acq_rel);
+    }
+
+    void reset(size_t index) {
+        Block* block = index < MAX_BLOCKS * BLOCK_BITS ? _blocks[index / BLOCK_BITS].load(std::memory_order_acquire) : nullptr;
+
+        if (block != nullptr) {
+            block->words[(index % BLOCK_BITS) >> 6].fetch_and(~(1ull << (index & 63)), std::memory_order_acq_rel);
+        }
+    }
+
+    /// <summary>
+    /// Zeroes every allocated block. Meant to be called once per present, bits set concurrently may or may not survive.
+    /// </summary>
+    void clear() {
+        for (auto& entry : _blocks) {
+            Block* block = entry.load(std::memory_order_acquire);
+
+            if (block != nullptr) {
+                for (auto& word : block->words) {
+                    word.store(0, std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+
+  private:
+    struct Block {
+        std::atomic<uint64_t> words[BLOCK_WORDS] = {};
+    };
+
+    Block* getOrCreateBlock(size_t blockIndex) {
+        Block* block = _blocks[blockIndex].load(std::memory_order_acquire);
+
+        if (block == nullptr) {
+            Block* created = new Block();
+
+            if (_blocks[blockIndex].compare_exchange_strong(block, created, std::memory_order_acq_rel)) {
+                block = created;
+            } else {
+                delete created;
+            }
+        }
+
+        return block;
+    }
+
+    std::atomic<Block*> _blocks[MAX_BLOCKS] = {};
+};
+}
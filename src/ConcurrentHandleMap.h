@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace ShaderToggler {
+/// <summary>
+/// Open addressing map from 64 bit api handles to small values which can be read without taking any locks. Writers have to be serialized by the
+/// caller. A default constructed value marks an absent entry, handle 0 is reserved as the empty key.
+/// Tables replaced by a rehash, as well as anything handed to retire(), are kept alive until reclaim() has been called RECLAIM_LATENCY times,
+/// so readers which still hold on to them stay valid.
+/// </summary>
+template <typename T>
+class ConcurrentHandleMap {
+    static_assert(std::atomic<T>::is_always_lock_free, "ConcurrentHandleMap values have to be lock-free atomics");
+
+  public:
+    static constexpr uint32_t RECLAIM_LATENCY = 3;
+
+    explicit ConcurrentHandleMap(size_t initialCapacity = 1024) { _table.store(publish(createTable(initialCapacity)), std::memory_order_release); }
+
+    ConcurrentHandleMap(const ConcurrentHandleMap&) = delete;
+    ConcurrentHandleMap& operator=(const ConcurrentHandleMap&) = delete;
+
+    /// <summary>
+    /// Lock-free lookup. Returns false if there's no entry for the handle.
+    /// </summary>
+    bool find(uint64_t handle, T& value) const {
+        if (handle == 0) {
+            return false;
+        }
+
+        const Table* table = _table.load(std::memory_order_acquire);
+
+        for (size_t i = hashHandle(handle) & table->mask;; i = (i + 1) & table->mask) {
+            const uint64_t key = table->slots[i].key.load(std::memory_order_acquire);
+
+            if (key == handle) {
+                value = table->slots[i].value.load(std::memory_order_acquire);
+                return value != T{};
+            }
+
+            if (key == 0) {
+                return false;
+            }
+        }
+    }
+
+    bool contains(uint64_t handle) const {
+        T value;
+        return find(handle, value);
+    }
+
+    /// <summary>
+    /// Writer side. Inserts or overwrites the entry for the handle, returns the value that was replaced (if any).
+    /// </summary>
+    T insert_or_assign(uint64_t handle, T value) {
+        if (handle == 0 || value == T{}) {
+            return T{};
+        }
+
+        if ((_used + 1) * 2 > _owner->mask + 1) {
+            rehash();
+        }
+
+        Slot& slot = probe(_owner.get(), handle);
+
+        if (slot.key.load(std::memory_order_relaxed) == handle) {
+            T previous = slot.value.exchange(value, std::memory_order_acq_rel);
+            if (previous == T{}) {
+                _size++;
+            }
+            return previous;
+        }
+
+        // Publish the value before the key so readers which observe the key always see a valid value
+        slot.value.store(value, std::memory_order_relaxed);
+        slot.key.store(handle, std::memory_order_release);
+        _used++;
+        _size++;
+
+        return T{};
+    }
+
+    /// <summary>
+    /// Writer side. Removes the entry for the handle, returns the removed value (if any). The slot is kept as tombstone until the next rehash.
+    /// </summary>
+    T erase(uint64_t handle) {
+        if (handle == 0) {
+            return T{};
+        }
+
+        Slot& slot = probe(_owner.get(), handle);
+
+        if (slot.key.load(std::memory_order_relaxed) != handle) {
+            return T{};
+        }
+
+        T previous = slot.value.exchange(T{}, std::memory_order_acq_rel);
+        if (previous != T{}) {
+            _size--;
+        }
+
+        return previous;
+    }
+
+    /// <summary>
+    /// Writer side. Calls func(handle, value) for every live entry.
+    /// </summary>
+    template <typename F>
+    void for_each(F&& func) const {
+        const Table* table = _owner.get();
+
+        for (size_t i = 0; i <= table->mask; i++) {
+            const uint64_t key = table->slots[i].key.load(std::memory_order_relaxed);
+            const T value = table->slots[i].value.load(std::memory_order_relaxed);
+
+            if (key != 0 && value != T{}) {
+                func(key, value);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Writer side. Keeps obj alive until it can no longer be referenced by any reader.
+    /// </summary>
+    void retire(std::shared_ptr<void> obj) { _retired.emplace_back(_epoch, std::move(obj)); }
+
+    /// <summary>
+    /// Writer side. Advances the reclamation epoch, meant to be called once per present, and frees whatever was retired long enough ago.
+    /// </summary>
+    void reclaim() {
+        _epoch++;
+
+        std::erase_if(_retired, [this](const auto& entry) { return _epoch - entry.first >= RECLAIM_LATENCY; });
+    }
+
+    size_t size() const { return _size; }
+
+  private:
+    struct Slot {
+        std::atomic<uint64_t> key{ 0 };
+        std::atomic<T> value{ T{} };
+    };
+
+    struct Table {
+        size_t mask = 0;
+        std::unique_ptr<Slot[]> slots;
+    };
+
+    static uint64_t hashHandle(uint64_t handle) {
+        // Handles are mostly aligned pointers, so mix the bits before masking
+        handle ^= handle >> 33;
+        handle *= 0xff51afd7ed558ccdull;
+        handle ^= handle >> 33;
+        return handle;
+    }
+
+    static std::unique_ptr<Table> createTable(size_t capacity) {
+        size_t size = 16;
+        while (size < capacity) {
+            size <<= 1;
+        }
+
+        std::unique_ptr<Table> table = std::make_unique<Table>();
+        table->mask = size - 1;
+        table->slots = std::make_unique<Slot[]>(size);
+
+        return table;
+    }
+
+    static Slot& probe(Table* table, uint64_t handle) {
+        for (size_t i = hashHandle(handle) & table->mask;; i = (i + 1) & table->mask) {
+            const uint64_t key = table->slots[i].key.load(std::memory_order_relaxed);
+
+            if (key == handle || key == 0) {
+                return table->slots[i];
+            }
+        }
+    }
+
+    Table* publish(std::unique_ptr<Table> table) {
+        if (_owner != nullptr) {
+            retire(std::shared_ptr<void>(std::move(_owner)));
+        }
+
+        _owner = std::move(table);
+        return _owner.get();
+    }
+
+    void rehash() {
+        // Tombstones are dropped here, so size the new table after the live entries only
+        std::unique_ptr<Table> table = createTable(std::max<size_t>((_size + 1) * 4, _owner->mask + 1));
+
+        for_each([&table](uint64_t key, T value) {
+            Slot& slot = probe(table.get(), key);
+            slot.value.store(value, std::memory_order_relaxed);
+            slot.key.store(key, std::memory_order_relaxed);
+        });
+
+        _used = _size;
+        _table.store(publish(std::move(table)), std::memory_order_release);
+    }
+
+    std::atomic<Table*> _table = nullptr;
+    std::unique_ptr<Table> _owner;
+    size_t _used = 0; // slots with a key, including tombstones
+    size_t _size = 0; // live entries
+    uint64_t _epoch = 0;
+    std::vector<std::pair<uint64_t, std::shared_ptr<void>>> _retired;
+};
+}
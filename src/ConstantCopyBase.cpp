@@ -1,45 +1,181 @@
 #include "ConstantCopyBase.h"
+#include <algorithm>
+#include <cstring>
+#include <thread>
 
 using namespace Shim::Constants;
 using namespace reshade::api;
 using namespace std;
 
-unordered_map<uint64_t, vector<uint8_t>> ConstantCopyBase::deviceToHostConstantBuffer;
-shared_mutex ConstantCopyBase::deviceHostMutex;
+array<ConstantCopyBase::HostConstantBufferShard, 1 << ConstantCopyBase::HOST_BUFFER_SHARD_BITS> ConstantCopyBase::deviceToHostConstantBuffer;
+atomic<uint64_t> ConstantCopyBase::hostBufferFrame = 0;
+atomic<uint64_t> ConstantCopyBase::hostBufferGeneration = 0;
+atomic<uint64_t> ConstantCopyBase::unshadowedWrites = 0;
+mutex ConstantCopyBase::hostBufferStatsMutex;
+HostConstantBufferStats ConstantCopyBase::hostBufferStats;
 
 ConstantCopyBase::ConstantCopyBase() {}
 
 ConstantCopyBase::~ConstantCopyBase() {}
 
-void ConstantCopyBase::GetHostConstantBuffer(reshade::api::command_list* cmd_list,
+void ConstantCopyBase::HostConstantBuffer::Write(const void* buffer, size_t size, uintptr_t offset) {
+    if (offset >= data.size()) {
+        return;
+    }
+
+    size = std::min(size, data.size() - offset);
+
+    uint32_t seq = sequence.load(memory_order_relaxed);
+    while ((seq & 1) != 0 || !sequence.compare_exchange_weak(seq, seq + 1, memory_order_acquire, memory_order_relaxed)) {
+        this_thread::yield();
+        seq = sequence.load(memory_order_relaxed);
+    }
+
+    memcpy(&data[offset], buffer, size);
+
+    sequence.store(seq + 2, memory_order_release);
+}
+
+void ConstantCopyBase::HostConstantBuffer::Read(void* dest, size_t size) const {
+    size = std::min(size, data.size());
+
+    for (;;) {
+        const uint32_t seq = sequence.load(memory_order_acquire);
+
+        if ((seq & 1) != 0) {
+            this_thread::yield();
+            continue;
+        }
+
+        memcpy(dest, data.data(), size);
+        atomic_thread_fence(memory_order_acquire);
+
+        if (sequence.load(memory_order_relaxed) == seq) {
+            return;
+        }
+    }
+}
+
+ConstantCopyBase::HostConstantBufferShard& ConstantCopyBase::GetShard(uint64_t handle) {
+    // Handles are mostly aligned pointers, mix all bits into the top ones
+    return deviceToHostConstantBuffer[(handle * 0x9E3779B97F4A7C15ull) >> (64 - HOST_BUFFER_SHARD_BITS)];
+}
+
+void ConstantCopyBase::ReleaseInitialData(uint64_t handle) {
+    HostConstantBufferShard& shard = GetShard(handle);
+
+    {
+        shared_lock<shared_mutex> lock(shard.mutex);
+        if (shard.initialData.empty() || !shard.initialData.contains(handle)) {
+            return;
+        }
+    }
+
+    unique_lock<shared_mutex> lock(shard.mutex);
+    shard.initialData.erase(handle);
+}
+
+bool ConstantCopyBase::GetHostConstantBuffer(reshade::api::command_list* cmd_list,
                                              ShaderToggler::ToggleGroup* group,
                                              vector<uint8_t>& dest,
                                              size_t size,
                                              uint64_t resourceHandle) {
-    shared_lock<shared_mutex> lock(deviceHostMutex);
-    const auto& it = deviceToHostConstantBuffer.find(resourceHandle);
-    if (it != deviceToHostConstantBuffer.end()) {
-        auto& [_, buffer] = *it;
-        std::memcpy(dest.data(), buffer.data(), size);
+    HostConstantBufferShard& shard = GetShard(resourceHandle);
+
+    shared_lock<shared_mutex> lock(shard.mutex);
+    const auto& it = shard.buffers.find(resourceHandle);
+    if (it == shard.buffers.end()) {
+        return false;
+    }
+
+    it->second->Read(dest.data(), std::min(size, dest.size()));
+    return true;
+}
+
+void ConstantCopyBase::ReferenceHostConstantBuffer(const resource_desc& desc, resource resource) {
+    if (desc.heap != memory_heap::cpu_to_gpu || !static_cast<uint32_t>(desc.usage & resource_usage::constant_buffer)) {
+        return;
+    }
+
+    HostConstantBufferShard& shard = GetShard(resource.handle);
+    const uint64_t frame = hostBufferFrame.load(memory_order_relaxed);
+
+    {
+        shared_lock<shared_mutex> lock(shard.mutex);
+        const auto& it = shard.buffers.find(resource.handle);
+        if (it != shard.buffers.end()) {
+            it->second->lastReferencedFrame.store(frame, memory_order_relaxed);
+            return;
+        }
+    }
+
+    // Starts out with the initial data of the buffer, if any, later content shows up with the next write the game makes
+    CreateHostConstantBuffer(nullptr, resource, static_cast<size_t>(desc.buffer.size));
+}
+
+uint64_t ConstantCopyBase::GetHostConstantBufferVersion(uint64_t resourceHandle) {
+    HostConstantBufferShard& shard = GetShard(resourceHandle);
+
+    shared_lock<shared_mutex> lock(shard.mutex);
+    const auto& it = shard.buffers.find(resourceHandle);
+    if (it == shard.buffers.end()) {
+        return HOST_BUFFER_VERSION_UNKNOWN;
     }
+
+    const uint32_t seq = it->second->sequence.load(memory_order_acquire);
+
+    // A write in progress will change the content again
+    if ((seq & 1) != 0) {
+        return HOST_BUFFER_VERSION_UNKNOWN;
+    }
+
+    return (it->second->generation << 32) | (seq >> 1);
 }
 
 void ConstantCopyBase::CreateHostConstantBuffer(device* dev, resource resource, size_t size) {
-    unique_lock<shared_mutex> lock(deviceHostMutex);
-    deviceToHostConstantBuffer.emplace(resource.handle, vector<uint8_t>(size, 0));
+    HostConstantBufferShard& shard = GetShard(resource.handle);
+
+    unique_ptr<HostConstantBuffer> buffer = make_unique<HostConstantBuffer>(size);
+    buffer->lastReferencedFrame.store(hostBufferFrame.load(memory_order_relaxed), memory_order_relaxed);
+
+    unique_lock<shared_mutex> lock(shard.mutex);
+
+    const auto& initial = shard.initialData.find(resource.handle);
+    if (initial != shard.initialData.end()) {
+        memcpy(buffer->data.data(), initial->second.data(), std::min(size, initial->second.size()));
+    }
+
+    shard.buffers.emplace(resource.handle, std::move(buffer));
 }
 
 void ConstantCopyBase::DeleteHostConstantBuffer(resource resource) {
-    unique_lock<shared_mutex> lock(deviceHostMutex);
-    deviceToHostConstantBuffer.erase(resource.handle);
+    HostConstantBufferShard& shard = GetShard(resource.handle);
+
+    unique_lock<shared_mutex> lock(shard.mutex);
+    shard.buffers.erase(resource.handle);
+    shard.initialData.erase(resource.handle);
 }
 
 inline void ConstantCopyBase::SetHostConstantBuffer(const uint64_t handle, const void* buffer, size_t size, uintptr_t offset, uint64_t bufferSize) {
-    unique_lock<shared_mutex> lock(deviceHostMutex);
-    const auto& it = deviceToHostConstantBuffer.find(handle);
-    if (it != deviceToHostConstantBuffer.end()) {
-        auto& [_, cBuffer] = *it;
-        memcpy(&cBuffer[offset], buffer, size);
+    HostConstantBufferShard& shard = GetShard(handle);
+
+    bool initial = false;
+
+    {
+        // Writers to different buffers only share the lock, they never wait on each other
+        shared_lock<shared_mutex> lock(shard.mutex);
+        const auto& it = shard.buffers.find(handle);
+        if (it != shard.buffers.end()) {
+            it->second->Write(buffer, size, offset);
+        } else {
+            unshadowedWrites.fetch_add(1, memory_order_relaxed);
+        }
+
+        initial = !shard.initialData.empty() && shard.initialData.contains(handle);
+    }
+
+    if (initial) {
+        ReleaseInitialData(handle);
     }
 }
 
@@ -48,11 +184,17 @@ void ConstantCopyBase::OnInitResource(device* device,
                                       const subresource_data* initData,
                                       resource_usage usage,
                                       reshade::api::resource handle) {
-    if (desc.heap == memory_heap::cpu_to_gpu && static_cast<uint32_t>(desc.usage & resource_usage::constant_buffer)) {
-        CreateHostConstantBuffer(device, handle, static_cast<size_t>(desc.buffer.size));
-        if (initData != nullptr && initData->data != nullptr) {
-            SetHostConstantBuffer(handle.handle, initData->data, static_cast<size_t>(desc.buffer.size), 0, desc.buffer.size);
-        }
+    // Host copies are only created once a group references the buffer, see ReferenceHostConstantBuffer. Buffers which are never written after
+    // creation would stay zeroed, so their initial data is kept until they're first mapped or written, see ReleaseInitialData.
+    if (desc.heap == memory_heap::cpu_to_gpu && static_cast<uint32_t>(desc.usage & resource_usage::constant_buffer) && initData != nullptr &&
+        initData->data != nullptr) {
+        const uint8_t* data = static_cast<const uint8_t*>(initData->data);
+        vector<uint8_t> initial(data, data + desc.buffer.size);
+
+        HostConstantBufferShard& shard = GetShard(handle.handle);
+
+        unique_lock<shared_mutex> lock(shard.mutex);
+        shard.initialData[handle.handle] = std::move(initial);
     }
 }
 
@@ -61,4 +203,45 @@ void ConstantCopyBase::OnDestroyResource(device* device, resource res) {
     if (desc.heap == memory_heap::cpu_to_gpu && static_cast<uint32_t>(desc.usage & resource_usage::constant_buffer)) {
         DeleteHostConstantBuffer(res);
     }
-}
\ No newline at end of file
+}
+
+void ConstantCopyBase::OnDestroyDevice(device* device) {}
+
+void ConstantCopyBase::OnReshadePresent(effect_runtime* runtime) {
+    const uint64_t frame = hostBufferFrame.fetch_add(1, memory_order_relaxed) + 1;
+    HostConstantBufferStats stats;
+
+    for (auto& shard : deviceToHostConstantBuffer) {
+        unique_lock<shared_mutex> lock(shard.mutex);
+
+        erase_if(shard.buffers, [frame](const auto& entry) {
+            return frame - entry.second->lastReferencedFrame.load(memory_order_relaxed) > HOST_BUFFER_IDLE_FRAMES;
+        });
+
+        for (auto& [_, buffer] : shard.buffers) {
+            // Every completed write advances the sequence by two
+            const uint32_t seq = buffer->sequence.load(memory_order_relaxed) & ~1u;
+
+            stats.buffers++;
+            stats.bytes += buffer->data.size();
+            stats.writes += (seq - buffer->reportedSequence) / 2;
+
+            buffer->reportedSequence = seq;
+        }
+
+        for (const auto& [_, initial] : shard.initialData) {
+            stats.initialDataBuffers++;
+            stats.initialDataBytes += initial.size();
+        }
+    }
+
+    stats.unshadowedWrites = unshadowedWrites.exchange(0, memory_order_relaxed);
+
+    unique_lock<mutex> lock(hostBufferStatsMutex);
+    hostBufferStats = stats;
+}
+
+HostConstantBufferStats ConstantCopyBase::GetHostConstantBufferStats() {
+    unique_lock<mutex> lock(hostBufferStatsMutex);
+    return hostBufferStats;
+}
@@ -4,11 +4,28 @@
 #include <reshade_api.hpp>
 #include <reshade_api_device.hpp>
 #include <reshade_api_pipeline.hpp>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <shared_mutex>
 #include <unordered_map>
 
 namespace Shim {
 namespace Constants {
+// Returned by GetHostConstantBufferVersion if a copy method can't tell whether a buffer changed
+static constexpr uint64_t HOST_BUFFER_VERSION_UNKNOWN = UINT64_MAX;
+
+struct HostConstantBufferStats {
+    uint64_t buffers = 0;
+    uint64_t bytes = 0;
+    uint64_t writes = 0;           // hooked writes into shadowed buffers during the last frame
+    uint64_t unshadowedWrites = 0; // hooked writes during the last frame which hit no shadow and were dropped
+    // Creation content kept for buffers which haven't been mapped or written yet
+    uint64_t initialDataBuffers = 0;
+    uint64_t initialDataBytes = 0;
+};
+
 class ConstantCopyBase {
   public:
     ConstantCopyBase();
@@ -17,11 +34,21 @@ class ConstantCopyBase {
     virtual bool Init() = 0;
     virtual bool UnInit() = 0;
 
-    virtual void GetHostConstantBuffer(reshade::api::command_list* cmd_list,
+    // Returns false if nothing was copied into dest
+    virtual bool GetHostConstantBuffer(reshade::api::command_list* cmd_list,
                                        ShaderToggler::ToggleGroup* group,
                                        std::vector<uint8_t>& dest,
                                        size_t size,
                                        uint64_t resourceHandle);
+    /// <summary>
+    /// Marks a constant buffer as used by a group, creating its host copy if it isn't shadowed yet. Buffers which haven't been referenced for
+    /// HOST_BUFFER_IDLE_FRAMES frames are dropped again at present.
+    /// </summary>
+    virtual void ReferenceHostConstantBuffer(const reshade::api::resource_desc& desc, reshade::api::resource resource);
+    /// <summary>
+    /// Version of the host copy of a buffer, which changes with every write into it.
+    /// </summary>
+    virtual uint64_t GetHostConstantBufferVersion(uint64_t resourceHandle);
     virtual void CreateHostConstantBuffer(reshade::api::device* dev, reshade::api::resource resource, size_t size);
     virtual void DeleteHostConstantBuffer(reshade::api::resource resource);
     virtual inline void SetHostConstantBuffer(const uint64_t handle, const void* buffer, size_t size, uintptr_t offset, uint64_t bufferSize);
@@ -41,10 +68,55 @@ class ConstantCopyBase {
                                    reshade::api::map_access access,
                                    void** data) = 0;
     virtual void OnUnmapBufferRegion(reshade::api::device* device, reshade::api::resource resource) = 0;
+    virtual void OnReshadePresent(reshade::api::effect_runtime* runtime);
+    // Releases the GPU objects a copy method created on device
+    virtual void OnDestroyDevice(reshade::api::device* device);
+
+    static HostConstantBufferStats GetHostConstantBufferStats();
 
   protected:
-    static std::unordered_map<uint64_t, std::vector<uint8_t>> deviceToHostConstantBuffer;
-    static std::shared_mutex deviceHostMutex;
+    static constexpr uint64_t HOST_BUFFER_IDLE_FRAMES = 300;
+
+    /// <summary>
+    /// Host copy of a device constant buffer. Writers serialize on an odd sequence number, readers retry their copy if a write overlapped it.
+    /// </summary>
+    struct HostConstantBuffer {
+        explicit HostConstantBuffer(size_t size)
+          : data(size, 0)
+          , generation(hostBufferGeneration.fetch_add(1, std::memory_order_relaxed)) {}
+
+        void Write(const void* buffer, size_t size, uintptr_t offset);
+        void Read(void* dest, size_t size) const;
+
+        std::vector<uint8_t> data;
+        const uint64_t generation; // tells a recreated buffer apart from its predecessor
+        std::atomic<uint32_t> sequence = 0;
+        std::atomic<uint64_t> lastReferencedFrame = 0;
+        uint32_t reportedSequence = 0; // only touched at present
+    };
+
+    // Buffers are only added or removed under the exclusive lock of their shard, lookups and writes share it
+    struct alignas(64) HostConstantBufferShard {
+        std::shared_mutex mutex;
+        std::unordered_map<uint64_t, std::unique_ptr<HostConstantBuffer>> buffers;
+        std::unordered_map<uint64_t, std::vector<uint8_t>> initialData; // content passed at creation, seeds host copies created later
+    };
+
+    static constexpr uint32_t HOST_BUFFER_SHARD_BITS = 6;
+
+    static HostConstantBufferShard& GetShard(uint64_t handle);
+    /// <summary>
+    /// Drops the creation content of a buffer once the game maps or writes it, from then on its content comes from hooked writes.
+    /// </summary>
+    static void ReleaseInitialData(uint64_t handle);
+
+    static std::array<HostConstantBufferShard, 1 << HOST_BUFFER_SHARD_BITS> deviceToHostConstantBuffer;
+    static std::atomic<uint64_t> hostBufferFrame;
+    static std::atomic<uint64_t> hostBufferGeneration;
+    static std::atomic<uint64_t> unshadowedWrites;
+
+    static std::mutex hostBufferStatsMutex;
+    static HostConstantBufferStats hostBufferStats;
 };
 }
 }
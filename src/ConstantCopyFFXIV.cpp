@@ -27,7 +27,7 @@ bool ConstantCopyFFXIV::UnInit() {
     return MH_Uninitialize() == MH_OK;
 }
 
-void ConstantCopyFFXIV::GetHostConstantBuffer(command_list* cmd_list,
+bool ConstantCopyFFXIV::GetHostConstantBuffer(command_list* cmd_list,
                                               ShaderToggler::ToggleGroup* group,
                                               vector<uint8_t>& dest,
                                               size_t size,
@@ -37,7 +37,10 @@ void ConstantCopyFFXIV::GetHostConstantBuffer(command_list* cmd_list,
         auto& [buffer, bufHandle, bufSize, mapped] = _hostResourceBuffer[ff->second];
         size_t minSize = std::min(size, bufSize);
         memcpy(dest.data(), buffer, minSize);
+        return true;
     }
+
+    return false;
 }
 
 inline void ConstantCopyFFXIV::set_host_resource_data_location(void* origin, size_t len, int64_t resource_handle, size_t index) {
@@ -41,6 +41,8 @@ class ConstantCopyFFXIV final : public virtual ConstantCopyBase {
                         reshade::api::resource_usage usage,
                         reshade::api::resource handle) override final{};
     void OnDestroyResource(reshade::api::device* device, reshade::api::resource res) override final{};
+    void ReferenceHostConstantBuffer(const reshade::api::resource_desc& desc, reshade::api::resource resource) override final{};
+    uint64_t GetHostConstantBufferVersion(uint64_t resourceHandle) override final { return HOST_BUFFER_VERSION_UNKNOWN; };
     void OnUpdateBufferRegion(reshade::api::device* device, const void* data, reshade::api::resource resource, uint64_t offset, uint64_t size) override final{};
     void OnMapBufferRegion(reshade::api::device* device,
                            reshade::api::resource resource,
@@ -49,7 +51,7 @@ class ConstantCopyFFXIV final : public virtual ConstantCopyBase {
                            reshade::api::map_access access,
                            void** data) override final{};
     void OnUnmapBufferRegion(reshade::api::device* device, reshade::api::resource resource) override final{};
-    void GetHostConstantBuffer(reshade::api::command_list* cmd_list,
+    bool GetHostConstantBuffer(reshade::api::command_list* cmd_list,
                                ShaderToggler::ToggleGroup* group,
                                std::vector<uint8_t>& dest,
                                size_t size,
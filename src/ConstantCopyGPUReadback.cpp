@@ -1,5 +1,6 @@
 #include "ConstantCopyGPUReadback.h"
 #include "PipelinePrivateData.h"
+#include <algorithm>
 #include <cstring>
 
 using namespace Shim::Constants;
@@ -7,11 +8,89 @@ using namespace reshade::api;
 using namespace ShaderToggler;
 using namespace std;
 
-void ConstantCopyGPUReadback::GetHostConstantBuffer(reshade::api::command_list* cmd_list,
+bool ConstantCopyGPUReadback::GetHostConstantBuffer(reshade::api::command_list* cmd_list,
                                                     ShaderToggler::ToggleGroup* group,
                                                     vector<uint8_t>& dest,
                                                     size_t size,
                                                     uint64_t resourceHandle) {
+    if (readbackLatency == 0) {
+        return GetHostConstantBufferSynchronous(cmd_list, group, dest, size, resourceHandle);
+    }
+
+    device* dev = cmd_list->get_device();
+    resource src = resource{ resourceHandle };
+    const uint64_t srcSize = dev->get_resource_desc(src).buffer.size;
+
+    unique_lock<mutex> lock(ringMutex);
+
+    const DeviceFence& deviceFence = GetDeviceFence(dev);
+    ReadbackRing& ring = rings[group];
+
+    // Staging buffers belong to the device they were created on
+    if (ring.device != dev) {
+        if (ring.device != nullptr) {
+            ReleaseRing(ring);
+        }
+
+        ring.device = dev;
+    }
+
+    ring.lastUsedFrame = frame;
+
+    const uint32_t ringSize = deviceFence.latency + 1;
+    const uint64_t completed = deviceFence.fence != 0 ? dev->get_completed_fence_value(deviceFence.fence) : UINT64_MAX;
+    ReadbackSlot& target = ring.slots[frame % ringSize];
+
+    // Buffers are only replaced once they're too small and the GPU is done with the previous copy into them, which skips this frame's copy
+    // until then
+    const bool targetBusy = target.res != 0 && target.frame != UINT64_MAX && target.frame >= completed;
+    if ((target.res == 0 || target.size < srcSize) && !targetBusy) {
+        if (target.res != 0) {
+            dev->destroy_resource(target.res);
+            target = {};
+        }
+
+        if (!dev->create_resource(resource_desc(srcSize, memory_heap::gpu_to_cpu, resource_usage::copy_dest), nullptr, resource_usage::copy_dest, &target.res)) {
+            reshade::log::message(reshade::log::level::error, "Failed to create group constant readback buffer!");
+            target = {};
+        } else {
+            target.size = srcSize;
+        }
+    }
+
+    if (target.res != 0 && target.size >= srcSize) {
+        cmd_list->copy_buffer_region(src, 0, target.res, 0, srcSize);
+        target.frame = frame;
+    }
+
+    // Read the most recent copy which is old enough and has completed, keep the previous values if there's none yet
+    const ReadbackSlot* ready = nullptr;
+    for (const auto& slot : ring.slots) {
+        if (slot.res != 0 && slot.frame != UINT64_MAX && slot.frame + deviceFence.latency <= frame && slot.frame < completed &&
+            (ready == nullptr || slot.frame > ready->frame)) {
+            ready = &slot;
+        }
+    }
+
+    if (ready == nullptr) {
+        return false;
+    }
+
+    void* data = nullptr;
+    if (dev->map_buffer_region(ready->res, 0, ready->size, map_access::read_only, &data)) {
+        memcpy(dest.data(), data, static_cast<size_t>(std::min<uint64_t>(size, ready->size)));
+        dev->unmap_buffer_region(ready->res);
+        return true;
+    }
+
+    return false;
+}
+
+bool ConstantCopyGPUReadback::GetHostConstantBufferSynchronous(reshade::api::command_list* cmd_list,
+                                                               ShaderToggler::ToggleGroup* group,
+                                                               vector<uint8_t>& dest,
+                                                               size_t size,
+                                                               uint64_t resourceHandle) {
     resource src = resource{ resourceHandle };
     ShaderToggler::GroupResource& dst = group->GetGroupResource(ShaderToggler::GroupResourceType::RESOURCE_CONSTANTS_COPY);
     if (groupResourceManager.IsCompatibleWithGroupFormat(cmd_list->get_device(), ShaderToggler::GroupResourceType::RESOURCE_CONSTANTS_COPY, src, group)) {
@@ -20,9 +99,89 @@ void ConstantCopyGPUReadback::GetHostConstantBuffer(reshade::api::command_list*
         if (cmd_list->get_device()->map_buffer_region(dst.res, 0, size, map_access::read_only, &data)) {
             memcpy(dest.data(), data, size);
             cmd_list->get_device()->unmap_buffer_region(dst.res);
+            return true;
         }
     } else {
         dst.state = ShaderToggler::GroupResourceState::RESOURCE_INVALID;
         dst.target_description = cmd_list->get_device()->get_resource_desc(src);
     }
-}
\ No newline at end of file
+
+    return false;
+}
+
+ConstantCopyGPUReadback::DeviceFence& ConstantCopyGPUReadback::GetDeviceFence(device* device) {
+    const auto& [it, inserted] = fences.try_emplace(device);
+    DeviceFence& deviceFence = it->second;
+
+    if (inserted) {
+        deviceFence.latency = readbackLatency;
+
+        // Mapping a buffer doesn't wait for pending copies into it on these APIs
+        const device_api api = device->get_api();
+        if (api == device_api::d3d12 || api == device_api::vulkan) {
+            if (!device->create_fence(0, fence_flags::none, &deviceFence.fence)) {
+                reshade::log::message(reshade::log::level::warning, "Failed to create constant readback fence, falling back to a higher latency");
+                deviceFence.fence = { 0 };
+                deviceFence.latency = std::max(readbackLatency, UNFENCED_MIN_LATENCY);
+            }
+        }
+    }
+
+    return deviceFence;
+}
+
+void ConstantCopyGPUReadback::ReleaseRing(ReadbackRing& ring) {
+    for (auto& slot : ring.slots) {
+        if (slot.res != 0) {
+            ring.device->destroy_resource(slot.res);
+        }
+
+        slot = {};
+    }
+}
+
+void ConstantCopyGPUReadback::OnReshadePresent(effect_runtime* runtime) {
+    unique_lock<mutex> lock(ringMutex);
+
+    // Marks the end of the copies recorded this frame on the queue the game presents with
+    const auto& it = fences.find(runtime->get_device());
+    if (it != fences.end() && it->second.fence != 0) {
+        runtime->get_command_queue()->signal(it->second.fence, frame + 1);
+    }
+
+    frame++;
+
+    // Groups are only used as keys here, rings of removed or inactive groups are released once their last copy has surely completed
+    for (auto it = rings.begin(); it != rings.end();) {
+        if (frame - it->second.lastUsedFrame < RING_IDLE_FRAMES) {
+            ++it;
+            continue;
+        }
+
+        ReleaseRing(it->second);
+        it = rings.erase(it);
+    }
+}
+
+void ConstantCopyGPUReadback::OnDestroyDevice(device* device) {
+    unique_lock<mutex> lock(ringMutex);
+
+    const auto& it = fences.find(device);
+    if (it != fences.end()) {
+        if (it->second.fence != 0) {
+            device->destroy_fence(it->second.fence);
+        }
+
+        fences.erase(it);
+    }
+
+    for (auto it = rings.begin(); it != rings.end();) {
+        if (it->second.device != device) {
+            ++it;
+            continue;
+        }
+
+        ReleaseRing(it->second);
+        it = rings.erase(it);
+    }
+}
@@ -4,6 +4,8 @@
 #include "ToggleGroupResourceManager.h"
 #include <reshade_api.hpp>
 #include <reshade_api_device.hpp>
+#include <array>
+#include <mutex>
 #include <reshade_api_pipeline.hpp>
 #include <shared_mutex>
 #include <unordered_map>
@@ -11,19 +13,30 @@
 
 namespace Shim {
 namespace Constants {
+/// <summary>
+/// Copies constant buffers into host visible buffers on the GPU and reads them back. With a latency of 0 the copy is mapped right away, which
+/// waits for the GPU. Otherwise every group cycles through latency + 1 staging buffers and reads the newest copy that is at least latency frames
+/// old and has completed. On D3D12 and Vulkan completion is tracked with a fence signaled at present. The other APIs wait for pending copies when
+/// mapping. If a fence can't be created, the latency is raised to the default maximum frame latency of a swapchain instead.
+/// </summary>
 class ConstantCopyGPUReadback final : public virtual ConstantCopyBase {
   public:
-    ConstantCopyGPUReadback(Rendering::ToggleGroupResourceManager& gResourceManager)
-      : groupResourceManager(gResourceManager) {}
+    static constexpr uint32_t MAX_READBACK_LATENCY = 3;
+
+    ConstantCopyGPUReadback(Rendering::ToggleGroupResourceManager& gResourceManager, uint32_t latency)
+      : groupResourceManager(gResourceManager)
+      , readbackLatency(std::min(latency, MAX_READBACK_LATENCY)) {}
 
     bool Init() override final { return true; };
     bool UnInit() override final { return true; };
 
-    virtual void GetHostConstantBuffer(reshade::api::command_list* cmd_list,
+    virtual bool GetHostConstantBuffer(reshade::api::command_list* cmd_list,
                                        ShaderToggler::ToggleGroup* group,
                                        std::vector<uint8_t>& dest,
                                        size_t size,
                                        uint64_t resourceHandle) override final;
+    virtual void ReferenceHostConstantBuffer(const reshade::api::resource_desc& desc, reshade::api::resource resource) override final{};
+    virtual uint64_t GetHostConstantBufferVersion(uint64_t resourceHandle) override final { return HOST_BUFFER_VERSION_UNKNOWN; };
     virtual void CreateHostConstantBuffer(reshade::api::device* dev, reshade::api::resource resource, size_t size) override final{};
     virtual void DeleteHostConstantBuffer(reshade::api::resource resource) override final{};
     virtual void SetHostConstantBuffer(const uint64_t handle, const void* buffer, size_t size, uintptr_t offset, uint64_t bufferSize) override final{};
@@ -47,10 +60,48 @@ class ConstantCopyGPUReadback final : public virtual ConstantCopyBase {
                                    reshade::api::map_access access,
                                    void** data) override final{};
     virtual void OnUnmapBufferRegion(reshade::api::device* device, reshade::api::resource resource) override final{};
+    virtual void OnReshadePresent(reshade::api::effect_runtime* runtime) override final;
+    virtual void OnDestroyDevice(reshade::api::device* device) override final;
 
   private:
-    std::unordered_map<uint64_t, reshade::api::resource> resToCopyBuffer;
+    // Rings of groups which haven't extracted constants for this many frames are released
+    static constexpr uint64_t RING_IDLE_FRAMES = 120;
+    // Frames the GPU may lag behind at most, used as latency where completion can't be tracked
+    static constexpr uint32_t UNFENCED_MIN_LATENCY = 3;
+    static_assert(UNFENCED_MIN_LATENCY <= MAX_READBACK_LATENCY);
+
+    struct ReadbackSlot {
+        reshade::api::resource res = { 0 };
+        uint64_t size = 0;
+        uint64_t frame = UINT64_MAX; // frame the slot was last copied into
+    };
+
+    struct DeviceFence {
+        reshade::api::fence fence = { 0 }; // signaled with frame + 1 at present, 0 if the device doesn't need or have one
+        uint32_t latency = 0;
+    };
+
+    struct ReadbackRing {
+        reshade::api::device* device = nullptr;
+        uint64_t lastUsedFrame = 0;
+        std::array<ReadbackSlot, MAX_READBACK_LATENCY + 1> slots;
+    };
+
+    bool GetHostConstantBufferSynchronous(reshade::api::command_list* cmd_list,
+                                          ShaderToggler::ToggleGroup* group,
+                                          std::vector<uint8_t>& dest,
+                                          size_t size,
+                                          uint64_t resourceHandle);
+    void ReleaseRing(ReadbackRing& ring);
+    DeviceFence& GetDeviceFence(reshade::api::device* device);
+
     Rendering::ToggleGroupResourceManager& groupResourceManager;
+    const uint32_t readbackLatency;
+
+    std::mutex ringMutex;
+    uint64_t frame = 0;
+    std::unordered_map<const ShaderToggler::ToggleGroup*, ReadbackRing> rings;
+    std::unordered_map<const reshade::api::device*, DeviceFence> fences;
 };
 }
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "ConstantCopyMemcpyNested.h"
+#include <algorithm>
 
 using namespace Shim::Constants;
 using namespace reshade::api;
@@ -6,16 +7,64 @@ using namespace std;
 
 ConstantCopyMemcpyNested::ConstantCopyMemcpyNested() {
     _instance = this;
+    PublishIndex(make_unique<MappedRangeIndex>());
 }
 
 ConstantCopyMemcpyNested::~ConstantCopyMemcpyNested() {}
 
+void ConstantCopyMemcpyNested::PublishIndex(unique_ptr<MappedRangeIndex> index) {
+    // Bounds are widened before and narrowed after the new snapshot is visible, so the early out never rejects a mapped address
+    const uintptr_t minAddress = index->ranges.empty() ? UINTPTR_MAX : index->ranges.front().begin;
+    uintptr_t maxAddress = 0;
+    for (const auto& range : index->ranges) {
+        maxAddress = std::max(maxAddress, range.end);
+    }
+
+    _minAddress.store(std::min(minAddress, _minAddress.load(memory_order_relaxed)), memory_order_release);
+    _maxAddress.store(std::max(maxAddress, _maxAddress.load(memory_order_relaxed)), memory_order_release);
+
+    _index.store(index.get(), memory_order_release);
+
+    _minAddress.store(minAddress, memory_order_release);
+    _maxAddress.store(maxAddress, memory_order_release);
+
+    if (_owner != nullptr) {
+        _retired.emplace_back(_epoch, std::move(_owner));
+    }
+
+    _owner = std::move(index);
+}
+
 void ConstantCopyMemcpyNested::OnMapBufferRegion(device* device, resource resource, uint64_t offset, uint64_t size, map_access access, void** data) {
     if (access == map_access::write_discard || access == map_access::write_only) {
         resource_desc desc = device->get_resource_desc(resource);
+        // Every constant buffer window is indexed, a buffer may only get shadowed while it stays mapped. Writes into unshadowed ones are dropped
+        // by SetHostConstantBuffer.
         if (desc.heap == memory_heap::cpu_to_gpu && static_cast<uint32_t>(desc.usage & resource_usage::constant_buffer)) {
-            unique_lock<shared_mutex> lock(_map_mutex);
-            _resourceMemoryMapping[resource.handle] = BufferCopy{ resource.handle, *data, nullptr, offset, size, desc.buffer.size };
+            const uintptr_t begin = reinterpret_cast<uintptr_t>(*data);
+            const MappedRange mapped = { begin, begin + desc.buffer.size - offset, resource.handle, desc.buffer.size, offset };
+
+            unique_lock<mutex> lock(_map_mutex);
+            _resourceMemoryMapping[resource.handle] = mapped;
+
+            // Patch a copy of the current snapshot instead of sorting from scratch
+            unique_ptr<MappedRangeIndex> index = make_unique<MappedRangeIndex>();
+            index->ranges.reserve(_owner->ranges.size() + 1);
+
+            for (const auto& range : _owner->ranges) {
+                if (range.resource != resource.handle) {
+                    index->ranges.push_back(range);
+                }
+            }
+
+            const auto& pos = upper_bound(
+              index->ranges.begin(), index->ranges.end(), mapped.begin, [](uintptr_t address, const MappedRange& range) { return address < range.begin; });
+            index->ranges.insert(pos, mapped);
+
+            PublishIndex(std::move(index));
+            lock.unlock();
+
+            ReleaseInitialData(resource.handle);
         }
     }
 }
@@ -24,21 +73,55 @@ void ConstantCopyMemcpyNested::OnUnmapBufferRegion(device* device, resource reso
 
     resource_desc desc = device->get_resource_desc(resource);
     if (desc.heap == memory_heap::cpu_to_gpu && static_cast<uint32_t>(desc.usage & resource_usage::constant_buffer)) {
-        unique_lock<shared_mutex> lock(_map_mutex);
-        _resourceMemoryMapping.erase(resource.handle);
+        unique_lock<mutex> lock(_map_mutex);
+
+        if (_resourceMemoryMapping.erase(resource.handle) == 0) {
+            return;
+        }
+
+        unique_ptr<MappedRangeIndex> index = make_unique<MappedRangeIndex>();
+        index->ranges.reserve(_owner->ranges.size());
+
+        for (const auto& range : _owner->ranges) {
+            if (range.resource != resource.handle) {
+                index->ranges.push_back(range);
+            }
+        }
+
+        PublishIndex(std::move(index));
     }
 }
 
+void ConstantCopyMemcpyNested::OnReshadePresent(effect_runtime* runtime) {
+    ConstantCopyBase::OnReshadePresent(runtime);
+
+    unique_lock<mutex> lock(_map_mutex);
+
+    _epoch++;
+    erase_if(_retired, [this](const auto& entry) { return _epoch - entry.first >= RECLAIM_LATENCY; });
+}
+
 void ConstantCopyMemcpyNested::OnMemcpy(void* volatile dest, void* src, size_t size) {
-    shared_lock<shared_mutex> lock(_map_mutex);
-    if (_resourceMemoryMapping.size() > 0) {
-        for (auto& [_, buffer] : _resourceMemoryMapping) {
-            if (dest >= buffer.destination && static_cast<uintptr_t>(reinterpret_cast<intptr_t>(dest)) <=
-                                                reinterpret_cast<intptr_t>(buffer.destination) + buffer.bufferSize - buffer.offset) {
-                SetHostConstantBuffer(
-                  buffer.resource, src, size, reinterpret_cast<intptr_t>(dest) - reinterpret_cast<intptr_t>(buffer.destination), buffer.bufferSize);
-                break;
-            }
-        }
+    const uintptr_t destPtr = reinterpret_cast<uintptr_t>(dest);
+
+    // Rejects almost every memcpy in the process without touching the index
+    if (destPtr < _minAddress.load(memory_order_acquire) || destPtr > _maxAddress.load(memory_order_acquire)) {
+        return;
+    }
+
+    const MappedRangeIndex* index = _index.load(memory_order_acquire);
+
+    // Last window starting at or before dest
+    const auto& it = upper_bound(
+      index->ranges.begin(), index->ranges.end(), destPtr, [](uintptr_t address, const MappedRange& range) { return address < range.begin; });
+
+    if (it == index->ranges.begin()) {
+        return;
     }
-}
\ No newline at end of file
+
+    const MappedRange& range = *(it - 1);
+
+    if (destPtr <= range.end) {
+        SetHostConstantBuffer(range.resource, src, size, range.offset + (destPtr - range.begin), range.bufferSize);
+    }
+}
@@ -1,5 +1,8 @@
 #pragma once
 #include "ConstantCopyMemcpy.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
 
 namespace Shim {
 namespace Constants {
@@ -16,10 +19,39 @@ class ConstantCopyMemcpyNested final : public virtual ConstantCopyMemcpy {
                            reshade::api::map_access access,
                            void** data) override final;
     void OnUnmapBufferRegion(reshade::api::device* device, reshade::api::resource resource) override final;
+    void OnReshadePresent(reshade::api::effect_runtime* runtime) override final;
 
   private:
-    std::unordered_map<uint64_t, BufferCopy> _resourceMemoryMapping;
-    std::shared_mutex _map_mutex;
+    // Snapshots replaced longer than this many presents ago are freed, no memcpy can still be looking at them
+    static constexpr uint64_t RECLAIM_LATENCY = 3;
+
+    struct MappedRange {
+        uintptr_t begin = 0;
+        uintptr_t end = 0; // inclusive
+        uint64_t resource = 0;
+        uint64_t bufferSize = 0;
+        uint64_t offset = 0; // buffer offset the window starts at
+    };
+
+    /// <summary>
+    /// Immutable snapshot of all mapped constant buffer windows, sorted by address. memcpy reads it without locks, map and unmap publish a
+    /// patched copy.
+    /// </summary>
+    struct MappedRangeIndex {
+        std::vector<MappedRange> ranges;
+    };
+
+    void PublishIndex(std::unique_ptr<MappedRangeIndex> index);
+
+    std::unordered_map<uint64_t, MappedRange> _resourceMemoryMapping;
+    std::mutex _map_mutex;
+
+    std::atomic<const MappedRangeIndex*> _index = nullptr;
+    std::atomic<uintptr_t> _minAddress = UINTPTR_MAX;
+    std::atomic<uintptr_t> _maxAddress = 0;
+    std::unique_ptr<MappedRangeIndex> _owner;
+    uint64_t _epoch = 0;
+    std::vector<std::pair<uint64_t, std::unique_ptr<MappedRangeIndex>>> _retired;
 };
 }
-}
\ No newline at end of file
+}
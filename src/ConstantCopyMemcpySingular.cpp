@@ -4,7 +4,7 @@ using namespace Shim::Constants;
 using namespace reshade::api;
 using namespace std;
 
-BufferCopy ConstantCopyMemcpySingular::_bufferCopy;
+thread_local BufferCopy ConstantCopyMemcpySingular::_bufferCopy;
 
 ConstantCopyMemcpySingular::ConstantCopyMemcpySingular() {
     _instance = this;
@@ -15,23 +15,25 @@ ConstantCopyMemcpySingular::~ConstantCopyMemcpySingular() {}
 void ConstantCopyMemcpySingular::OnMapBufferRegion(device* device, resource resource, uint64_t offset, uint64_t size, map_access access, void** data) {
     if (access == map_access::write_discard || access == map_access::write_only) {
         resource_desc desc = device->get_resource_desc(resource);
-        const auto& it = deviceToHostConstantBuffer.find(resource.handle);
 
-        if (it != deviceToHostConstantBuffer.end()) {
-            auto& [_, buf] = *it;
+        // Writes into buffers no group shadows yet are dropped by SetHostConstantBuffer
+        if (desc.heap == memory_heap::cpu_to_gpu && static_cast<uint32_t>(desc.usage & resource_usage::constant_buffer)) {
             _bufferCopy.resource = resource.handle;
             _bufferCopy.destination = *data;
             _bufferCopy.size = size;
             _bufferCopy.offset = offset;
             _bufferCopy.bufferSize = desc.buffer.size;
-            _bufferCopy.hostDestination = buf.data();
+
+            ReleaseInitialData(resource.handle);
         }
     }
 }
 
 void ConstantCopyMemcpySingular::OnUnmapBufferRegion(device* device, resource resource) {
-    _bufferCopy.resource = 0;
-    _bufferCopy.destination = nullptr;
+    if (_bufferCopy.resource == resource.handle) {
+        _bufferCopy.resource = 0;
+        _bufferCopy.destination = nullptr;
+    }
 }
 
 void ConstantCopyMemcpySingular::OnMemcpy(void* dest, void* src, size_t size) {
@@ -39,6 +41,7 @@ void ConstantCopyMemcpySingular::OnMemcpy(void* dest, void* src, size_t size) {
     uintptr_t destinationPtr = reinterpret_cast<uintptr_t>(_bufferCopy.destination);
 
     if (_bufferCopy.resource != 0 && destPtr >= destinationPtr && destPtr <= destinationPtr + _bufferCopy.bufferSize - _bufferCopy.offset) {
-        memcpy(_bufferCopy.hostDestination, src, size);
+        // The shadow is looked up by handle, it may have been destroyed or reallocated since the map
+        SetHostConstantBuffer(_bufferCopy.resource, src, size, _bufferCopy.offset + (destPtr - destinationPtr), _bufferCopy.bufferSize);
     }
 }
\ No newline at end of file
@@ -18,7 +18,8 @@ class ConstantCopyMemcpySingular final : public virtual ConstantCopyMemcpy {
     void OnUnmapBufferRegion(reshade::api::device* device, reshade::api::resource resource) override final;
 
   private:
-    static BufferCopy _bufferCopy;
+    // Every thread only sees the buffer it mapped itself, so concurrent map and memcpy on other threads can't redirect its writes
+    static thread_local BufferCopy _bufferCopy;
 };
 }
 }
\ No newline at end of file
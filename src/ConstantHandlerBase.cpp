@@ -9,9 +9,11 @@ using namespace ShaderToggler;
 using namespace std;
 
 unordered_map<string, tuple<constant_type, vector<effect_uniform_variable>>> ConstantHandlerBase::restVariables;
+uint32_t ConstantHandlerBase::restVariablesVersion = 0;
 char ConstantHandlerBase::charBuffer[CHAR_BUFFER_SIZE];
 ConstantCopyBase* ConstantHandlerBase::_constCopy;
 std::shared_mutex ConstantHandlerBase::groupBufferMutex;
+std::shared_mutex ConstantHandlerBase::varMutex;
 
 ConstantHandlerBase::ConstantHandlerBase() {}
 
@@ -22,16 +24,18 @@ void ConstantHandlerBase::SetConstantCopy(ConstantCopyBase* constantCopy) {
 }
 
 size_t ConstantHandlerBase::GetConstantBufferSize(const ToggleGroup* group) {
-    if (groupBufferSize.contains(group)) {
-        return groupBufferSize.at(group);
+    const auto& it = groupConstants.find(group);
+    if (it != groupConstants.end() && !it->second.slots.empty()) {
+        return it->second.size;
     }
 
     return 0;
 }
 
 const uint8_t* ConstantHandlerBase::GetConstantBuffer(const ToggleGroup* group) {
-    if (groupBufferContent.contains(group)) {
-        return groupBufferContent.at(group).data();
+    const auto& it = groupConstants.find(group);
+    if (it != groupConstants.end() && !it->second.slots.empty()) {
+        return it->second.Get(0);
     }
 
     return nullptr;
@@ -42,7 +46,11 @@ unordered_map<string, tuple<constant_type, vector<effect_uniform_variable>>>* Co
 }
 
 void ConstantHandlerBase::ReloadConstantVariables(effect_runtime* runtime) {
+    // Compiled bindings point into restVariables, nobody may read them while they're rebuilt
+    unique_lock<shared_mutex> lock(varMutex);
+
     restVariables.clear();
+    restVariablesVersion++;
 
     runtime->enumerate_uniform_variables(nullptr, [](effect_runtime* rt, effect_uniform_variable variable) {
         if (!rt->get_annotation_string_from_uniform_variable<CHAR_BUFFER_SIZE>(variable, "source", charBuffer)) {
@@ -112,7 +120,10 @@ void ConstantHandlerBase::ReloadConstantVariables(effect_runtime* runtime) {
 }
 
 void ConstantHandlerBase::ClearConstantVariables() {
+    unique_lock<shared_mutex> lock(varMutex);
+
     restVariables.clear();
+    restVariablesVersion++;
 }
 
 void ConstantHandlerBase::OnEffectsReloading(effect_runtime* runtime) {
@@ -171,9 +182,14 @@ bool ConstantHandlerBase::UpdateConstantBufferEntries(command_list* cmd_list,
     if (buf != nullptr && buf->constant.buffer != 0) {
         unique_lock<shared_mutex> lock(groupBufferMutex);
 
-        SetBufferRange(group, buf->constant, cmd_list->get_device(), cmd_list);
-        ApplyConstantValues(devData.current_runtime, group, restVariables);
-        devData.constantsUpdated.insert(group);
+        const bool changed = SetBufferRange(group, buf->constant, cmd_list->get_device(), cmd_list);
+
+        // Reloaded effects or an edited mapping need the values applied again, even if the buffer stayed the same
+        if (CompileBindings(group) || changed) {
+            ApplyConstantValues(devData.current_runtime, group);
+        }
+
+        devData.constantsUpdated.set(group->getIndex());
 
         return true;
     }
@@ -202,14 +218,18 @@ bool ConstantHandlerBase::UpdateConstantEntries(command_list* cmd_list,
     if (const_buffer_size == 0)
         return false;
 
-    const vector<uint32_t>* buf = state.get_constants_at(index, slot); // current_constants.at(slot);
+    const StateTracking::constant_span buf = state.get_constants_at(index, slot);
 
-    if (buf != nullptr) {
+    if (buf.data != nullptr) {
         unique_lock<shared_mutex> lock(groupBufferMutex);
 
-        SetConstants(group, *buf, cmd_list->get_device(), cmd_list);
-        ApplyConstantValues(devData.current_runtime, group, restVariables);
-        devData.constantsUpdated.insert(group);
+        const bool changed = SetConstants(group, buf.data, buf.size, cmd_list->get_device(), cmd_list);
+
+        if (CompileBindings(group) || changed) {
+            ApplyConstantValues(devData.current_runtime, group);
+        }
+
+        devData.constantsUpdated.set(group->getIndex());
     }
 
     return true;
@@ -230,33 +250,33 @@ void ConstantHandlerBase::UpdateConstants(command_list* cmd_list) {
         return;
     }
 
-    vector<ToggleGroup*> psRemovalList;
-    vector<ToggleGroup*> vsRemovalList;
-    vector<ToggleGroup*> csRemovalList;
+    group_set psRemovalList;
+    group_set vsRemovalList;
+    group_set csRemovalList;
 
     for (const auto& cb : commandListData.ps.constantBuffersToUpdate) {
-        if (!deviceData.constantsUpdated.contains(cb)) {
+        if (!deviceData.constantsUpdated.test(cb->getIndex())) {
             if (!cb->getCBIsPushMode() && UpdateConstantBufferEntries(cmd_list, commandListData, deviceData, cb, cb->getCBShaderStage()) ||
                 cb->getCBIsPushMode() && UpdateConstantEntries(cmd_list, commandListData, deviceData, cb, cb->getCBShaderStage())) {
-                psRemovalList.push_back(cb);
+                psRemovalList.insert(cb);
             }
         }
     }
 
     for (const auto& cb : commandListData.vs.constantBuffersToUpdate) {
-        if (!deviceData.constantsUpdated.contains(cb)) {
+        if (!deviceData.constantsUpdated.test(cb->getIndex())) {
             if (!cb->getCBIsPushMode() && UpdateConstantBufferEntries(cmd_list, commandListData, deviceData, cb, cb->getCBShaderStage()) ||
                 cb->getCBIsPushMode() && UpdateConstantEntries(cmd_list, commandListData, deviceData, cb, cb->getCBShaderStage())) {
-                vsRemovalList.push_back(cb);
+                vsRemovalList.insert(cb);
             }
         }
     }
 
     for (const auto& cb : commandListData.cs.constantBuffersToUpdate) {
-        if (!deviceData.constantsUpdated.contains(cb)) {
+        if (!deviceData.constantsUpdated.test(cb->getIndex())) {
             if (!cb->getCBIsPushMode() && UpdateConstantBufferEntries(cmd_list, commandListData, deviceData, cb, cb->getCBShaderStage()) ||
                 cb->getCBIsPushMode() && UpdateConstantEntries(cmd_list, commandListData, deviceData, cb, cb->getCBShaderStage())) {
-                csRemovalList.push_back(cb);
+                csRemovalList.insert(cb);
             }
         }
     }
@@ -274,98 +294,183 @@ void ConstantHandlerBase::UpdateConstants(command_list* cmd_list) {
     }
 }
 
-void ConstantHandlerBase::ApplyConstantValues(effect_runtime* runtime,
-                                              const ToggleGroup* group,
-                                              const unordered_map<string, tuple<constant_type, vector<effect_uniform_variable>>>& constants) {
+void ConstantHandlerBase::ApplyConstantValues(effect_runtime* runtime, const ToggleGroup* group) {
     unique_lock<shared_mutex> lock(varMutex);
 
-    if (!groupBufferContent.contains(group) || runtime == nullptr) {
+    const auto& groupIt = groupConstants.find(group);
+
+    if (groupIt == groupConstants.end() || groupIt->second.slots.empty() || runtime == nullptr) {
         return;
     }
 
-    const uint8_t* buffer = groupBufferContent.at(group).data();
-    const uint8_t* prevBuffer = groupPrevBufferContent.at(group).data();
-
-    for (const auto& [varName, varData] : group->GetVarOffsetMapping()) {
-        const auto& [offset, prevValue] = varData;
+    const GroupConstants& groupData = groupIt->second;
 
-        const uint8_t* bufferInUse = prevValue ? prevBuffer : buffer;
+    // The spans point into restVariables, they're stale until the bindings have been compiled against the reloaded variables
+    if (groupData.restVariablesVersion != restVariablesVersion) {
+        return;
+    }
 
-        if (!constants.contains(varName)) {
+    for (const auto& binding : groupData.bindings) {
+        if (binding.offset + binding.byteSize >= groupData.size) {
             continue;
         }
 
-        const auto& [type, effect_variables] = constants.at(varName);
-        uint32_t typeIndex = static_cast<uint32_t>(type);
-        size_t bufferSize = groupBufferSize.at(group);
+        const uint8_t* value = groupData.Get(binding.framesBack) + binding.offset;
+        const uint32_t length = static_cast<uint32_t>(type_length[static_cast<uint32_t>(binding.type)]);
 
-        if (offset + type_size[typeIndex] * type_length[typeIndex] >= bufferSize) {
-            continue;
-        }
-
-        for (const auto& effect_var : effect_variables) {
-            if (type <= constant_type::type_float4x4) {
-                runtime->set_uniform_value_float(effect_var, reinterpret_cast<const float*>(bufferInUse + offset), type_length[typeIndex], 0);
-            } else if (type == constant_type::type_int) {
-                runtime->set_uniform_value_int(effect_var, reinterpret_cast<const int32_t*>(bufferInUse + offset), type_length[typeIndex], 0);
+        for (const auto& effect_var : binding.variables) {
+            if (binding.type <= constant_type::type_float4x4) {
+                runtime->set_uniform_value_float(effect_var, reinterpret_cast<const float*>(value), length, 0);
+            } else if (binding.type == constant_type::type_int) {
+                runtime->set_uniform_value_int(effect_var, reinterpret_cast<const int32_t*>(value), length, 0);
             } else {
-                runtime->set_uniform_value_uint(effect_var, reinterpret_cast<const uint32_t*>(bufferInUse + offset), type_length[typeIndex], 0);
+                runtime->set_uniform_value_uint(effect_var, reinterpret_cast<const uint32_t*>(value), length, 0);
             }
         }
     }
 }
 
-void ConstantHandlerBase::SetConstants(const ToggleGroup* group, const vector<uint32_t>& buf, device* dev, command_list* cmd_list) {
-    if (dev == nullptr || cmd_list == nullptr || buf.size() == 0) {
-        return;
+void ConstantHandlerBase::GroupConstants::Reset(size_t newSize, uint32_t depth) {
+    slots.assign(depth, vector<uint8_t>(newSize, 0));
+    size = newSize;
+    current = 0;
+    settledSlots = 0;
+    resource = 0;
+    version = HOST_BUFFER_VERSION_UNKNOWN;
+}
+
+const uint8_t* ConstantHandlerBase::GroupConstants::Get(uint32_t framesBack) const {
+    const uint32_t depth = static_cast<uint32_t>(slots.size());
+    framesBack = std::min(framesBack, depth - 1);
+
+    return slots[(current + depth - framesBack) % depth].data();
+}
+
+bool ConstantHandlerBase::CompileBindings(const ToggleGroup* group) {
+    GroupConstants& constants = groupConstants[group];
+    shared_lock<shared_mutex> lock(varMutex);
+
+    if (constants.varMappingVersion == group->getVarMappingVersion() && constants.restVariablesVersion == restVariablesVersion) {
+        return false;
+    }
+
+    constants.bindings.clear();
+
+    for (const auto& [varName, varData] : group->GetVarOffsetMapping()) {
+        const auto& vars = restVariables.find(varName);
+
+        if (vars == restVariables.end()) {
+            continue;
+        }
+
+        const auto& [offset, framesBack] = varData;
+        const auto& [type, effect_variables] = vars->second;
+        const uint32_t typeIndex = static_cast<uint32_t>(type);
+
+        constants.bindings.push_back({ offset, framesBack, type, type_size[typeIndex] * type_length[typeIndex], effect_variables });
+    }
+
+    constants.varMappingVersion = group->getVarMappingVersion();
+    constants.restVariablesVersion = restVariablesVersion;
+
+    return true;
+}
+
+bool ConstantHandlerBase::SettleHistory(GroupConstants& constants) {
+    if (constants.settledSlots >= constants.slots.size()) {
+        return false;
     }
 
-    InitBuffers(group, buf.size());
+    // The content stopped changing, the older slots catch up one extraction at a time until the whole history holds it
+    const uint32_t next = constants.Next();
+    std::memcpy(constants.slots[next].data(), constants.slots[constants.current].data(), constants.size);
+    constants.current = next;
+    constants.settledSlots++;
 
-    vector<uint8_t>& bufferContent = groupBufferContent.at(group);
-    vector<uint8_t>& prevBufferContent = groupPrevBufferContent.at(group);
+    return true;
+}
+
+bool ConstantHandlerBase::SetConstants(const ToggleGroup* group, const uint32_t* values, uint32_t count, device* dev, command_list* cmd_list) {
+    if (dev == nullptr || cmd_list == nullptr || values == nullptr || count == 0) {
+        return false;
+    }
 
-    std::memcpy(prevBufferContent.data(), bufferContent.data(), buf.size());
-    std::memcpy(bufferContent.data(), reinterpret_cast<const uint8_t*>(buf.data()), buf.size() * 4);
+    const size_t size = count * sizeof(uint32_t);
+
+    GroupConstants& constants = InitBuffers(group, size);
+
+    // Push constants carry no version, they are small enough to compare
+    if (constants.version != HOST_BUFFER_VERSION_UNKNOWN && std::memcmp(constants.Get(0), values, size) == 0) {
+        return SettleHistory(constants);
+    }
+
+    constants.current = constants.Next();
+    std::memcpy(constants.slots[constants.current].data(), values, size);
+
+    constants.settledSlots = 1;
+    constants.resource = 0;
+    constants.version = 0;
+
+    return true;
 }
 
-void ConstantHandlerBase::SetBufferRange(ToggleGroup* group, buffer_range range, device* dev, command_list* cmd_list) {
+bool ConstantHandlerBase::SetBufferRange(ToggleGroup* group, buffer_range range, device* dev, command_list* cmd_list) {
     if (dev == nullptr || cmd_list == nullptr || range.buffer == 0) {
-        return;
+        return false;
     }
 
     resource_desc targetBufferDesc = dev->get_resource_desc(range.buffer);
     size_t size = static_cast<size_t>(targetBufferDesc.buffer.size);
 
-    InitBuffers(group, size);
+    GroupConstants& constants = InitBuffers(group, size);
 
-    vector<uint8_t>& bufferContent = groupBufferContent.at(group);
-    vector<uint8_t>& prevBufferContent = groupPrevBufferContent.at(group);
+    _constCopy->ReferenceHostConstantBuffer(targetBufferDesc, range.buffer);
 
-    std::memcpy(prevBufferContent.data(), bufferContent.data(), size);
-    _constCopy->GetHostConstantBuffer(cmd_list, group, bufferContent, size, range.buffer.handle);
-}
+    // Read before the copy, a write racing with it only causes another extraction next time
+    const uint64_t version = _constCopy->GetHostConstantBufferVersion(range.buffer.handle);
+
+    if (version != HOST_BUFFER_VERSION_UNKNOWN && constants.resource == range.buffer.handle && constants.version == version) {
+        return SettleHistory(constants);
+    }
 
-void ConstantHandlerBase::InitBuffers(const ToggleGroup* group, size_t size) {
-    const auto& content = groupBufferContent.find(group);
-
-    if (content != groupBufferContent.end() && size != content->second.size()) {
-        groupBufferContent[group].resize(size, 0);
-        groupPrevBufferContent[group].resize(size, 0);
-        groupBufferSize[group] = size;
-    } else if (content == groupBufferContent.end()) {
-        groupBufferContent.emplace(group, vector<uint8_t>(size, 0));
-        groupPrevBufferContent.emplace(group, vector<uint8_t>(size, 0));
-        groupBufferSize.emplace(group, size);
+    // The oldest slot is overwritten in place, it only becomes the current one if the copy method had something to copy
+    const uint32_t next = constants.Next();
+    if (!_constCopy->GetHostConstantBuffer(cmd_list, group, constants.slots[next], size, range.buffer.handle)) {
+        return SettleHistory(constants);
     }
+
+    constants.current = next;
+    constants.settledSlots = 1;
+    constants.resource = range.buffer.handle;
+    constants.version = version;
+
+    return true;
 }
 
-void ConstantHandlerBase::RemoveGroup(const ToggleGroup* group, device* dev) {
-    if (!groupBufferContent.contains(group)) {
-        return;
+ConstantHandlerBase::GroupConstants& ConstantHandlerBase::InitBuffers(const ToggleGroup* group, size_t size) {
+    GroupConstants& constants = groupConstants[group];
+
+    // The history only reaches as far back as the group's bindings ask for
+    if (constants.historyMappingVersion != group->getVarMappingVersion()) {
+        uint32_t depth = 1;
+        for (const auto& [_, varData] : group->GetVarOffsetMapping()) {
+            depth = std::max(depth, std::min(std::get<1>(varData), MAX_CONSTANT_HISTORY) + 1);
+        }
+
+        constants.historyMappingVersion = group->getVarMappingVersion();
+
+        if (depth != constants.slots.size()) {
+            constants.Reset(size, depth);
+        }
+    }
+
+    if (size != constants.size) {
+        constants.Reset(size, static_cast<uint32_t>(constants.slots.size()));
     }
 
-    groupBufferContent.erase(group);
-    groupPrevBufferContent.erase(group);
-    groupBufferSize.erase(group);
-}
\ No newline at end of file
+    return constants;
+}
+
+void ConstantHandlerBase::RemoveGroup(const ToggleGroup* group, device* dev) {
+    groupConstants.erase(group);
+}
@@ -8,6 +8,7 @@
 #include <reshade_api_device.hpp>
 #include <reshade_api_pipeline.hpp>
 #include <shared_mutex>
+#include <span>
 #include <unordered_map>
 
 struct CommandListDataContainer;
@@ -69,14 +70,19 @@ static constexpr const char* type_desc[] = {
 
 static constexpr size_t CHAR_BUFFER_SIZE = 256;
 
+// Deepest history a variable binding can read its value from, in extractions
+static constexpr uint32_t MAX_CONSTANT_HISTORY = 8;
+
 class __declspec(novtable) ConstantHandlerBase final {
   public:
     ConstantHandlerBase();
     ~ConstantHandlerBase();
 
-    void SetBufferRange(ShaderToggler::ToggleGroup* group, reshade::api::buffer_range range, reshade::api::device* dev, reshade::api::command_list* cmd_list);
-    void SetConstants(const ShaderToggler::ToggleGroup* group,
-                      const std::vector<uint32_t>& buf,
+    // Both return whether the group's constants changed since the last extraction
+    bool SetBufferRange(ShaderToggler::ToggleGroup* group, reshade::api::buffer_range range, reshade::api::device* dev, reshade::api::command_list* cmd_list);
+    bool SetConstants(const ShaderToggler::ToggleGroup* group,
+                      const uint32_t* values,
+                      uint32_t count,
                       reshade::api::device* dev,
                       reshade::api::command_list* cmd_list);
     std::shared_mutex& GetBufferMutex() { return groupBufferMutex; }
@@ -86,9 +92,7 @@ class __declspec(novtable) ConstantHandlerBase final {
     void ReloadConstantVariables(reshade::api::effect_runtime* runtime);
     void UpdateConstants(reshade::api::command_list* cmd_list);
     void ClearConstantVariables();
-    void ApplyConstantValues(reshade::api::effect_runtime* runtime,
-                             const ShaderToggler::ToggleGroup*,
-                             const std::unordered_map<std::string, std::tuple<constant_type, std::vector<reshade::api::effect_uniform_variable>>>& constants);
+    void ApplyConstantValues(reshade::api::effect_runtime* runtime, const ShaderToggler::ToggleGroup* group);
 
     void OnEffectsReloading(reshade::api::effect_runtime* runtime);
     void OnEffectsReloaded(reshade::api::effect_runtime* runtime);
@@ -98,19 +102,53 @@ class __declspec(novtable) ConstantHandlerBase final {
     static void SetConstantCopy(ConstantCopyBase* constantHandler);
 
   private:
-    std::unordered_map<const ShaderToggler::ToggleGroup*, std::vector<uint8_t>> groupBufferContent;
-    std::unordered_map<const ShaderToggler::ToggleGroup*, std::vector<uint8_t>> groupPrevBufferContent;
-    std::unordered_map<const ShaderToggler::ToggleGroup*, size_t> groupBufferSize;
+    /// <summary>
+    /// A variable binding of a group resolved against the effect uniforms, so applying it needs no lookups.
+    /// </summary>
+    struct CompiledBinding {
+        uintptr_t offset = 0;
+        uint32_t framesBack = 0;
+        constant_type type = constant_type::type_unknown;
+        size_t byteSize = 0;
+        std::span<const reshade::api::effect_uniform_variable> variables;
+    };
+
+    /// <summary>
+    /// Ring of a group's last extractions, slot current holds the newest one. Extracting advances current instead of copying the content into
+    /// a separate previous buffer. Also remembers what the content and applied uniform values were derived from.
+    /// </summary>
+    struct GroupConstants {
+        std::vector<std::vector<uint8_t>> slots;
+        uint32_t current = 0;
+        uint32_t settledSlots = 0; // newest slots holding the same content, the ring stops moving once all of them do
+        size_t size = 0;
+        uint64_t resource = 0;
+        uint64_t version = HOST_BUFFER_VERSION_UNKNOWN; // stays unknown until something was extracted
+        uint32_t varMappingVersion = UINT32_MAX;
+        uint32_t restVariablesVersion = UINT32_MAX;
+        uint32_t historyMappingVersion = UINT32_MAX;
+        std::vector<CompiledBinding> bindings; // compiled for varMappingVersion and restVariablesVersion
+
+        void Reset(size_t newSize, uint32_t depth);
+        uint32_t Next() const { return (current + 1) % static_cast<uint32_t>(slots.size()); }
+        const uint8_t* Get(uint32_t framesBack) const;
+    };
+
+    std::unordered_map<const ShaderToggler::ToggleGroup*, GroupConstants> groupConstants;
     int32_t previousEnableCount = std::numeric_limits<int32_t>::max();
-    std::shared_mutex varMutex;
     static std::shared_mutex groupBufferMutex;
+    // Guards restVariables and restVariablesVersion, compiled bindings point into the former
+    static std::shared_mutex varMutex;
 
     static std::unordered_map<std::string, std::tuple<constant_type, std::vector<reshade::api::effect_uniform_variable>>> restVariables;
+    static uint32_t restVariablesVersion;
     static char charBuffer[CHAR_BUFFER_SIZE];
 
     static ConstantCopyBase* _constCopy;
 
-    void InitBuffers(const ShaderToggler::ToggleGroup* group, size_t size);
+    GroupConstants& InitBuffers(const ShaderToggler::ToggleGroup* group, size_t size);
+    bool CompileBindings(const ShaderToggler::ToggleGroup* group);
+    bool SettleHistory(GroupConstants& constants);
     bool UpdateConstantEntries(reshade::api::command_list* cmd_list,
                                CommandListDataContainer& cmdData,
                                DeviceDataContainer& devData,
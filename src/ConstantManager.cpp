@@ -61,7 +61,7 @@ bool ConstantManager::Init(AddonImGui::AddonUIData& data,
             *constantCopy = &constantTypeNierReplicant;
         } break;
         case ConstantCopyType::Copy_GPUReadback: {
-            static ConstantCopyGPUReadback constantTypeGPUReadback(gResourceManager);
+            static ConstantCopyGPUReadback constantTypeGPUReadback(gResourceManager, data.GetConstReadbackLatency());
             *constantCopy = &constantTypeGPUReadback;
         } break;
         default:
@@ -9,42 +9,125 @@
 
 using namespace reshade::api;
 
-sampler descriptor_tracking::get_sampler(descriptor_heap heap, uint32_t offset) const {
-    const descriptor_heap_data& heap_data = heaps.at(heap);
+descriptor_tracking::descriptor_heap_data::~descriptor_heap_data() {
+    for (auto& chunk : chunks) {
+        delete[] chunk.load(std::memory_order_relaxed);
+    }
+}
 
-    if (offset < heap_data.descriptors.size()) {
-        const descriptor_data& descriptor = heap_data.descriptors[offset];
+const descriptor_tracking::descriptor_data* descriptor_tracking::descriptor_heap_data::find(uint32_t offset) const {
+    const uint32_t chunk_index = offset / CHUNK_DESCRIPTORS;
 
-        if (descriptor.type == descriptor_type::sampler)
-            return descriptor.sampler;
-        else if (descriptor.type == descriptor_type::sampler_with_resource_view)
-            return descriptor.sampler_and_view.sampler;
+    if (chunk_index >= MAX_CHUNKS) {
+        return nullptr;
     }
 
-    return { 0 };
+    const descriptor_data* chunk = chunks[chunk_index].load(std::memory_order_acquire);
+
+    return chunk != nullptr ? &chunk[offset % CHUNK_DESCRIPTORS] : nullptr;
 }
-resource_view descriptor_tracking::get_shader_resource_view(descriptor_heap heap, uint32_t offset) const {
-    const descriptor_heap_data& heap_data = heaps.at(heap);
 
-    if (offset < heap_data.descriptors.size()) {
-        const descriptor_data& descriptor = heap_data.descriptors[offset];
+const descriptor_tracking::descriptor_data* descriptor_tracking::descriptor_heap_data::find_run(uint32_t offset, uint32_t& count) const {
+    const uint32_t chunk_offset = offset % CHUNK_DESCRIPTORS;
+
+    count = std::min(count, CHUNK_DESCRIPTORS - chunk_offset);
+
+    return find(offset);
+}
+
+descriptor_tracking::descriptor_data* descriptor_tracking::descriptor_heap_data::create_chunk(uint32_t chunk_index) {
+    descriptor_data* chunk = nullptr;
+    descriptor_data* created = new descriptor_data[CHUNK_DESCRIPTORS]();
+
+    if (chunks[chunk_index].compare_exchange_strong(chunk, created, std::memory_order_acq_rel)) {
+        return created;
+    }
+
+    // Another thread was first
+    delete[] created;
+    return chunk;
+}
+
+descriptor_tracking::descriptor_data* descriptor_tracking::descriptor_heap_data::get_or_create_run(uint32_t offset, uint32_t& count) {
+    const uint32_t chunk_index = offset / CHUNK_DESCRIPTORS;
+    const uint32_t chunk_offset = offset % CHUNK_DESCRIPTORS;
+
+    if (chunk_index >= MAX_CHUNKS) {
+        return nullptr;
+    }
+
+    descriptor_data* chunk = chunks[chunk_index].load(std::memory_order_acquire);
 
-        if (descriptor.type == descriptor_type::shader_resource_view)
-            return descriptor.view;
-        else if (descriptor.type == descriptor_type::sampler_with_resource_view)
-            return descriptor.sampler_and_view.view;
+    if (chunk == nullptr) {
+        chunk = create_chunk(chunk_index);
+    }
+
+    count = std::min(count, CHUNK_DESCRIPTORS - chunk_offset);
+
+    return chunk + chunk_offset;
+}
+
+const descriptor_tracking::descriptor_heap_data* descriptor_tracking::find_heap(descriptor_heap heap) const {
+    descriptor_heap_data* heap_data = nullptr;
+    heaps.find(heap.handle, heap_data);
+
+    return heap_data;
+}
+
+descriptor_tracking::descriptor_heap_data* descriptor_tracking::get_or_create_heap(descriptor_heap heap) {
+    descriptor_heap_data* heap_data = nullptr;
+
+    if (heaps.find(heap.handle, heap_data) || heap.handle == 0) {
+        return heap_data;
+    }
+
+    std::unique_lock<std::mutex> lock(heaps_mutex);
+
+    // Another thread may have been first
+    if (heaps.find(heap.handle, heap_data)) {
+        return heap_data;
+    }
+
+    heap_storage.push_back(std::make_unique<descriptor_heap_data>());
+    heap_data = heap_storage.back().get();
+    heaps.insert_or_assign(heap.handle, heap_data);
+
+    return heap_data;
+}
+
+sampler descriptor_tracking::get_sampler(descriptor_heap heap, uint32_t offset) const {
+    const descriptor_heap_data* heap_data = find_heap(heap);
+    const descriptor_data* descriptor = heap_data != nullptr ? heap_data->find(offset) : nullptr;
+
+    if (descriptor != nullptr) {
+        if (descriptor->type == descriptor_type::sampler)
+            return descriptor->sampler;
+        else if (descriptor->type == descriptor_type::sampler_with_resource_view)
+            return descriptor->sampler_and_view.sampler;
     }
 
     return { 0 };
 }
-buffer_range descriptor_tracking::get_buffer_range(descriptor_heap heap, uint32_t offset) const {
-    const descriptor_heap_data& heap_data = heaps.at(heap);
+resource_view descriptor_tracking::get_shader_resource_view(descriptor_heap heap, uint32_t offset) const {
+    const descriptor_heap_data* heap_data = find_heap(heap);
+    const descriptor_data* descriptor = heap_data != nullptr ? heap_data->find(offset) : nullptr;
+
+    if (descriptor != nullptr) {
+        if (descriptor->type == descriptor_type::shader_resource_view)
+            return descriptor->view;
+        else if (descriptor->type == descriptor_type::sampler_with_resource_view)
+            return descriptor->sampler_and_view.view;
+    }
 
-    if (offset < heap_data.descriptors.size()) {
-        const descriptor_data& descriptor = heap_data.descriptors[offset];
+    return { 0 };
+}
+buffer_range descriptor_tracking::get_buffer_range(descriptor_heap heap, uint32_t offset) const {
+    const descriptor_heap_data* heap_data = find_heap(heap);
+    const descriptor_data* descriptor = heap_data != nullptr ? heap_data->find(offset) : nullptr;
 
-        if (descriptor.type == descriptor_type::constant_buffer)
-            return descriptor.constant;
+    if (descriptor != nullptr) {
+        if (descriptor->type == descriptor_type::constant_buffer)
+            return descriptor->constant;
     }
 
     return { 0 };
@@ -53,39 +136,71 @@ buffer_range descriptor_tracking::get_buffer_range(descriptor_heap heap, uint32_
 void descriptor_tracking::set_all_descriptors(reshade::api::descriptor_heap heap,
                                               uint32_t offset,
                                               uint32_t count,
-                                              std::vector<descriptor_tracking::descriptor_data>& descriptor_list,
+                                              descriptor_tracking::descriptor_data* descriptor_list,
                                               uint32_t list_offset) const {
-    const descriptor_heap_data& heap_data = heaps.at(heap);
+    const descriptor_heap_data* heap_data = find_heap(heap);
 
-    size_t mcount = std::min(static_cast<size_t>(offset) + count, heap_data.descriptors.size());
+    if (heap_data == nullptr) {
+        return;
+    }
+
+    // Entries of chunks that were never written are left as they are
+    for (uint32_t i = 0; i < count;) {
+        uint32_t run_count = count - i;
+        const descriptor_data* run = heap_data->find_run(offset + i, run_count);
 
-    for (uint32_t i = offset; i < mcount; i++) {
-        descriptor_list[list_offset + i - offset] = heap_data.descriptors[i];
+        if (run != nullptr) {
+            std::copy_n(run, run_count, descriptor_list + list_offset + i);
+        }
+
+        i += run_count;
     }
 }
 
 pipeline_layout_param descriptor_tracking::get_pipeline_layout_param(pipeline_layout layout, uint32_t param) const {
-    const pipeline_layout_data& layout_data = layouts.at(layout);
+    pipeline_layout_data* layout_data = nullptr;
 
-    return layout_data.params[param];
+    if (!layouts.find(layout.handle, layout_data) || param >= layout_data->params.size()) {
+        return {};
+    }
+
+    return layout_data->params[param];
 }
 
 void descriptor_tracking::register_pipeline_layout(pipeline_layout layout, uint32_t count, const pipeline_layout_param* params) {
-    pipeline_layout_data& layout_data = layouts[layout];
-    layout_data.params.assign(params, params + count);
-    layout_data.ranges.resize(count);
+    std::unique_ptr<pipeline_layout_data> layout_data = std::make_unique<pipeline_layout_data>();
+    layout_data->params.assign(params, params + count);
+    layout_data->ranges.resize(count);
 
     for (uint32_t i = 0; i < count; ++i) {
         if (params[i].type == pipeline_layout_param_type::descriptor_table) {
-            layout_data.ranges[i].assign(params[i].descriptor_table.ranges, params[i].descriptor_table.ranges + params[i].descriptor_table.count);
-            layout_data.params[i].descriptor_table.ranges = layout_data.ranges[i].data();
+            layout_data->ranges[i].assign(params[i].descriptor_table.ranges, params[i].descriptor_table.ranges + params[i].descriptor_table.count);
+            layout_data->params[i].descriptor_table.ranges = layout_data->ranges[i].data();
         }
     }
+
+    std::unique_lock<std::mutex> lock(layouts_mutex);
+
+    layouts.insert_or_assign(layout.handle, layout_data.get());
+
+    // Handles can be reused, readers might still be looking at the data previously stored for it
+    std::unique_ptr<pipeline_layout_data>& owner = layout_storage[layout.handle];
+    if (owner != nullptr) {
+        layouts.retire(std::shared_ptr<pipeline_layout_data>(std::move(owner)));
+    }
+    owner = std::move(layout_data);
 }
 void descriptor_tracking::unregister_pipeline_layout(pipeline_layout layout) {
-    pipeline_layout_data& layout_data = layouts[layout];
-    layout_data.params.clear();
-    layout_data.ranges.clear();
+    std::unique_lock<std::mutex> lock(layouts_mutex);
+
+    const auto& it = layout_storage.find(layout.handle);
+    if (it == layout_storage.end()) {
+        return;
+    }
+
+    layouts.erase(layout.handle);
+    layouts.retire(std::shared_ptr<pipeline_layout_data>(std::move(it->second)));
+    layout_storage.erase(it);
 }
 
 static void on_init_device(device* device) {
@@ -95,6 +210,13 @@ static void on_destroy_device(device* device) {
     device->destroy_private_data<descriptor_tracking>();
 }
 
+void descriptor_tracking::on_reshade_present(effect_runtime* runtime) {
+    descriptor_tracking& ctx = runtime->get_device()->get_private_data<descriptor_tracking>();
+
+    std::unique_lock<std::mutex> lock(ctx.layouts_mutex);
+    ctx.layouts.reclaim();
+}
+
 void descriptor_tracking::on_init_pipeline_layout(device* device, uint32_t count, const pipeline_layout_param* params, pipeline_layout layout) {
     descriptor_tracking& ctx = device->get_private_data<descriptor_tracking>();
     ctx.register_pipeline_layout(layout, count, params);
@@ -104,9 +226,7 @@ void descriptor_tracking::on_destroy_pipeline_layout(device* device, pipeline_la
     ctx.unregister_pipeline_layout(layout);
 }
 
-bool descriptor_tracking::on_copy_descriptor_tables(device* device, uint32_t count, const descriptor_table_copy* copies) {
-    descriptor_tracking& ctx = device->get_private_data<descriptor_tracking>();
-
+void descriptor_tracking::copy_descriptors(device* device, uint32_t count, const descriptor_table_copy* copies) {
     for (uint32_t i = 0; i < count; ++i) {
         const descriptor_table_copy& copy = copies[i];
 
@@ -118,23 +238,84 @@ bool descriptor_tracking::on_copy_descriptor_tables(device* device, uint32_t cou
         descriptor_heap dst_heap;
         device->get_descriptor_heap_offset(copy.dest_table, copy.dest_binding, copy.dest_array_offset, &dst_heap, &dst_offset);
 
-        descriptor_heap_data& src_pool_data = ctx.heaps[src_heap];
-        descriptor_heap_data& dst_pool_data = ctx.heaps[dst_heap];
+        const descriptor_heap_data* src_pool_data = find_heap(src_heap);
+        descriptor_heap_data* dst_pool_data = get_or_create_heap(dst_heap);
+
+        if (dst_pool_data == nullptr) {
+            continue;
+        }
+
+        // Whole runs within a chunk are moved at once, a copy only spans several runs if it crosses a chunk boundary
+        for (uint32_t k = 0; k < copy.count;) {
+            uint32_t run_count = copy.count - k;
+            descriptor_data* run = dst_pool_data->get_or_create_run(dst_offset + k, run_count);
 
-        if (dst_offset + copy.count > dst_pool_data.descriptors.size())
-            dst_pool_data.descriptors.grow_to_at_least(dst_offset + copy.count);
+            if (run == nullptr) {
+                break;
+            }
 
-        for (uint32_t k = 0; k < copy.count; ++k) {
-            dst_pool_data.descriptors[dst_offset + k] = src_pool_data.descriptors[src_offset + k];
+            // Runs end at whichever chunk boundary comes first, the source's or the destination's
+            const descriptor_data* source = src_pool_data != nullptr ? src_pool_data->find_run(src_offset + k, run_count) : nullptr;
+
+            if (source != nullptr) {
+                std::copy_n(source, run_count, run);
+            } else {
+                std::fill_n(run, run_count, descriptor_data{});
+            }
+
+            k += run_count;
         }
     }
-
-    return false;
 }
 
-bool descriptor_tracking::on_update_descriptor_tables(device* device, uint32_t count, const descriptor_table_update* updates) {
-    descriptor_tracking& ctx = device->get_private_data<descriptor_tracking>();
+static void write_descriptors(descriptor_tracking::descriptor_data* run, descriptor_type type, const void* descriptors, uint32_t first, uint32_t count) {
+    // Switch once per run rather than per descriptor
+    switch (type) {
+        case descriptor_type::sampler: {
+            const sampler* source = static_cast<const sampler*>(descriptors) + first;
+            for (uint32_t k = 0; k < count; ++k) {
+                run[k].type = type;
+                run[k].sampler = source[k];
+            }
+            break;
+        }
+        case descriptor_type::sampler_with_resource_view: {
+            const sampler_with_resource_view* source = static_cast<const sampler_with_resource_view*>(descriptors) + first;
+            for (uint32_t k = 0; k < count; ++k) {
+                run[k].type = type;
+                run[k].sampler_and_view = source[k];
+                run[k].view = source[k].view;
+                run[k].sampler = source[k].sampler;
+            }
+            break;
+        }
+        case descriptor_type::shader_resource_view:
+        case descriptor_type::unordered_access_view: {
+            const resource_view* source = static_cast<const resource_view*>(descriptors) + first;
+            for (uint32_t k = 0; k < count; ++k) {
+                run[k].type = type;
+                run[k].view = source[k];
+            }
+            break;
+        }
+        case descriptor_type::constant_buffer:
+        case descriptor_type::shader_storage_buffer: {
+            const buffer_range* source = static_cast<const buffer_range*>(descriptors) + first;
+            for (uint32_t k = 0; k < count; ++k) {
+                run[k].type = type;
+                run[k].constant = source[k];
+            }
+            break;
+        }
+        default:
+            for (uint32_t k = 0; k < count; ++k) {
+                run[k].type = type;
+            }
+            break;
+    }
+}
 
+void descriptor_tracking::update_descriptors(device* device, uint32_t count, const descriptor_table_update* updates) {
     for (uint32_t i = 0; i < count; ++i) {
         const descriptor_table_update& update = updates[i];
 
@@ -142,36 +323,32 @@ bool descriptor_tracking::on_update_descriptor_tables(device* device, uint32_t c
         descriptor_heap heap;
         device->get_descriptor_heap_offset(update.table, update.binding, update.array_offset, &heap, &offset);
 
-        descriptor_heap_data& heap_data = ctx.heaps[heap];
-
-        if (offset + update.count > heap_data.descriptors.size())
-            heap_data.descriptors.grow_to_at_least(offset + update.count);
-
-        for (uint32_t k = 0; k < update.count; ++k) {
-            descriptor_data& descriptor = heap_data.descriptors[offset + k];
-
-            descriptor.type = update.type;
-
-            switch (update.type) {
-                case descriptor_type::sampler:
-                    descriptor.sampler = static_cast<const sampler*>(update.descriptors)[k];
-                    break;
-                case descriptor_type::sampler_with_resource_view:
-                    descriptor.sampler_and_view = static_cast<const sampler_with_resource_view*>(update.descriptors)[k];
-                    descriptor.view = descriptor.sampler_and_view.view;
-                    descriptor.sampler = descriptor.sampler_and_view.sampler;
-                    break;
-                case descriptor_type::shader_resource_view:
-                case descriptor_type::unordered_access_view:
-                    descriptor.view = static_cast<const resource_view*>(update.descriptors)[k];
-                    break;
-                case descriptor_type::constant_buffer:
-                case descriptor_type::shader_storage_buffer:
-                    descriptor.constant = static_cast<const buffer_range*>(update.descriptors)[k];
+        descriptor_heap_data* heap_data = get_or_create_heap(heap);
+
+        if (heap_data == nullptr) {
+            continue;
+        }
+
+        for (uint32_t k = 0; k < update.count;) {
+            uint32_t run_count = update.count - k;
+            descriptor_data* run = heap_data->get_or_create_run(offset + k, run_count);
+
+            if (run == nullptr) {
+                break;
             }
+
+            write_descriptors(run, update.type, update.descriptors, k, run_count);
+            k += run_count;
         }
     }
+}
 
+bool descriptor_tracking::on_copy_descriptor_tables(device* device, uint32_t count, const descriptor_table_copy* copies) {
+    device->get_private_data<descriptor_tracking>().copy_descriptors(device, count, copies);
+    return false;
+}
+bool descriptor_tracking::on_update_descriptor_tables(device* device, uint32_t count, const descriptor_table_update* updates) {
+    device->get_private_data<descriptor_tracking>().update_descriptors(device, count, updates);
     return false;
 }
 
@@ -180,6 +357,7 @@ void descriptor_tracking::register_events(bool track_descriptors) {
     reshade::register_event<reshade::addon_event::destroy_device>(on_destroy_device);
     reshade::register_event<reshade::addon_event::init_pipeline_layout>(on_init_pipeline_layout);
     reshade::register_event<reshade::addon_event::destroy_pipeline_layout>(on_destroy_pipeline_layout);
+    reshade::register_event<reshade::addon_event::reshade_present>(on_reshade_present);
 
     if (track_descriptors) {
         reshade::register_event<reshade::addon_event::copy_descriptor_tables>(on_copy_descriptor_tables);
@@ -191,6 +369,7 @@ void descriptor_tracking::unregister_events(bool track_descriptors) {
     reshade::unregister_event<reshade::addon_event::destroy_device>(on_destroy_device);
     reshade::unregister_event<reshade::addon_event::init_pipeline_layout>(on_init_pipeline_layout);
     reshade::unregister_event<reshade::addon_event::destroy_pipeline_layout>(on_destroy_pipeline_layout);
+    reshade::unregister_event<reshade::addon_event::reshade_present>(on_reshade_present);
 
     if (track_descriptors) {
         reshade::unregister_event<reshade::addon_event::copy_descriptor_tables>(on_copy_descriptor_tables);
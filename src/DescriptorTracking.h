@@ -5,9 +5,12 @@
 
 #pragma once
 
+#include "ConcurrentHandleMap.h"
 #include "reshade.hpp"
-#include <concurrent_unordered_map.h>
-#include <concurrent_vector.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 /// <summary>
@@ -59,18 +62,30 @@ class __declspec(uuid("33319e83-387c-448e-881c-7e68fc2e52c4")) descriptor_tracki
     void set_all_descriptors(reshade::api::descriptor_heap heap,
                              uint32_t offset,
                              uint32_t count,
-                             std::vector<descriptor_tracking::descriptor_data>& descriptor_list,
+                             descriptor_tracking::descriptor_data* descriptor_list,
                              uint32_t list_offset) const;
 
+    /// <summary>
+    /// Mirrors descriptor table copies into the tracked heaps. Called by the copy_descriptor_tables handler.
+    /// </summary>
+    void copy_descriptors(reshade::api::device* device, uint32_t count, const reshade::api::descriptor_table_copy* copies);
+    /// <summary>
+    /// Mirrors descriptor table updates into the tracked heaps. Called by the update_descriptor_tables handler.
+    /// </summary>
+    void update_descriptors(reshade::api::device* device, uint32_t count, const reshade::api::descriptor_table_update* updates);
+
     /// <summary>
     /// Gets the description that was used to create the specified pipeline layout parameter.
     /// </summary>
     reshade::api::pipeline_layout_param get_pipeline_layout_param(reshade::api::pipeline_layout layout, uint32_t param) const;
-
-  private:
+    /// <summary>
+    /// Keeps a copy of the params of a pipeline layout. Called by the init_pipeline_layout and destroy_pipeline_layout handlers.
+    /// </summary>
     void register_pipeline_layout(reshade::api::pipeline_layout layout, uint32_t count, const reshade::api::pipeline_layout_param* params);
     void unregister_pipeline_layout(reshade::api::pipeline_layout layout);
 
+  private:
+
     static void on_init_pipeline_layout(reshade::api::device* device,
                                         uint32_t count,
                                         const reshade::api::pipeline_layout_param* params,
@@ -80,26 +95,57 @@ class __declspec(uuid("33319e83-387c-448e-881c-7e68fc2e52c4")) descriptor_tracki
     static bool on_copy_descriptor_tables(reshade::api::device* device, uint32_t count, const reshade::api::descriptor_table_copy* copies);
     static bool on_update_descriptor_tables(reshade::api::device* device, uint32_t count, const reshade::api::descriptor_table_update* updates);
 
+    static void on_reshade_present(reshade::api::effect_runtime* runtime);
+
+    /// <summary>
+    /// Mirror of a descriptor heap, indexed directly by heap offset. Descriptors live in fixed size chunks which are allocated on first write
+    /// and never moved or freed before the heap data is destroyed, so readers need no locks and writers only ever touch their own slots.
+    /// </summary>
     struct descriptor_heap_data {
-        concurrency::concurrent_vector<descriptor_data> descriptors;
-    };
-    struct descriptor_heap_hash : std::hash<uint64_t> {
-        size_t operator()(reshade::api::descriptor_heap handle) const { return std::hash<uint64_t>::operator()(handle.handle); }
+        static constexpr uint32_t CHUNK_DESCRIPTORS = 4096;
+        static constexpr uint32_t MAX_CHUNKS = 1024;
+
+        descriptor_heap_data() = default;
+        descriptor_heap_data(const descriptor_heap_data&) = delete;
+        descriptor_heap_data& operator=(const descriptor_heap_data&) = delete;
+        ~descriptor_heap_data();
+
+        /// <summary>
+        /// Returns the descriptor at the offset, or nullptr if nothing was ever written to its chunk.
+        /// </summary>
+        const descriptor_data* find(uint32_t offset) const;
+        /// <summary>
+        /// Same as find, but also clamps count to the end of the chunk the offset is in. count is clamped even if nullptr is returned.
+        /// </summary>
+        const descriptor_data* find_run(uint32_t offset, uint32_t& count) const;
+        /// <summary>
+        /// Returns the contiguous run of descriptors starting at the offset, allocating its chunk if necessary. count is clamped to the end of
+        /// that chunk. Returns nullptr for offsets beyond the mirrored range.
+        /// </summary>
+        descriptor_data* get_or_create_run(uint32_t offset, uint32_t& count);
+        /// <summary>
+        /// Allocates the chunk at chunk_index, kept out of line so the lookups above stay small enough to inline.
+        /// </summary>
+        descriptor_data* create_chunk(uint32_t chunk_index);
+
+        std::atomic<descriptor_data*> chunks[MAX_CHUNKS] = {};
     };
 
     struct pipeline_layout_data {
         std::vector<reshade::api::pipeline_layout_param> params;
         std::vector<std::vector<reshade::api::descriptor_range>> ranges;
     };
-    struct pipeline_layout_hash : std::hash<uint64_t> {
-        size_t operator()(reshade::api::pipeline_layout handle) const { return std::hash<uint64_t>::operator()(handle.handle); }
-    };
 
-    struct pipeline_hash : std::hash<uint64_t> {
-        size_t operator()(reshade::api::pipeline handle) const { return std::hash<uint64_t>::operator()(handle.handle); }
-    };
+    const descriptor_heap_data* find_heap(reshade::api::descriptor_heap heap) const;
+    descriptor_heap_data* get_or_create_heap(reshade::api::descriptor_heap heap);
+
+    // Heaps are kept until the device is destroyed, handles are only ever added to the read side
+    ShaderToggler::ConcurrentHandleMap<descriptor_heap_data*> heaps;
+    std::mutex heaps_mutex;
+    std::vector<std::unique_ptr<descriptor_heap_data>> heap_storage;
 
-    concurrency::concurrent_unordered_map<reshade::api::descriptor_heap, descriptor_heap_data, descriptor_heap_hash> heaps;
-    concurrency::concurrent_unordered_map<reshade::api::pipeline_layout, pipeline_layout_data, pipeline_layout_hash> layouts;
-    concurrency::concurrent_unordered_map<reshade::api::pipeline, reshade::api::pipeline_layout, pipeline_hash> pipelines;
+    // Layouts replaced or destroyed are retired and freed a few presents later, readers may still hold on to them
+    ShaderToggler::ConcurrentHandleMap<pipeline_layout_data*> layouts;
+    std::mutex layouts_mutex;
+    std::unordered_map<uint64_t, std::unique_ptr<pipeline_layout_data>> layout_storage;
 };
@@ -1,16 +1,15 @@
 #pragma once
 #include "reshade.hpp"
+#include <atomic>
 #include <chrono>
 
 struct __declspec(novtable) EffectData final {
     constexpr EffectData()
-      : rendered(false)
-      , enabled_in_screenshot(true)
+      : enabled_in_screenshot(true)
       , technique({})
       , timeout(-1) {}
     constexpr EffectData(reshade::api::effect_technique tech)
-      : rendered(false)
-      , enabled_in_screenshot(true)
+      : enabled_in_screenshot(true)
       , technique(tech)
       , timeout(-1) {}
     constexpr EffectData(reshade::api::effect_technique tech, reshade::api::effect_runtime* runtime)
@@ -26,15 +25,35 @@ struct __declspec(novtable) EffectData final {
             timeout_start = std::chrono::steady_clock::now();
         }
 
-        rendered = false;
         technique = tech;
         enabled = active;
     }
 
-    mutable bool rendered = false;
+    /// <summary>
+    /// First-wins claim of the technique for the given frame epoch. Returns true for exactly one caller per epoch, which is the one that has to
+    /// render the technique. Epochs only move forward, a caller with an epoch older than the last claimed one gets false.
+    /// </summary>
+    bool Claim(uint64_t epoch) const {
+        std::atomic_ref<uint64_t> claimed(renderedEpoch);
+        uint64_t expected = claimed.load(std::memory_order_acquire);
+
+        while (expected < epoch) {
+            if (claimed.compare_exchange_weak(expected, epoch, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool IsRendered(uint64_t epoch) const { return std::atomic_ref<uint64_t>(renderedEpoch).load(std::memory_order_acquire) == epoch; }
+
+    // Epoch of the frame the technique was last claimed in, only accessed through Claim/IsRendered
+    alignas(std::atomic_ref<uint64_t>::required_alignment) mutable uint64_t renderedEpoch = 0;
     bool enabled_in_screenshot = true;
     bool enabled = false;
     reshade::api::effect_technique technique = {};
     int32_t timeout = -1;
+    uint32_t index = 0; // dense index, position in RuntimeDataContainer::allSortedTechniques
     std::chrono::steady_clock::time_point timeout_start;
 };
\ No newline at end of file
@@ -0,0 +1,465 @@
+#include "EventTrace.h"
+#include <cstddef>
+#include <cstring>
+#include <format>
+
+using namespace ShaderToggler;
+using namespace reshade::api;
+using namespace std;
+
+EventTraceRecorder& EventTraceRecorder::Instance() {
+    static EventTraceRecorder s_recorder;
+    return s_recorder;
+}
+
+static void onTraceInitPipeline(device* device, pipeline_layout, uint32_t, const pipeline_subobject*, pipeline pipelineHandle) {
+    EventTraceRecorder& recorder = EventTraceRecorder::Instance();
+
+    if (!recorder.IsCapturing()) {
+        return;
+    }
+
+    // The handler in Main.cpp runs first, so the dispatch record with the shader hashes exists already
+    AddonImGui::PipelineDispatchData data;
+    recorder.GetUIData()->GetPipelineDispatchData(pipelineHandle.handle, data);
+
+    TraceInitPipeline record{ pipelineHandle.handle, data.psHash, data.vsHash, data.csHash };
+    recorder.Append(TraceRecordType::INIT_PIPELINE, nullptr, &record, sizeof(record));
+}
+
+static void onTraceBindPipeline(command_list* cmd_list, pipeline_stage stages, pipeline pipelineHandle) {
+    EventTraceRecorder& recorder = EventTraceRecorder::Instance();
+
+    if (!recorder.IsCapturing()) {
+        return;
+    }
+
+    TraceBindPipeline record{ static_cast<uint32_t>(stages), pipelineHandle.handle };
+    recorder.Append(TraceRecordType::BIND_PIPELINE, cmd_list, &record, sizeof(record));
+}
+
+static void onTraceBindRenderTargetsAndDepthStencil(command_list* cmd_list, uint32_t count, const resource_view* rtvs, resource_view dsv) {
+    EventTraceRecorder& recorder = EventTraceRecorder::Instance();
+
+    if (!recorder.IsCapturing()) {
+        return;
+    }
+
+    TraceBindRenderTargets record{ count, dsv.handle };
+    recorder.Append(TraceRecordType::BIND_RENDER_TARGETS, cmd_list, &record, sizeof(record), rtvs, count * sizeof(resource_view));
+}
+
+static bool onTraceDraw(command_list* cmd_list, uint32_t vertex_count, uint32_t instance_count, uint32_t, uint32_t) {
+    EventTraceRecorder& recorder = EventTraceRecorder::Instance();
+
+    if (recorder.IsCapturing()) {
+        TraceDraw record{ vertex_count, instance_count };
+        recorder.Append(TraceRecordType::DRAW, cmd_list, &record, sizeof(record));
+    }
+
+    return false;
+}
+
+static bool onTraceDrawIndexed(command_list* cmd_list, uint32_t index_count, uint32_t instance_count, uint32_t, int32_t, uint32_t) {
+    EventTraceRecorder& recorder = EventTraceRecorder::Instance();
+
+    if (recorder.IsCapturing()) {
+        TraceDraw record{ index_count, instance_count };
+        recorder.Append(TraceRecordType::DRAW_INDEXED, cmd_list, &record, sizeof(record));
+    }
+
+    return false;
+}
+
+static bool onTraceDispatch(command_list* cmd_list, uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z) {
+    EventTraceRecorder& recorder = EventTraceRecorder::Instance();
+
+    if (recorder.IsCapturing()) {
+        TraceDispatch record{ group_count_x, group_count_y, group_count_z };
+        recorder.Append(TraceRecordType::DISPATCH, cmd_list, &record, sizeof(record));
+    }
+
+    return false;
+}
+
+static bool onTraceDrawOrDispatchIndirect(command_list* cmd_list, indirect_command type, resource buffer, uint64_t offset, uint32_t draw_count, uint32_t stride) {
+    EventTraceRecorder& recorder = EventTraceRecorder::Instance();
+
+    if (recorder.IsCapturing()) {
+        TraceDrawOrDispatchIndirect record{ static_cast<uint32_t>(type), buffer.handle, offset, draw_count, stride };
+        recorder.Append(TraceRecordType::DRAW_OR_DISPATCH_INDIRECT, cmd_list, &record, sizeof(record));
+    }
+
+    return false;
+}
+
+static void onTracePushDescriptors(command_list* cmd_list, shader_stage stages, pipeline_layout layout, uint32_t layout_param, const descriptor_table_update& update) {
+    EventTraceRecorder& recorder = EventTraceRecorder::Instance();
+
+    if (!recorder.IsCapturing()) {
+        return;
+    }
+
+    TracePushDescriptors record{
+        static_cast<uint32_t>(stages), layout.handle, layout_param, static_cast<uint32_t>(update.type), update.binding, update.array_offset, update.count
+    };
+    recorder.Append(TraceRecordType::PUSH_DESCRIPTORS, cmd_list, &record, sizeof(record), update.descriptors, update.count * TraceDescriptorSize(update.type));
+}
+
+static void onTracePushConstants(command_list* cmd_list,
+                                 shader_stage stages,
+                                 pipeline_layout layout,
+                                 uint32_t layout_param,
+                                 uint32_t first,
+                                 uint32_t count,
+                                 const void* values) {
+    EventTraceRecorder& recorder = EventTraceRecorder::Instance();
+
+    if (!recorder.IsCapturing()) {
+        return;
+    }
+
+    TracePushConstants record{ static_cast<uint32_t>(stages), layout.handle, layout_param, first, count };
+    recorder.Append(TraceRecordType::PUSH_CONSTANTS, cmd_list, &record, sizeof(record), values, count * sizeof(uint32_t));
+}
+
+static void onTraceBindDescriptorTables(command_list* cmd_list, shader_stage stages, pipeline_layout layout, uint32_t first, uint32_t count, const descriptor_table* tables) {
+    EventTraceRecorder& recorder = EventTraceRecorder::Instance();
+
+    if (!recorder.IsCapturing()) {
+        return;
+    }
+
+    TraceBindDescriptorTables record{ static_cast<uint32_t>(stages), layout.handle, first, count };
+    recorder.Append(TraceRecordType::BIND_DESCRIPTOR_TABLES, cmd_list, &record, sizeof(record), tables, count * sizeof(descriptor_table));
+}
+
+void EventTraceRecorder::RegisterEvents() {
+    if (_registered) {
+        return;
+    }
+
+    // Registered after the handlers in Main.cpp, see onTraceInitPipeline
+    reshade::register_event<reshade::addon_event::init_pipeline>(onTraceInitPipeline);
+    reshade::register_event<reshade::addon_event::bind_pipeline>(onTraceBindPipeline);
+    reshade::register_event<reshade::addon_event::bind_render_targets_and_depth_stencil>(onTraceBindRenderTargetsAndDepthStencil);
+    reshade::register_event<reshade::addon_event::draw>(onTraceDraw);
+    reshade::register_event<reshade::addon_event::draw_indexed>(onTraceDrawIndexed);
+    reshade::register_event<reshade::addon_event::dispatch>(onTraceDispatch);
+    reshade::register_event<reshade::addon_event::draw_or_dispatch_indirect>(onTraceDrawOrDispatchIndirect);
+    reshade::register_event<reshade::addon_event::push_descriptors>(onTracePushDescriptors);
+    reshade::register_event<reshade::addon_event::push_constants>(onTracePushConstants);
+    reshade::register_event<reshade::addon_event::bind_descriptor_tables>(onTraceBindDescriptorTables);
+
+    _registered = true;
+}
+
+void EventTraceRecorder::UnregisterEvents() {
+    Stop();
+
+    if (!_registered) {
+        return;
+    }
+
+    reshade::unregister_event<reshade::addon_event::init_pipeline>(onTraceInitPipeline);
+    reshade::unregister_event<reshade::addon_event::bind_pipeline>(onTraceBindPipeline);
+    reshade::unregister_event<reshade::addon_event::bind_render_targets_and_depth_stencil>(onTraceBindRenderTargetsAndDepthStencil);
+    reshade::unregister_event<reshade::addon_event::draw>(onTraceDraw);
+    reshade::unregister_event<reshade::addon_event::draw_indexed>(onTraceDrawIndexed);
+    reshade::unregister_event<reshade::addon_event::dispatch>(onTraceDispatch);
+    reshade::unregister_event<reshade::addon_event::draw_or_dispatch_indirect>(onTraceDrawOrDispatchIndirect);
+    reshade::unregister_event<reshade::addon_event::push_descriptors>(onTracePushDescriptors);
+    reshade::unregister_event<reshade::addon_event::push_constants>(onTracePushConstants);
+    reshade::unregister_event<reshade::addon_event::bind_descriptor_tables>(onTraceBindDescriptorTables);
+
+    _registered = false;
+}
+
+bool EventTraceRecorder::RequestCapture(const filesystem::path& path, uint32_t frames) {
+    if (frames == 0 || _capturing.load(memory_order_acquire) || _pending.load(memory_order_acquire)) {
+        return false;
+    }
+
+    unique_lock<mutex> lock(_bufferMutex);
+    _pendingPath = path;
+    _remainingFrames.store(frames, memory_order_release);
+    _pending.store(true, memory_order_release);
+
+    return true;
+}
+
+bool EventTraceRecorder::IsCapturing() const {
+    return _capturing.load(memory_order_acquire);
+}
+
+uint32_t EventTraceRecorder::GetRemainingFrames() const {
+    return _remainingFrames.load(memory_order_acquire);
+}
+
+AddonImGui::AddonUIData* EventTraceRecorder::GetUIData() const {
+    return _uiData;
+}
+
+void EventTraceRecorder::Append(TraceRecordType type, command_list* cmd_list, const void* data, uint32_t size, const void* extra, uint32_t extraSize) {
+    if (extra == nullptr) {
+        extraSize = 0;
+    }
+
+    TraceRecordHeader header{ type, {}, size + extraSize, reinterpret_cast<uint64_t>(cmd_list) };
+
+    unique_lock<mutex> lock(_bufferMutex);
+
+    const size_t offset = _buffer.size();
+    _buffer.resize(offset + sizeof(header) + size + extraSize);
+
+    memcpy(_buffer.data() + offset, &header, sizeof(header));
+    if (size > 0) {
+        memcpy(_buffer.data() + offset + sizeof(header), data, size);
+    }
+
+    if (extraSize > 0) {
+        memcpy(_buffer.data() + offset + sizeof(header) + size, extra, extraSize);
+    }
+}
+
+void EventTraceRecorder::Flush() {
+    unique_lock<mutex> lock(_bufferMutex);
+
+    if (_file.is_open() && !_buffer.empty()) {
+        _file.write(reinterpret_cast<const char*>(_buffer.data()), _buffer.size());
+    }
+
+    _buffer.clear();
+}
+
+void EventTraceRecorder::Stop() {
+    if (!_capturing.exchange(false, memory_order_acq_rel)) {
+        return;
+    }
+
+    Flush();
+
+    if (_file.is_open()) {
+        _file.seekp(offsetof(TraceFileHeader, frames));
+        _file.write(reinterpret_cast<const char*>(&_frames), sizeof(_frames));
+        _file.close();
+    }
+
+    _remainingFrames.store(0, memory_order_release);
+}
+
+void EventTraceRecorder::OnReshadePresent(effect_runtime* runtime, AddonImGui::AddonUIData& uiData) {
+    if (_capturing.load(memory_order_acquire)) {
+        Append(TraceRecordType::PRESENT, nullptr, nullptr, 0);
+        Flush();
+
+        _frames++;
+
+        if (_remainingFrames.fetch_sub(1, memory_order_acq_rel) <= 1 || !_file.good()) {
+            Stop();
+        }
+
+        return;
+    }
+
+    if (!_pending.exchange(false, memory_order_acq_rel)) {
+        return;
+    }
+
+    filesystem::path path;
+    {
+        unique_lock<mutex> lock(_bufferMutex);
+        path = _pendingPath;
+    }
+
+    _file.open(path, ios::out | ios::binary | ios::trunc);
+
+    if (!_file.is_open()) {
+        reshade::log::message(reshade::log::level::warning, std::format("Could not open event trace file \"{}\"", path.string()).c_str());
+        _remainingFrames.store(0, memory_order_release);
+        return;
+    }
+
+    TraceFileHeader header;
+    header.api = static_cast<uint32_t>(runtime->get_device()->get_api());
+    _file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    _uiData = &uiData;
+    _frames = 0;
+
+    {
+        // Handlers that passed the capture check right before the last capture stopped may have appended after its final flush
+        unique_lock<mutex> lock(_bufferMutex);
+        _buffer.clear();
+    }
+
+    _capturing.store(true, memory_order_release);
+
+    // Pipelines created before the capture are recorded upfront, so a trace is self contained. One created concurrently may show up twice.
+    uiData.ForEachPipelineDispatchData([this](uint64_t handle, const AddonImGui::PipelineDispatchData& data) {
+        TraceInitPipeline record{ handle, data.psHash, data.vsHash, data.csHash };
+        Append(TraceRecordType::INIT_PIPELINE, nullptr, &record, sizeof(record));
+    });
+}
+
+bool EventTraceReader::Open(const filesystem::path& path) {
+    _file.open(path, ios::in | ios::binary);
+    _truncated = false;
+
+    if (!_file.is_open()) {
+        return false;
+    }
+
+    _file.seekg(0, ios::end);
+    const streamoff fileSize = _file.tellg();
+    _file.seekg(0, ios::beg);
+
+    _file.read(reinterpret_cast<char*>(&_header), sizeof(_header));
+
+    if (_file.gcount() != sizeof(_header) || _header.magic != TRACE_MAGIC) {
+        return false;
+    }
+
+    _remaining = static_cast<uint64_t>(fileSize) - sizeof(_header);
+
+    return true;
+}
+
+const TraceFileHeader& EventTraceReader::GetHeader() const {
+    return _header;
+}
+
+bool EventTraceReader::IsTruncated() const {
+    return _truncated;
+}
+
+bool EventTraceReader::Next(TraceRecordHeader& header, vector<uint8_t>& payload) {
+    _file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+    if (_file.gcount() != sizeof(header)) {
+        _truncated = _file.gcount() > 0;
+        return false;
+    }
+
+    _remaining -= sizeof(header);
+
+    // The size comes straight from the file, anything past its end is a corrupt or truncated record and must not be allocated
+    if (header.size > _remaining) {
+        _truncated = true;
+        return false;
+    }
+
+    _remaining -= header.size;
+
+    payload.resize(header.size);
+    _file.read(reinterpret_cast<char*>(payload.data()), header.size);
+
+    if (static_cast<uint32_t>(_file.gcount()) != header.size) {
+        _truncated = true;
+        return false;
+    }
+
+    return true;
+}
+
+/// <summary>
+/// Expected payload size of a record, 0 for unknown types or payloads too short to hold their fixed part.
+/// </summary>
+template<typename T>
+static uint32_t TracePayloadSize(const vector<uint8_t>& payload, uint32_t (*extraSize)(const T&) = nullptr) {
+    if (payload.size() < sizeof(T)) {
+        return 0;
+    }
+
+    if (extraSize == nullptr) {
+        return sizeof(T);
+    }
+
+    T record;
+    memcpy(&record, payload.data(), sizeof(T));
+
+    return sizeof(T) + extraSize(record);
+}
+
+static uint32_t ExpectedPayloadSize(TraceRecordType type, const vector<uint8_t>& payload) {
+    switch (type) {
+        case TraceRecordType::INIT_PIPELINE:
+            return TracePayloadSize<TraceInitPipeline>(payload);
+        case TraceRecordType::BIND_PIPELINE:
+            return TracePayloadSize<TraceBindPipeline>(payload);
+        case TraceRecordType::BIND_RENDER_TARGETS:
+            return TracePayloadSize<TraceBindRenderTargets>(payload, [](const TraceBindRenderTargets& r) -> uint32_t {
+                return r.count * sizeof(resource_view);
+            });
+        case TraceRecordType::DRAW:
+        case TraceRecordType::DRAW_INDEXED:
+            return TracePayloadSize<TraceDraw>(payload);
+        case TraceRecordType::DISPATCH:
+            return TracePayloadSize<TraceDispatch>(payload);
+        case TraceRecordType::DRAW_OR_DISPATCH_INDIRECT:
+            return TracePayloadSize<TraceDrawOrDispatchIndirect>(payload);
+        case TraceRecordType::PUSH_DESCRIPTORS:
+            return TracePayloadSize<TracePushDescriptors>(payload, [](const TracePushDescriptors& r) -> uint32_t {
+                return r.count * TraceDescriptorSize(static_cast<descriptor_type>(r.type));
+            });
+        case TraceRecordType::PUSH_CONSTANTS:
+            return TracePayloadSize<TracePushConstants>(payload, [](const TracePushConstants& r) -> uint32_t { return r.count * sizeof(uint32_t); });
+        case TraceRecordType::BIND_DESCRIPTOR_TABLES:
+            return TracePayloadSize<TraceBindDescriptorTables>(payload, [](const TraceBindDescriptorTables& r) -> uint32_t {
+                return r.count * sizeof(descriptor_table);
+            });
+        default:
+            return 0;
+    }
+}
+
+string ShaderToggler::ValidateEventTrace(const filesystem::path& path, TraceSummary& summary) {
+    summary = TraceSummary{};
+
+    EventTraceReader reader;
+    if (!reader.Open(path)) {
+        return std::format("\"{}\" is not a trace file", path.string());
+    }
+
+    const TraceFileHeader& fileHeader = reader.GetHeader();
+    if (fileHeader.version != TRACE_VERSION) {
+        return std::format("Unsupported trace version {}", fileHeader.version);
+    }
+
+    summary.api = fileHeader.api;
+
+    TraceRecordHeader header;
+    vector<uint8_t> payload;
+    uint64_t index = 0;
+
+    for (; reader.Next(header, payload); index++) {
+        if (header.type > TraceRecordType::PRESENT) {
+            return std::format("Record {} has unknown type {}", index, static_cast<uint32_t>(header.type));
+        }
+
+        if (header.type == TraceRecordType::PRESENT) {
+            if (header.size != 0 || header.commandList != 0) {
+                return std::format("Present record {} carries a payload or command list", index);
+            }
+        } else if (ExpectedPayloadSize(header.type, payload) != header.size) {
+            return std::format("Record {} of type {} has a payload of {} bytes, expected {}",
+                               index,
+                               static_cast<uint32_t>(header.type),
+                               header.size,
+                               ExpectedPayloadSize(header.type, payload));
+        }
+
+        summary.records[static_cast<size_t>(header.type)]++;
+    }
+
+    if (reader.IsTruncated()) {
+        return std::format("Record {} is truncated or oversized", index);
+    }
+
+    summary.frames = static_cast<uint32_t>(summary.records[static_cast<size_t>(TraceRecordType::PRESENT)]);
+    if (summary.frames != fileHeader.frames) {
+        return std::format("Header claims {} frames, the trace holds {}", fileHeader.frames, summary.frames);
+    }
+
+    return {};
+}
@@ -0,0 +1,210 @@
+#pragma once
+
+#include "AddonUIData.h"
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <reshade.hpp>
+#include <string>
+#include <vector>
+
+namespace ShaderToggler {
+/// <summary>
+/// Binary trace of the events the addon reacts to. A trace starts with a TraceFileHeader and is followed by records, each made of a
+/// TraceRecordHeader and size bytes of payload. Variable length payloads append their elements directly after the fixed part.
+/// </summary>
+enum class TraceRecordType : uint8_t {
+    INIT_PIPELINE = 0,
+    BIND_PIPELINE,
+    BIND_RENDER_TARGETS,
+    DRAW,
+    DRAW_INDEXED,
+    DISPATCH,
+    DRAW_OR_DISPATCH_INDIRECT,
+    PUSH_DESCRIPTORS,
+    PUSH_CONSTANTS,
+    BIND_DESCRIPTOR_TABLES,
+    PRESENT
+};
+
+constexpr uint32_t TRACE_MAGIC = 0x52545453; // "STTR"
+constexpr uint32_t TRACE_VERSION = 1;
+
+#pragma pack(push, 1)
+struct TraceFileHeader {
+    uint32_t magic = TRACE_MAGIC;
+    uint32_t version = TRACE_VERSION;
+    uint32_t api = 0;    // reshade::api::device_api
+    uint32_t frames = 0; // amount of PRESENT records, written when the capture ends
+};
+
+struct TraceRecordHeader {
+    TraceRecordType type;
+    uint8_t reserved[3] = {};
+    uint32_t size = 0;         // payload size in bytes
+    uint64_t commandList = 0;  // command list pointer, 0 for device level events
+};
+
+struct TraceInitPipeline {
+    uint64_t pipeline;
+    uint32_t psHash;
+    uint32_t vsHash;
+    uint32_t csHash;
+};
+
+struct TraceBindPipeline {
+    uint32_t stages;
+    uint64_t pipeline;
+};
+
+// Followed by count render target view handles
+struct TraceBindRenderTargets {
+    uint32_t count;
+    uint64_t dsv;
+};
+
+// Vertex count for DRAW, index count for DRAW_INDEXED
+struct TraceDraw {
+    uint32_t count;
+    uint32_t instanceCount;
+};
+
+struct TraceDispatch {
+    uint32_t groupCountX;
+    uint32_t groupCountY;
+    uint32_t groupCountZ;
+};
+
+struct TraceDrawOrDispatchIndirect {
+    uint32_t type;
+    uint64_t buffer;
+    uint64_t offset;
+    uint32_t drawCount;
+    uint32_t stride;
+};
+
+// Followed by count descriptors of TraceDescriptorSize(type) bytes each
+struct TracePushDescriptors {
+    uint32_t stages;
+    uint64_t layout;
+    uint32_t layoutParam;
+    uint32_t type;
+    uint32_t binding;
+    uint32_t arrayOffset;
+    uint32_t count;
+};
+
+// Followed by count 32 bit values
+struct TracePushConstants {
+    uint32_t stages;
+    uint64_t layout;
+    uint32_t layoutParam;
+    uint32_t first;
+    uint32_t count;
+};
+
+// Followed by count descriptor table handles
+struct TraceBindDescriptorTables {
+    uint32_t stages;
+    uint64_t layout;
+    uint32_t first;
+    uint32_t count;
+};
+#pragma pack(pop)
+
+/// <summary>
+/// Size of a single descriptor of the passed in type as stored in a PUSH_DESCRIPTORS record.
+/// </summary>
+constexpr uint32_t TraceDescriptorSize(reshade::api::descriptor_type type) {
+    switch (type) {
+        case reshade::api::descriptor_type::sampler_with_resource_view:
+            return sizeof(reshade::api::sampler_with_resource_view);
+        case reshade::api::descriptor_type::constant_buffer:
+        case reshade::api::descriptor_type::shader_storage_buffer:
+            return sizeof(reshade::api::buffer_range);
+        default:
+            return sizeof(uint64_t);
+    }
+}
+
+/// <summary>
+/// Records the event stream of a number of frames into a binary trace file. The event handlers are registered once at load and return right away
+/// while no capture is running.
+/// </summary>
+class __declspec(novtable) EventTraceRecorder final {
+  public:
+    static EventTraceRecorder& Instance();
+
+    /// <summary>
+    /// Requests a capture of the given amount of frames into path. The capture starts at the next present. Returns false if one is already running.
+    /// </summary>
+    bool RequestCapture(const std::filesystem::path& path, uint32_t frames);
+    bool IsCapturing() const;
+    uint32_t GetRemainingFrames() const;
+    /// <summary>
+    /// Starts a requested capture, ends the current frame of a running one and stops it once all frames have been recorded.
+    /// </summary>
+    void OnReshadePresent(reshade::api::effect_runtime* runtime, AddonImGui::AddonUIData& uiData);
+    void Stop();
+    void RegisterEvents();
+    void UnregisterEvents();
+
+    void Append(TraceRecordType type, reshade::api::command_list* cmd_list, const void* data, uint32_t size, const void* extra = nullptr, uint32_t extraSize = 0);
+
+    AddonImGui::AddonUIData* GetUIData() const;
+
+  private:
+    void Flush();
+
+    std::atomic_bool _capturing = false;
+    std::atomic_bool _pending = false;
+    std::atomic_uint32_t _remainingFrames = 0;
+    bool _registered = false;
+    uint32_t _frames = 0;
+    std::filesystem::path _pendingPath;
+    AddonImGui::AddonUIData* _uiData = nullptr;
+
+    std::mutex _bufferMutex;
+    std::vector<uint8_t> _buffer;
+    std::ofstream _file;
+};
+
+/// <summary>
+/// Sequential reader for trace files written by EventTraceRecorder.
+/// </summary>
+class __declspec(novtable) EventTraceReader final {
+  public:
+    /// <summary>
+    /// Opens the trace at path and reads its file header. Returns false if the file can't be opened or doesn't start with a trace header.
+    /// </summary>
+    bool Open(const std::filesystem::path& path);
+    const TraceFileHeader& GetHeader() const;
+
+    /// <summary>
+    /// Reads the next record. Returns false at the end of the trace or if the record is truncated or claims more bytes than the file has left,
+    /// IsTruncated tells both apart.
+    /// </summary>
+    bool Next(TraceRecordHeader& header, std::vector<uint8_t>& payload);
+    bool IsTruncated() const;
+
+  private:
+    std::ifstream _file;
+    TraceFileHeader _header;
+    uint64_t _remaining = 0;
+    bool _truncated = false;
+};
+
+struct TraceSummary {
+    uint32_t api = 0;
+    uint32_t frames = 0;
+    uint64_t records[static_cast<size_t>(TraceRecordType::PRESENT) + 1] = {};
+};
+
+/// <summary>
+/// Reads the whole trace at path and checks the file header, the payload size of every record against its type and the frame count against
+/// the PRESENT records. Returns an empty string for a valid trace and a description of the first problem otherwise.
+/// </summary>
+std::string ValidateEventTrace(const std::filesystem::path& path, TraceSummary& summary);
+}
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace ShaderToggler {
+/// <summary>
+/// Vector with inline storage for N elements. It only touches the heap once more than N elements are stored, and keeps that storage across clear(),
+/// so queues which are filled and drained over and over again stop allocating after warming up. Erasing moves the last element into the gap,
+/// element order is therefore not preserved.
+/// </summary>
+template <typename T, size_t N>
+class InlineVector {
+    static_assert(std::is_trivially_copyable_v<T>, "InlineVector elements have to be trivially copyable");
+
+  public:
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    InlineVector() = default;
+    InlineVector(const InlineVector&) = delete;
+    InlineVector& operator=(const InlineVector&) = delete;
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + _size; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + _size; }
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    void clear() { _size = 0; }
+
+    void push_back(const T& value) {
+        if (_size == _capacity) {
+            grow();
+        }
+
+        data()[_size++] = value;
+    }
+
+    /// <summary>
+    /// Removes the element the iterator points at and returns an iterator to the element now occupying its place.
+    /// </summary>
+    iterator erase(iterator it) {
+        *it = data()[--_size];
+        return it;
+    }
+
+  private:
+    T* data() { return _heap != nullptr ? _heap.get() : _inline; }
+    const T* data() const { return _heap != nullptr ? _heap.get() : _inline; }
+
+    void grow() {
+        std::unique_ptr<T[]> storage = std::make_unique<T[]>(_capacity * 2);
+        std::copy(data(), data() + _size, storage.get());
+
+        _heap = std::move(storage);
+        _capacity *= 2;
+    }
+
+    T _inline[N] = {};
+    std::unique_ptr<T[]> _heap;
+    size_t _size = 0;
+    size_t _capacity = N;
+};
+
+template <typename K, typename V>
+struct InlineMapEntry {
+    K first;
+    V second;
+};
+
+/// <summary>
+/// Flat key/value map on top of InlineVector with linear lookup, meant for the handful of entries the per command list queues hold.
+/// </summary>
+template <typename K, typename V, size_t N>
+class InlineMap {
+  public:
+    using entry = InlineMapEntry<K, V>;
+    using iterator = entry*;
+    using const_iterator = const entry*;
+
+    iterator begin() { return _entries.begin(); }
+    iterator end() { return _entries.end(); }
+    const_iterator begin() const { return _entries.begin(); }
+    const_iterator end() const { return _entries.end(); }
+
+    size_t size() const { return _entries.size(); }
+    void clear() { _entries.clear(); }
+
+    iterator find(const K& key) {
+        return std::find_if(_entries.begin(), _entries.end(), [&key](const entry& e) { return e.first == key; });
+    }
+
+    const_iterator find(const K& key) const {
+        return std::find_if(_entries.begin(), _entries.end(), [&key](const entry& e) { return e.first == key; });
+    }
+
+    bool contains(const K& key) const { return find(key) != end(); }
+
+    /// <summary>
+    /// Adds the entry if the key isn't present yet. Returns false if it already was.
+    /// </summary>
+    bool emplace(const K& key, const V& value) {
+        if (contains(key)) {
+            return false;
+        }
+
+        _entries.push_back(entry{ key, value });
+        return true;
+    }
+
+    iterator erase(iterator it) { return _entries.erase(it); }
+
+    void erase(const K& key) {
+        iterator it = find(key);
+        if (it != end()) {
+            _entries.erase(it);
+        }
+    }
+
+  private:
+    InlineVector<entry, N> _entries;
+};
+
+/// <summary>
+/// Flat set on top of InlineVector with linear lookup.
+/// </summary>
+template <typename K, size_t N>
+class InlineSet {
+  public:
+    using iterator = K*;
+    using const_iterator = const K*;
+
+    iterator begin() { return _keys.begin(); }
+    iterator end() { return _keys.end(); }
+    const_iterator begin() const { return _keys.begin(); }
+    const_iterator end() const { return _keys.end(); }
+
+    size_t size() const { return _keys.size(); }
+    void clear() { _keys.clear(); }
+
+    bool contains(const K& key) const { return std::find(_keys.begin(), _keys.end(), key) != _keys.end(); }
+
+    bool insert(const K& key) {
+        if (contains(key)) {
+            return false;
+        }
+
+        _keys.push_back(key);
+        return true;
+    }
+
+    bool emplace(const K& key) { return insert(key); }
+
+    void erase(const K& key) {
+        iterator it = std::find(_keys.begin(), _keys.end(), key);
+        if (it != _keys.end()) {
+            _keys.erase(it);
+        }
+    }
+
+  private:
+    InlineVector<K, N> _keys;
+};
+
+/// <summary>
+/// Bitset indexed by the dense indices of groups and techniques, with inline storage for N bits. Grows on demand when a higher index is set
+/// and keeps its storage across clear(), which just zeroes the words.
+/// </summary>
+template <size_t N>
+class InlineBitset {
+    static constexpr size_t INLINE_WORDS = (N + 63) / 64;
+
+  public:
+    InlineBitset() = default;
+    InlineBitset(const InlineBitset&) = delete;
+    InlineBitset& operator=(const InlineBitset&) = delete;
+
+    bool test(size_t index) const {
+        const size_t word = index >> 6;
+        return word < _words && (data()[word] & (1ull << (index & 63))) != 0;
+    }
+
+    void set(size_t index) {
+        const size_t word = index >> 6;
+        if (word >= _words) {
+            grow(word + 1);
+        }
+
+        data()[word] |= 1ull << (index & 63);
+    }
+
+    void reset(size_t index) {
+        const size_t word = index >> 6;
+        if (word < _words) {
+            data()[word] &= ~(1ull << (index & 63));
+        }
+    }
+
+    void clear() { std::fill_n(data(), _words, 0ull); }
+
+    bool none() const { return std::all_of(data(), data() + _words, [](uint64_t word) { return word == 0; }); }
+
+    /// <summary>
+    /// Calls func(index) for every set bit in ascending order. Bits may be reset from within func.
+    /// </summary>
+    template <typename F>
+    void for_each(F&& func) const {
+        for (size_t i = 0; i < _words; i++) {
+            for (uint64_t bits = data()[i]; bits != 0; bits &= bits - 1) {
+                func(i * 64 + static_cast<size_t>(std::countr_zero(bits)));
+            }
+        }
+    }
+
+  private:
+    uint64_t* data() { return _heap != nullptr ? _heap.get() : _inline; }
+    const uint64_t* data() const { return _heap != nullptr ? _heap.get() : _inline; }
+
+    void grow(size_t words) {
+        const size_t capacity = std::max(words, _words * 2);
+        std::unique_ptr<uint64_t[]> storage = std::make_unique<uint64_t[]>(capacity);
+        std::copy(data(), data() + _words, storage.get());
+
+        _heap = std::move(storage);
+        _words = capacity;
+    }
+
+    uint64_t _inline[INLINE_WORDS] = {};
+    std::unique_ptr<uint64_t[]> _heap;
+    size_t _words = INLINE_WORDS;
+};
+}
@@ -32,7 +32,9 @@
 #include "AddonUIData.h"
 #include "AddonUIDisplay.h"
 #include "CDataFile.h"
+#include "CallbackProfiler.h"
 #include "ConstantManager.h"
+#include "EventTrace.h"
 #include "KeyMonitor.h"
 #include "PipelinePrivateData.h"
 #include "RenderingBindingManager.h"
@@ -94,11 +96,21 @@ static Rendering::RenderingEffectManager renderingEffectManager(g_addonUIData, r
 static Rendering::RenderingBindingManager renderingBindingManager(g_addonUIData, resourceManager, groupResourceManager);
 static Rendering::RenderingPreviewManager renderingPreviewManager(g_addonUIData, resourceManager, renderingShaderManager);
 static Rendering::RenderingQueueManager renderingQueueManager(g_addonUIData, resourceManager);
-static ShaderToggler::TechniqueManager techniqueManager(keyMonitor);
+static ShaderToggler::TechniqueManager techniqueManager(keyMonitor, g_addonUIData);
 
 // TODO: actually implement ability to turn off srgb-view generation
 static vector<effect_runtime*> runtimes;
 
+// The bind, draw and dispatch handlers stay registered and return right away while g_hotPathActive is cleared, see updateHotPathActive.
+// HOT_PATH_IDLE_FRAMES is the amount of presents without any consumer before they go idle, so toggling a group doesn't churn command list
+// state. g_hotPathEpoch counts the resumes, command lists compare it to drop what they tracked before the last idle gap.
+static constexpr uint32_t HOT_PATH_IDLE_FRAMES = 60;
+static atomic_bool g_hotPathActive = true;
+static atomic_uint64_t g_hotPathEpoch = 0;
+static uint32_t g_hotPathIdleFrames = 0;
+
+static void updateHotPathActive();
+
 /// <summary>
 /// Calculates a crc32 hash from the passed in shader bytecode. The hash is used to identity the shader in future runs.
 /// </summary>
@@ -125,6 +137,9 @@ static void onDestroyDevice(device* device) {
     resourceManager.OnDestroyDevice(device);
     renderingShaderManager.DestroyShaders(device);
 
+    if (constantCopy != nullptr)
+        constantCopy->OnDestroyDevice(device);
+
     device->destroy_private_data<DeviceDataContainer>();
 }
 
@@ -141,6 +156,23 @@ static void onResetCommandList(command_list* commandList) {
     commandListData.Reset();
 }
 
+/// <summary>
+/// Returns the command list data for the hot path handlers. The binds of a command list aren't tracked while the hot path is idle, so state
+/// recorded before the last resume is dropped the first time the command list shows up again. This also covers immediate contexts, which are
+/// never reset.
+/// </summary>
+static CommandListDataContainer& getHotPathData(command_list* commandList) {
+    CommandListDataContainer& commandListData = commandList->get_private_data<CommandListDataContainer>();
+    const uint64_t epoch = g_hotPathEpoch.load(memory_order_acquire);
+
+    if (commandListData.hotPathEpoch != epoch) {
+        commandListData.Reset();
+        commandListData.hotPathEpoch = epoch;
+    }
+
+    return commandListData;
+}
+
 static bool onCreateSwapchain(swapchain_desc& desc, void* hwnd) {
     return resourceManager.OnCreateSwapchain(desc, hwnd);
 }
@@ -184,15 +216,7 @@ static void onDestroyResourceView(device* device, resource_view view) {
 }
 
 static void onReshadeReloadedEffects(effect_runtime* runtime) {
-    RuntimeDataContainer& runtimeData = runtime->get_private_data<RuntimeDataContainer>();
-    DeviceDataContainer& deviceData = runtime->get_device()->get_private_data<DeviceDataContainer>();
-
     techniqueManager.OnReshadeReloadedEffects(runtime);
-
-    if (deviceData.current_runtime == runtime) {
-        shared_lock<shared_mutex> techLock(runtimeData.technique_mutex);
-        g_addonUIData.AssignPreferredGroupTechniques(runtimeData.allTechniques);
-    }
 }
 
 static bool onReshadeSetTechniqueState(effect_runtime* runtime, effect_technique technique, bool enabled) {
@@ -204,17 +228,7 @@ static bool onReshadeSetTechniqueState(effect_runtime* runtime, effect_technique
 }
 
 static bool onReshadeReorderTechniques(effect_runtime* runtime, size_t count, effect_technique* techniques) {
-    RuntimeDataContainer& runtimeData = runtime->get_private_data<RuntimeDataContainer>();
-    DeviceDataContainer& deviceData = runtime->get_device()->get_private_data<DeviceDataContainer>();
-
-    bool ret = techniqueManager.OnReshadeReorderTechniques(runtime, count, techniques);
-
-    if (deviceData.current_runtime == runtime) {
-        shared_lock<shared_mutex> techLock(runtimeData.technique_mutex);
-        g_addonUIData.AssignPreferredGroupTechniques(runtimeData.allTechniques);
-    }
-
-    return ret;
+    return techniqueManager.OnReshadeReorderTechniques(runtime, count, techniques);
 }
 
 static void onInitEffectRuntime(effect_runtime* runtime) {
@@ -258,6 +272,11 @@ static void onDestroyEffectRuntime(effect_runtime* runtime) {
             if (constantHandler != nullptr) {
                 constantHandler->ReloadConstantVariables(data.current_runtime);
             }
+
+            // Group schedules point into the techniques of the current runtime
+            RuntimeDataContainer& runtimeData = data.current_runtime->get_private_data<RuntimeDataContainer>();
+            unique_lock<shared_mutex> techLock(runtimeData.technique_mutex);
+            g_addonUIData.AssignPreferredGroupTechniques(runtimeData.allTechniques, runtimeData.allSortedTechniques);
         } else {
             data.current_runtime = nullptr;
 
@@ -271,47 +290,63 @@ static void onDestroyEffectRuntime(effect_runtime* runtime) {
 }
 
 static void onInitPipeline(device* device, pipeline_layout, uint32_t subobjectCount, const pipeline_subobject* subobjects, pipeline pipelineHandle) {
+    uint32_t psHash = 0;
+    uint32_t vsHash = 0;
+    uint32_t csHash = 0;
+
     // shader has been created, we will now create a hash and store it with the handle we got.
     for (uint32_t i = 0; i < subobjectCount; ++i) {
         switch (subobjects[i].type) {
             case pipeline_subobject_type::vertex_shader: {
-                g_vertexShaderManager.addHashHandlePair(calculateShaderHash(subobjects[i].data), pipelineHandle.handle);
+                vsHash = calculateShaderHash(subobjects[i].data);
+                g_vertexShaderManager.addHashHandlePair(vsHash, pipelineHandle.handle);
             } break;
             case pipeline_subobject_type::pixel_shader: {
-                g_pixelShaderManager.addHashHandlePair(calculateShaderHash(subobjects[i].data), pipelineHandle.handle);
+                psHash = calculateShaderHash(subobjects[i].data);
+                g_pixelShaderManager.addHashHandlePair(psHash, pipelineHandle.handle);
             } break;
             case pipeline_subobject_type::compute_shader: {
-                g_computeShaderManager.addHashHandlePair(calculateShaderHash(subobjects[i].data), pipelineHandle.handle);
+                csHash = calculateShaderHash(subobjects[i].data);
+                g_computeShaderManager.addHashHandlePair(csHash, pipelineHandle.handle);
             } break;
         }
     }
+
+    // Precompute everything bind_pipeline needs so a bind boils down to a single lookup
+    g_addonUIData.AddPipelineDispatchData(pipelineHandle.handle, psHash, vsHash, csHash);
 }
 
 static void onDestroyPipeline(device* device, pipeline pipelineHandle) {
     g_pixelShaderManager.removeHandle(pipelineHandle.handle);
     g_vertexShaderManager.removeHandle(pipelineHandle.handle);
     g_computeShaderManager.removeHandle(pipelineHandle.handle);
+    g_addonUIData.RemovePipelineDispatchData(pipelineHandle.handle);
 }
 
 static void onBindPipeline(command_list* commandList, pipeline_stage stages, pipeline pipelineHandle) {
-    if (nullptr == commandList || pipelineHandle.handle == 0 ||
+    PROFILE_CALLBACK(ShaderToggler::PROFILE_BIND_PIPELINE);
+
+    if (!g_hotPathActive.load(memory_order_relaxed) || nullptr == commandList || pipelineHandle.handle == 0 ||
         !((uint32_t)(stages & pipeline_stage::pixel_shader) || (uint32_t)(stages & pipeline_stage::vertex_shader) ||
           (uint32_t)(stages & pipeline_stage::compute_shader))) {
         return;
     }
 
-    const uint32_t handleHasPixelShaderAttached =
-      (uint32_t)(stages & pipeline_stage::pixel_shader) ? g_pixelShaderManager.safeGetShaderHash(pipelineHandle.handle) : 0;
-    const uint32_t handleHasVertexShaderAttached =
-      (uint32_t)(stages & pipeline_stage::vertex_shader) ? g_vertexShaderManager.safeGetShaderHash(pipelineHandle.handle) : 0;
-    const uint32_t handleHasComputeShaderAttached =
-      (uint32_t)(stages & pipeline_stage::compute_shader) ? g_computeShaderManager.safeGetShaderHash(pipelineHandle.handle) : 0;
+    PipelineDispatchData dispatchData;
+    if (!g_addonUIData.GetPipelineDispatchData(pipelineHandle.handle, dispatchData)) {
+        // draw call with unknown handle, don't collect it
+        return;
+    }
+
+    const uint32_t handleHasPixelShaderAttached = (uint32_t)(stages & pipeline_stage::pixel_shader) ? dispatchData.psHash : 0;
+    const uint32_t handleHasVertexShaderAttached = (uint32_t)(stages & pipeline_stage::vertex_shader) ? dispatchData.vsHash : 0;
+    const uint32_t handleHasComputeShaderAttached = (uint32_t)(stages & pipeline_stage::compute_shader) ? dispatchData.csHash : 0;
 
     if (!handleHasPixelShaderAttached && !handleHasVertexShaderAttached && !handleHasComputeShaderAttached) {
         // draw call with unknown handle, don't collect it
         return;
     }
-    CommandListDataContainer& commandListData = commandList->get_private_data<CommandListDataContainer>();
+    CommandListDataContainer& commandListData = getHotPathData(commandList);
     DeviceDataContainer& deviceData = commandList->get_device()->get_private_data<DeviceDataContainer>();
 
     if (deviceData.current_runtime == nullptr || !deviceData.current_runtime->get_effects_state()) {
@@ -323,42 +358,42 @@ static void onBindPipeline(command_list* commandList, pipeline_stage stages, pip
     if ((uint32_t)(stages & pipeline_stage::pixel_shader) && handleHasPixelShaderAttached) {
         if (g_activeCollectorFrameCounter > 0) {
             // in collection mode
-            g_pixelShaderManager.addActivePipelineHandle(pipelineHandle.handle);
+            g_pixelShaderManager.addActiveShaderHash(handleHasPixelShaderAttached);
         }
         if (commandListData.ps.activeShaderHash != handleHasPixelShaderAttached) {
             pipelineChanged |= Rendering::MATCH_EFFECT_PS | Rendering::MATCH_BINDING_PS | Rendering::MATCH_PREVIEW_PS | Rendering::MATCH_CONST_PS;
             commandListData.ps.constantBuffersToUpdate.clear();
         }
 
-        commandListData.ps.blockedShaderGroups = g_addonUIData.GetToggleGroupsForPixelShaderHash(handleHasPixelShaderAttached);
+        commandListData.ps.blockedShaderGroups = dispatchData.psGroups;
         commandListData.ps.activeShaderHash = handleHasPixelShaderAttached;
     }
 
     if ((uint32_t)(stages & pipeline_stage::vertex_shader) && handleHasVertexShaderAttached) {
         if (g_activeCollectorFrameCounter > 0) {
             // in collection mode
-            g_vertexShaderManager.addActivePipelineHandle(pipelineHandle.handle);
+            g_vertexShaderManager.addActiveShaderHash(handleHasVertexShaderAttached);
         }
         if (commandListData.vs.activeShaderHash != handleHasVertexShaderAttached) {
             pipelineChanged |= Rendering::MATCH_EFFECT_VS | Rendering::MATCH_BINDING_VS | Rendering::MATCH_PREVIEW_VS | Rendering::MATCH_CONST_VS;
             commandListData.vs.constantBuffersToUpdate.clear();
         }
 
-        commandListData.vs.blockedShaderGroups = g_addonUIData.GetToggleGroupsForVertexShaderHash(handleHasVertexShaderAttached);
+        commandListData.vs.blockedShaderGroups = dispatchData.vsGroups;
         commandListData.vs.activeShaderHash = handleHasVertexShaderAttached;
     }
 
     if ((uint32_t)(stages & pipeline_stage::compute_shader) && handleHasComputeShaderAttached) {
         if (g_activeCollectorFrameCounter > 0) {
             // in collection mode
-            g_computeShaderManager.addActivePipelineHandle(pipelineHandle.handle);
+            g_computeShaderManager.addActiveShaderHash(handleHasComputeShaderAttached);
         }
         if (commandListData.cs.activeShaderHash != handleHasComputeShaderAttached) {
             pipelineChanged |= Rendering::MATCH_EFFECT_CS | Rendering::MATCH_BINDING_CS | Rendering::MATCH_PREVIEW_CS | Rendering::MATCH_CONST_CS;
             commandListData.cs.constantBuffersToUpdate.clear();
         }
 
-        commandListData.cs.blockedShaderGroups = g_addonUIData.GetToggleGroupsForComputeShaderHash(handleHasComputeShaderAttached);
+        commandListData.cs.blockedShaderGroups = dispatchData.csGroups;
         commandListData.cs.activeShaderHash = handleHasComputeShaderAttached;
     }
 
@@ -385,12 +420,14 @@ static void onBindPipeline(command_list* commandList, pipeline_stage stages, pip
 }
 
 static void onBindRenderTargetsAndDepthStencil(command_list* cmd_list, uint32_t count, const resource_view* rtvs, resource_view dsv) {
-    if (cmd_list == nullptr || cmd_list->get_device() == nullptr) {
+    PROFILE_CALLBACK(ShaderToggler::PROFILE_BIND_RENDER_TARGETS);
+
+    if (!g_hotPathActive.load(memory_order_relaxed) || cmd_list == nullptr || cmd_list->get_device() == nullptr) {
         return;
     }
 
     device* device = cmd_list->get_device();
-    CommandListDataContainer& commandListData = cmd_list->get_private_data<CommandListDataContainer>();
+    CommandListDataContainer& commandListData = getHotPathData(cmd_list);
     DeviceDataContainer& deviceData = device->get_private_data<DeviceDataContainer>();
 
     // if (count > 0)
@@ -415,12 +452,14 @@ static void onBindRenderTargetsAndDepthStencil(command_list* cmd_list, uint32_t
 }
 
 static void onBeginRenderPass(command_list* cmd_list, uint32_t count, const render_pass_render_target_desc* rts, const render_pass_depth_stencil_desc* ds) {
-    if (cmd_list == nullptr || cmd_list->get_device() == nullptr) {
+    PROFILE_CALLBACK(ShaderToggler::PROFILE_BEGIN_RENDER_PASS);
+
+    if (!g_hotPathActive.load(memory_order_relaxed) || cmd_list == nullptr || cmd_list->get_device() == nullptr) {
         return;
     }
 
     device* device = cmd_list->get_device();
-    CommandListDataContainer& commandListData = cmd_list->get_private_data<CommandListDataContainer>();
+    CommandListDataContainer& commandListData = getHotPathData(cmd_list);
     DeviceDataContainer& deviceData = device->get_private_data<DeviceDataContainer>();
 
     if (!deviceData.current_runtime->get_effects_state()) {
@@ -465,7 +504,47 @@ static void onPresent(command_queue* queue,
         onResetCommandList(runtime->get_command_queue()->get_immediate_command_list());
 }
 
-static void onReshadePresent(effect_runtime* runtime) {
+/// <summary>
+/// Collects the shader stages and layout params the active groups read descriptors or push constants from, so state tracking can skip the
+/// rest. Readers clamp the configured slot to the bound params, which is why every param up to the configured one counts as read.
+/// </summary>
+static void updateTrackingInterest() {
+    static std::array<uint64_t, StateTracking::ALL_SHADER_STAGES_SIZE> s_interest = {};
+    static bool s_interestSet = false;
+
+    std::array<uint64_t, StateTracking::ALL_SHADER_STAGES_SIZE> interest = {};
+    const auto addInterest = [&interest](uint32_t stage, uint32_t slot) {
+        interest[std::min(stage, 2u)] |= slot >= 63 ? ~0ull : (2ull << slot) - 1;
+    };
+
+    for (const auto& [_, group] : g_addonUIData.GetToggleGroups()) {
+        if (!group.isActive()) {
+            continue;
+        }
+
+        if (group.getExtractConstants()) {
+            addInterest(group.getCBShaderStage(), group.getCBSlotIndex());
+        }
+
+        if (group.isProvidingTextureBinding() && group.getExtractResourceViews()) {
+            addInterest(group.getSRVShaderStage(), group.getBindingSRVSlotIndex());
+        }
+
+        if (group.getRenderToResourceViews()) {
+            addInterest(group.getRenderSRVShaderStage(), group.getRenderSRVSlotIndex());
+        }
+    }
+
+    if (!s_interestSet || interest != s_interest) {
+        state_tracking::set_tracking_interest(interest);
+        s_interest = interest;
+        s_interestSet = true;
+    }
+}
+
+static void processReshadePresent(effect_runtime* runtime) {
+    PROFILE_CALLBACK(ShaderToggler::PROFILE_RESHADE_PRESENT);
+
     device* dev = runtime->get_device();
     DeviceDataContainer& deviceData = dev->get_private_data<DeviceDataContainer>();
     command_queue* queue = runtime->get_command_queue();
@@ -487,24 +566,53 @@ static void onReshadePresent(effect_runtime* runtime) {
 
     techniqueManager.OnReshadePresent(runtime);
 
+    g_pixelShaderManager.reclaimRetiredHandles();
+    g_vertexShaderManager.reclaimRetiredHandles();
+    g_computeShaderManager.reclaimRetiredHandles();
+    g_addonUIData.ReclaimRetiredPipelineDispatchData();
+
+    if (constantCopy != nullptr) {
+        constantCopy->OnReshadePresent(runtime);
+    }
+
     deviceData.bindingsUpdated.clear();
     deviceData.constantsUpdated.clear();
     deviceData.huntPreview.Reset();
 
     CheckHotkeys(g_addonUIData, runtime);
+
+    updateHotPathActive();
+    updateTrackingInterest();
+
+    ShaderToggler::EventTraceRecorder::Instance().OnReshadePresent(runtime, g_addonUIData);
+}
+
+static void onReshadePresent(effect_runtime* runtime) {
+    processReshadePresent(runtime);
+
+#ifdef SHADERTOGGLER_PROFILE_CALLBACKS
+    // The present timer has been recorded by now, so its sample counts towards the frame it belongs to
+    ShaderToggler::CallbackProfiler::Instance().OnPresent();
+#endif
 }
 
 static void onMapBufferRegion(device* device, resource resource, uint64_t offset, uint64_t size, map_access access, void** data) {
+    PROFILE_CALLBACK(ShaderToggler::PROFILE_MAP_BUFFER_REGION);
+
     if (constantCopy != nullptr)
         constantCopy->OnMapBufferRegion(device, resource, offset, size, access, data);
 }
 
 static void onUnmapBufferRegion(device* device, resource resource) {
+    PROFILE_CALLBACK(ShaderToggler::PROFILE_UNMAP_BUFFER_REGION);
+
     if (constantCopy != nullptr)
         constantCopy->OnUnmapBufferRegion(device, resource);
 }
 
 static bool onUpdateBufferRegion(device* device, const void* data, resource resource, uint64_t offset, uint64_t size) {
+    PROFILE_CALLBACK(ShaderToggler::PROFILE_UPDATE_BUFFER_REGION);
+
     if (constantCopy != nullptr)
         constantCopy->OnUpdateBufferRegion(device, data, resource, offset, size);
 
@@ -533,7 +641,11 @@ static void UnInit() {
 }
 
 static void CheckDrawCall(command_list* cmd_list, const uint64_t match_modifier = Rendering::MATCH_ALL) {
-    CommandListDataContainer& commandListData = cmd_list->get_private_data<CommandListDataContainer>();
+    if (!g_hotPathActive.load(memory_order_relaxed)) {
+        return;
+    }
+
+    CommandListDataContainer& commandListData = getHotPathData(cmd_list);
 
     if (commandListData.commandQueue & Rendering::MATCH_ALL & match_modifier) {
         if (constantHandler != nullptr && (commandListData.commandQueue & Rendering::MATCH_CONST & match_modifier)) {
@@ -556,12 +668,16 @@ static void CheckDrawCall(command_list* cmd_list, const uint64_t match_modifier
 }
 
 static bool onDraw(command_list* cmd_list, uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex, uint32_t first_instance) {
+    PROFILE_CALLBACK(ShaderToggler::PROFILE_DRAW);
+
     CheckDrawCall(cmd_list, Rendering::MATCH_PS | Rendering::MATCH_VS);
 
     return false;
 }
 
 static bool onDispatch(command_list* cmd_list, uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z) {
+    PROFILE_CALLBACK(ShaderToggler::PROFILE_DISPATCH);
+
     CheckDrawCall(cmd_list, Rendering::MATCH_CS);
 
     return false;
@@ -573,12 +689,16 @@ static bool onDrawIndexed(command_list* cmd_list,
                           uint32_t first_index,
                           int32_t vertex_offset,
                           uint32_t first_instance) {
+    PROFILE_CALLBACK(ShaderToggler::PROFILE_DRAW_INDEXED);
+
     CheckDrawCall(cmd_list, Rendering::MATCH_PS | Rendering::MATCH_VS);
 
     return false;
 }
 
 static bool onDrawOrDispatchIndirect(command_list* cmd_list, indirect_command type, resource buffer, uint64_t offset, uint32_t draw_count, uint32_t stride) {
+    PROFILE_CALLBACK(ShaderToggler::PROFILE_DRAW_OR_DISPATCH_INDIRECT);
+
     switch (type) {
         case indirect_command::unknown:
             CheckDrawCall(cmd_list);
@@ -595,6 +715,49 @@ static bool onDrawOrDispatchIndirect(command_list* cmd_list, indirect_command ty
     return false;
 }
 
+static void registerHotPathEvents() {
+    reshade::register_event<reshade::addon_event::bind_pipeline>(onBindPipeline);
+    reshade::register_event<reshade::addon_event::bind_render_targets_and_depth_stencil>(onBindRenderTargetsAndDepthStencil);
+    reshade::register_event<reshade::addon_event::begin_render_pass>(onBeginRenderPass);
+    reshade::register_event<reshade::addon_event::draw>(onDraw);
+    reshade::register_event<reshade::addon_event::dispatch>(onDispatch);
+    reshade::register_event<reshade::addon_event::draw_indexed>(onDrawIndexed);
+    reshade::register_event<reshade::addon_event::draw_or_dispatch_indirect>(onDrawOrDispatchIndirect);
+}
+
+static void unregisterHotPathEvents() {
+    reshade::unregister_event<reshade::addon_event::bind_pipeline>(onBindPipeline);
+    reshade::unregister_event<reshade::addon_event::bind_render_targets_and_depth_stencil>(onBindRenderTargetsAndDepthStencil);
+    reshade::unregister_event<reshade::addon_event::begin_render_pass>(onBeginRenderPass);
+    reshade::unregister_event<reshade::addon_event::draw>(onDraw);
+    reshade::unregister_event<reshade::addon_event::dispatch>(onDispatch);
+    reshade::unregister_event<reshade::addon_event::draw_indexed>(onDrawIndexed);
+    reshade::unregister_event<reshade::addon_event::draw_or_dispatch_indirect>(onDrawOrDispatchIndirect);
+}
+
+/// <summary>
+/// Lets the draw, dispatch and bind handlers do their work as soon as a group is active or something is hunted or edited, and makes them return
+/// right away once nothing has needed them for HOT_PATH_IDLE_FRAMES presents. The handlers stay registered for the lifetime of the addon,
+/// ReShade doesn't synchronize its event lists with command lists recording on other threads. Resuming starts a new epoch, which makes every
+/// command list drop the state it recorded before the gap, see getHotPathData.
+/// </summary>
+static void updateHotPathActive() {
+    if (!g_addonUIData.GetDynamicHotPathEvents() || g_addonUIData.IsHotPathRequired()) {
+        g_hotPathIdleFrames = 0;
+
+        if (!g_hotPathActive.load(memory_order_relaxed)) {
+            g_hotPathEpoch.fetch_add(1, memory_order_release);
+            g_hotPathActive.store(true, memory_order_release);
+        }
+
+        return;
+    }
+
+    if (g_hotPathActive.load(memory_order_relaxed) && ++g_hotPathIdleFrames >= HOT_PATH_IDLE_FRAMES) {
+        g_hotPathActive.store(false, memory_order_release);
+    }
+}
+
 /// <summary>
 /// copied from Reshade
 /// Returns the path to the module file identified by the specified <paramref name="module"/> handle.
@@ -641,24 +804,20 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID) {
             reshade::register_event<reshade::addon_event::reshade_reloaded_effects>(onReshadeReloadedEffects);
             reshade::register_event<reshade::addon_event::reshade_set_technique_state>(onReshadeSetTechniqueState);
             reshade::register_event<reshade::addon_event::reshade_reorder_techniques>(onReshadeReorderTechniques);
-            reshade::register_event<reshade::addon_event::bind_pipeline>(onBindPipeline);
             reshade::register_event<reshade::addon_event::init_device>(onInitDevice);
             reshade::register_event<reshade::addon_event::destroy_device>(onDestroyDevice);
-            reshade::register_event<reshade::addon_event::bind_render_targets_and_depth_stencil>(onBindRenderTargetsAndDepthStencil);
-            reshade::register_event<reshade::addon_event::begin_render_pass>(onBeginRenderPass);
             reshade::register_event<reshade::addon_event::init_effect_runtime>(onInitEffectRuntime);
             reshade::register_event<reshade::addon_event::destroy_effect_runtime>(onDestroyEffectRuntime);
             reshade::register_event<reshade::addon_event::present>(onPresent);
 
-            reshade::register_event<reshade::addon_event::draw>(onDraw);
-            reshade::register_event<reshade::addon_event::dispatch>(onDispatch);
-            reshade::register_event<reshade::addon_event::draw_indexed>(onDrawIndexed);
-            reshade::register_event<reshade::addon_event::draw_or_dispatch_indirect>(onDrawOrDispatchIndirect);
+            registerHotPathEvents();
+            ShaderToggler::EventTraceRecorder::Instance().RegisterEvents();
 
             reshade::register_overlay(nullptr, &displaySettings);
             break;
         case DLL_PROCESS_DETACH:
             UnInit();
+            ShaderToggler::EventTraceRecorder::Instance().UnregisterEvents();
             reshade::unregister_event<reshade::addon_event::create_swapchain>(onCreateSwapchain);
             reshade::unregister_event<reshade::addon_event::init_swapchain>(onInitSwapchain);
             reshade::unregister_event<reshade::addon_event::destroy_swapchain>(onDestroySwapchain);
@@ -672,14 +831,11 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID) {
             reshade::unregister_event<reshade::addon_event::reshade_reloaded_effects>(onReshadeReloadedEffects);
             reshade::unregister_event<reshade::addon_event::reshade_set_technique_state>(onReshadeSetTechniqueState);
             reshade::unregister_event<reshade::addon_event::reshade_reorder_techniques>(onReshadeReorderTechniques);
-            reshade::unregister_event<reshade::addon_event::bind_pipeline>(onBindPipeline);
             reshade::unregister_event<reshade::addon_event::init_command_list>(onInitCommandList);
             reshade::unregister_event<reshade::addon_event::destroy_command_list>(onDestroyCommandList);
             reshade::unregister_event<reshade::addon_event::reset_command_list>(onResetCommandList);
             reshade::unregister_event<reshade::addon_event::init_device>(onInitDevice);
             reshade::unregister_event<reshade::addon_event::destroy_device>(onDestroyDevice);
-            reshade::unregister_event<reshade::addon_event::bind_render_targets_and_depth_stencil>(onBindRenderTargetsAndDepthStencil);
-            reshade::unregister_event<reshade::addon_event::begin_render_pass>(onBeginRenderPass);
             reshade::unregister_event<reshade::addon_event::init_effect_runtime>(onInitEffectRuntime);
             reshade::unregister_event<reshade::addon_event::destroy_effect_runtime>(onDestroyEffectRuntime);
             reshade::unregister_event<reshade::addon_event::create_resource>(onCreateResource);
@@ -690,10 +846,7 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID) {
             reshade::unregister_event<reshade::addon_event::destroy_resource_view>(onDestroyResourceView);
             reshade::unregister_event<reshade::addon_event::present>(onPresent);
 
-            reshade::unregister_event<reshade::addon_event::draw>(onDraw);
-            reshade::unregister_event<reshade::addon_event::dispatch>(onDispatch);
-            reshade::unregister_event<reshade::addon_event::draw_indexed>(onDrawIndexed);
-            reshade::unregister_event<reshade::addon_event::draw_or_dispatch_indirect>(onDrawOrDispatchIndirect);
+            unregisterHotPathEvents();
 
             reshade::unregister_overlay(nullptr, &displaySettings);
 
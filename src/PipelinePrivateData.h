@@ -1,7 +1,9 @@
 #pragma once
 
 #include "CDataFile.h"
+#include "ConcurrentBitset.h"
 #include "EffectData.h"
+#include "InlineContainers.h"
 #include "ToggleGroup.h"
 #include "reshade.hpp"
 #include <chrono>
@@ -28,15 +30,25 @@ struct __declspec(novtable) ResourceRenderData final {
     reshade::api::format format;
 };
 
-using effect_queue = std::unordered_map<EffectData*, ResourceRenderData>;
-using binding_queue = std::unordered_map<ShaderToggler::ToggleGroup*, ResourceRenderData>;
+// Inline capacities of the per stage queues, they only spill to the heap (once) if more entries are queued at the same time
+constexpr size_t EFFECT_QUEUE_INLINE_CAPACITY = 32;
+constexpr size_t GROUP_QUEUE_INLINE_CAPACITY = 8;
+
+// Inline capacity of the bitsets indexed by EffectData::index
+constexpr size_t EFFECT_BITSET_INLINE_CAPACITY = 512;
+
+using effect_queue = ShaderToggler::InlineMap<EffectData*, ResourceRenderData, EFFECT_QUEUE_INLINE_CAPACITY>;
+using binding_queue = ShaderToggler::InlineMap<ShaderToggler::ToggleGroup*, ResourceRenderData, GROUP_QUEUE_INLINE_CAPACITY>;
+using effect_set = ShaderToggler::InlineSet<EffectData*, EFFECT_QUEUE_INLINE_CAPACITY>;
+using group_set = ShaderToggler::InlineSet<ShaderToggler::ToggleGroup*, GROUP_QUEUE_INLINE_CAPACITY>;
+using effect_bitset = ShaderToggler::InlineBitset<EFFECT_BITSET_INLINE_CAPACITY>;
 
 struct __declspec(novtable) ShaderData final {
     uint32_t activeShaderHash = -1;
     binding_queue bindingsToUpdate;
-    std::unordered_set<ShaderToggler::ToggleGroup*> constantBuffersToUpdate;
+    group_set constantBuffersToUpdate;
     effect_queue techniquesToRender;
-    std::unordered_set<ShaderToggler::ToggleGroup*> srvToUpdate;
+    group_set srvToUpdate;
     const std::vector<ShaderToggler::ToggleGroup*>* blockedShaderGroups = nullptr;
     uint32_t id = 0;
 
@@ -55,6 +67,7 @@ struct __declspec(novtable) ShaderData final {
 
 struct __declspec(uuid("222F7169-3C09-40DB-9BC9-EC53842CE537")) CommandListDataContainer {
     uint64_t commandQueue = 0;
+    uint64_t hotPathEpoch = 0; // hot path epoch the state below was recorded in, see getHotPathData in Main.cpp
     ShaderData ps{ 0 };
     ShaderData vs{ 1 };
     ShaderData cs{ 2 };
@@ -83,8 +96,8 @@ struct __declspec(novtable) TextureBindingData final {
 
 struct __declspec(novtable) HuntPreview final {
     reshade::api::resource target = reshade::api::resource{ 0 };
-    bool matched = false;
-    uint64_t target_invocation_location = 0;
+    std::atomic_bool matched = false;
+    std::atomic<uint64_t> target_invocation_location = 0;
     uint32_t width = 0;
     uint32_t height = 0;
     reshade::api::format format = reshade::api::format::unknown;
@@ -143,9 +156,10 @@ struct __declspec(uuid("C63E95B1-4E2F-46D6-A276-E8B4612C069A")) DeviceDataContai
     std::atomic_bool rendered_effects = false;
     std::shared_mutex binding_mutex;
     std::shared_mutex render_mutex;
-    std::unordered_set<const ShaderToggler::ToggleGroup*> bindingsUpdated;
-    std::unordered_set<const ShaderToggler::ToggleGroup*> constantsUpdated;
-    std::unordered_set<const ShaderToggler::ToggleGroup*> srvUpdated;
+    // Indexed by ToggleGroup::getIndex(), tested by command list scheduling without holding any device lock
+    ShaderToggler::ConcurrentBitset bindingsUpdated;
+    ShaderToggler::ConcurrentBitset constantsUpdated;
+    ShaderToggler::ConcurrentBitset srvUpdated;
     HuntPreview huntPreview;
     CustomShader customShader;
     ResouceManagerData resourceManagerData;
@@ -155,8 +169,12 @@ struct __declspec(uuid("C63E95B1-4E2F-46D6-A276-E8B4612C069A")) DeviceDataContai
 struct __declspec(uuid("838BAF1D-95C0-4A7E-A517-052642879986")) RuntimeDataContainer {
     std::shared_mutex technique_mutex;
     std::unordered_map<std::string, EffectData> allTechniques;
-    std::unordered_set<EffectData*> allEnabledTechniques;
-    std::vector<EffectData*> allSortedTechniques;
+    effect_bitset allEnabledTechniques; // indexed by EffectData::index
+    std::vector<EffectData*> allSortedTechniques; // EffectData::index is the position in here
+    std::vector<EffectData*> allTimedTechniques;
+    std::vector<EffectData*> allScreenshotExcludedTechniques;
+    // Techniques count as rendered if claimed in the current epoch, advanced once per present
+    std::atomic<uint64_t> frameEpoch = 1;
 
     SpecialEffect specialEffects[4] = {
         SpecialEffect{ "REST_TONEMAP_TO_SDR", reshade::api::effect_technique{ 0 } },
@@ -144,7 +144,7 @@ void RenderingBindingManager::_QueueOrDequeue(command_list* cmd_list,
                                               DeviceDataContainer& deviceData,
                                               CommandListDataContainer& commandListData,
                                               binding_queue& queue,
-                                              unordered_set<ToggleGroup*>& immediateQueue,
+                                              group_set& immediateQueue,
                                               uint64_t callLocation,
                                               uint32_t layoutIndex,
                                               uint64_t action) {
@@ -179,8 +179,8 @@ void RenderingBindingManager::_QueueOrDequeue(command_list* cmd_list,
 void RenderingBindingManager::_UpdateTextureBindings(command_list* cmd_list,
                                                      DeviceDataContainer& deviceData,
                                                      const binding_queue& bindingsToUpdate,
-                                                     vector<ToggleGroup*>& removalList,
-                                                     const unordered_set<ToggleGroup*>& toUpdateBindings) {
+                                                     group_set& removalList,
+                                                     const group_set& toUpdateBindings) {
     effect_runtime* runtime = deviceData.current_runtime;
 
     if (runtime == nullptr)
@@ -189,7 +189,7 @@ void RenderingBindingManager::_UpdateTextureBindings(command_list* cmd_list,
     auto& runtimeData = runtime->get_private_data<RuntimeDataContainer>();
 
     for (auto& [group, bindingData] : bindingsToUpdate) {
-        if (toUpdateBindings.contains(group) && !deviceData.bindingsUpdated.contains(group)) {
+        if (toUpdateBindings.contains(group) && !deviceData.bindingsUpdated.test(group->getIndex())) {
             if (bindingData.resource == 0) {
                 continue;
             }
@@ -233,8 +233,8 @@ void RenderingBindingManager::_UpdateTextureBindings(command_list* cmd_list,
                 }
             }
 
-            deviceData.bindingsUpdated.emplace(group);
-            removalList.push_back(group);
+            deviceData.bindingsUpdated.set(group->getIndex());
+            removalList.insert(group);
         }
     }
 }
@@ -258,9 +258,9 @@ void RenderingBindingManager::UpdateTextureBindings(command_list* cmd_list, uint
         return;
     }
 
-    unordered_set<ToggleGroup*> psToUpdateBindings;
-    unordered_set<ToggleGroup*> vsToUpdateBindings;
-    unordered_set<ToggleGroup*> csToUpdateBindings;
+    group_set psToUpdateBindings;
+    group_set vsToUpdateBindings;
+    group_set csToUpdateBindings;
 
     if (invocation & MATCH_BINDING_PS) {
         _QueueOrDequeue(cmd_list, deviceData, commandListData, commandListData.ps.bindingsToUpdate, psToUpdateBindings, callLocation, 0, MATCH_BINDING_PS);
@@ -278,9 +278,9 @@ void RenderingBindingManager::UpdateTextureBindings(command_list* cmd_list, uint
         return;
     }
 
-    vector<ToggleGroup*> psRemovalList;
-    vector<ToggleGroup*> vsRemovalList;
-    vector<ToggleGroup*> csRemovalList;
+    group_set psRemovalList;
+    group_set vsRemovalList;
+    group_set csRemovalList;
 
     if (psToUpdateBindings.size() > 0) {
         _UpdateTextureBindings(cmd_list, deviceData, commandListData.ps.bindingsToUpdate, psRemovalList, psToUpdateBindings);
@@ -317,7 +317,7 @@ void RenderingBindingManager::ClearUnmatchedTextureBindings(reshade::api::comman
         ToggleGroup& group = groupData.second;
         GroupResource& resources = group.GetGroupResource(ShaderToggler::GroupResourceType::RESOURCE_BINDING);
 
-        if (!data.bindingsUpdated.contains(&group) &&
+        if (!data.bindingsUpdated.test(group.getIndex()) &&
             (resources.clear_on_miss() && data.bindingManagerData.empty_srv != 0 && resources.state != ShaderToggler::GroupResourceState::RESOURCE_CLEARED)) {
             data.current_runtime->update_texture_bindings(
               group.getTextureBindingName().c_str(), data.bindingManagerData.empty_srv, data.bindingManagerData.empty_srv);
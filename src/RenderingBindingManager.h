@@ -37,8 +37,8 @@ class __declspec(novtable) RenderingBindingManager final {
     void _UpdateTextureBindings(reshade::api::command_list* cmd_list,
                                 DeviceDataContainer& deviceData,
                                 const binding_queue& bindingsToUpdate,
-                                std::vector<ShaderToggler::ToggleGroup*>& removalList,
-                                const std::unordered_set<ShaderToggler::ToggleGroup*>& toUpdateBindings);
+                                group_set& removalList,
+                                const group_set& toUpdateBindings);
     bool _CreateTextureBinding(reshade::api::effect_runtime* runtime,
                                reshade::api::resource* res,
                                reshade::api::resource_view* srv,
@@ -51,7 +51,7 @@ class __declspec(novtable) RenderingBindingManager final {
                          DeviceDataContainer& deviceData,
                          CommandListDataContainer& commandListData,
                          binding_queue& queue,
-                         std::unordered_set<ShaderToggler::ToggleGroup*>& immediateQueue,
+                         group_set& immediateQueue,
                          uint64_t callLocation,
                          uint32_t layoutIndex,
                          uint64_t action);
@@ -39,12 +39,12 @@ bool RenderingEffectManager::RenderRemainingEffects(effect_runtime* runtime) {
 
     resource_view active_rtv = view->rtv;
     resource_view active_rtv_srgb = view->rtv_srgb;
+    const uint64_t epoch = runtimeData.frameEpoch.load(memory_order_acquire);
 
     for (auto& eff : runtimeData.allSortedTechniques) {
-        if (eff->enabled && !eff->rendered) {
+        if (eff->enabled && eff->Claim(epoch)) {
             runtime->render_technique(eff->technique, cmd_list, active_rtv, active_rtv_srgb);
 
-            eff->rendered = true;
             rendered = true;
         }
     }
@@ -56,13 +56,16 @@ bool RenderingEffectManager::_RenderEffects(command_list* cmd_list,
                                             DeviceDataContainer& deviceData,
                                             RuntimeDataContainer& runtimeData,
                                             const effect_queue& techniquesToRender,
-                                            vector<EffectData*>& removalList,
-                                            const unordered_set<EffectData*>& toRenderNames) {
+                                            effect_set& removalList,
+                                            const effect_bitset& toRenderNames) {
     bool rendered = false;
     CommandListDataContainer& cmdData = cmd_list->get_private_data<CommandListDataContainer>();
     effect_runtime* runtime = deviceData.current_runtime;
+    const uint64_t epoch = runtimeData.frameEpoch.load(memory_order_acquire);
 
-    unordered_map<ToggleGroup*, pair<vector<EffectData*>, ResourceRenderData>> groupTechMap;
+    // Techniques to render in rendering order next to the groups they were queued for, each group renders with the resource of its last one
+    InlineVector<InlineMapEntry<ToggleGroup*, EffectData*>, EFFECT_QUEUE_INLINE_CAPACITY> groupTechs;
+    InlineMap<ToggleGroup*, ResourceRenderData, GROUP_QUEUE_INLINE_CAPACITY> groupResources;
 
     for (const auto& aTech : runtimeData.allSortedTechniques) {
         const auto& sTech = techniquesToRender.find(aTech);
@@ -71,19 +74,20 @@ bool RenderingEffectManager::_RenderEffects(command_list* cmd_list,
             continue;
         }
 
-        if (sTech->first->enabled && !sTech->first->rendered && toRenderNames.contains(sTech->first)) {
+        if (sTech->first->enabled && !sTech->first->IsRendered(epoch) && toRenderNames.test(sTech->first->index)) {
             const auto& [techName, techData] = *sTech;
 
-            auto& [gEffects, gResource] = groupTechMap[techData.group];
+            groupTechs.push_back({ techData.group, sTech->first });
 
-            gEffects.push_back(sTech->first);
-            gResource = sTech->second;
+            if (const auto& gResource = groupResources.find(techData.group); gResource != groupResources.end()) {
+                gResource->second = techData;
+            } else {
+                groupResources.emplace(techData.group, techData);
+            }
         }
     }
 
-    for (const auto& tech : groupTechMap) {
-        const auto& group = tech.first;
-        const auto& [effectList, active_resource] = tech.second;
+    for (const auto& [group, active_resource] : groupResources) {
 
         if (active_resource.resource == 0) {
             continue;
@@ -95,7 +99,9 @@ bool RenderingEffectManager::_RenderEffects(command_list* cmd_list,
         resource_desc desc = cmd_list->get_device()->get_resource_desc(active_resource.resource);
         GroupResource& groupResource = group->GetGroupResource(GroupResourceType::RESOURCE_ALPHA);
         const shared_ptr<GlobalResourceView>& view = resourceManager.GetResourceView(runtime->get_device(), active_resource);
+        resource group_res = {};
         bool copyPreserveAlpha = false;
+        bool invalidateAlpha = false;
 
         if (view == nullptr) {
             continue;
@@ -103,17 +109,12 @@ bool RenderingEffectManager::_RenderEffects(command_list* cmd_list,
 
         if (group->getPreserveAlpha()) {
             if (groupResourceManager.IsCompatibleWithGroupFormat(runtime->get_device(), GroupResourceType::RESOURCE_ALPHA, active_resource.resource, group)) {
-                resource group_res = {};
                 groupResourceManager.SetGroupBufferHandles(group, GroupResourceType::RESOURCE_ALPHA, &group_res, &view_non_srgb, &view_srgb, &group_view);
-                cmd_list->copy_resource(active_resource.resource, group_res);
                 copyPreserveAlpha = true;
             } else {
                 view_non_srgb = view->rtv;
                 view_srgb = view->rtv_srgb;
-
-                groupResource.state = GroupResourceState::RESOURCE_INVALID;
-                groupResource.target_description = desc;
-                groupResource.view_format = active_resource.format;
+                invalidateAlpha = true;
             }
         } else {
             view_non_srgb = view->rtv;
@@ -124,6 +125,37 @@ bool RenderingEffectManager::_RenderEffects(command_list* cmd_list,
             continue;
         }
 
+        // Only the command list winning the claim renders a technique, another one or the present fallback may have been first
+        InlineVector<EffectData*, EFFECT_QUEUE_INLINE_CAPACITY> claimedEffects;
+
+        for (const auto& [effectGroup, effectTech] : groupTechs) {
+            if (effectGroup != group) {
+                continue;
+            }
+
+            removalList.insert(effectTech);
+
+            if (effectTech->Claim(epoch)) {
+                claimedEffects.push_back(effectTech);
+            }
+        }
+
+        if (claimedEffects.empty()) {
+            continue;
+        }
+
+        // Only the claiming command list touches the target and the group's alpha resource
+        if (copyPreserveAlpha) {
+            cmd_list->copy_resource(active_resource.resource, group_res);
+        } else if (invalidateAlpha) {
+            groupResource.state = GroupResourceState::RESOURCE_INVALID;
+            groupResource.target_description = desc;
+            groupResource.view_format = active_resource.format;
+        }
+
+        // Techniques bind their own render targets, pipelines, viewports and descriptors, for graphics and compute passes alike
+        cmd_list->get_private_data<state_tracking>().mark_dirty(StateTracking::dirty_all, shader_stage::all);
+
         if (group->getFlipBuffer() && runtimeData.specialEffects[REST_FLIP].technique != 0) {
             runtime->render_technique(runtimeData.specialEffects[REST_FLIP].technique, cmd_list, view_non_srgb, view_srgb);
         }
@@ -132,13 +164,9 @@ bool RenderingEffectManager::_RenderEffects(command_list* cmd_list,
             runtime->render_technique(runtimeData.specialEffects[REST_TONEMAP_TO_SDR].technique, cmd_list, view_non_srgb, view_srgb);
         }
 
-        for (const auto& effectTech : effectList) {
+        for (const auto& effectTech : claimedEffects) {
             runtime->render_technique(effectTech->technique, cmd_list, view_non_srgb, view_srgb);
 
-            effectTech->rendered = true;
-
-            removalList.push_back(effectTech);
-
             rendered = true;
         }
 
@@ -174,8 +202,6 @@ void RenderingEffectManager::RenderEffects(command_list* cmd_list, uint64_t call
     // Remove call location from queue
     commandListData.commandQueue &= ~(invocation << (callLocation * MATCH_DELIMITER));
 
-    unique_lock<shared_mutex> renderLock(deviceData.render_mutex);
-
     if (deviceData.current_runtime == nullptr || (commandListData.ps.techniquesToRender.size() == 0 && commandListData.vs.techniquesToRender.size() == 0 &&
                                                   commandListData.cs.techniquesToRender.size() == 0)) {
         return;
@@ -183,9 +209,9 @@ void RenderingEffectManager::RenderEffects(command_list* cmd_list, uint64_t call
 
     RuntimeDataContainer& runtimeData = deviceData.current_runtime->get_private_data<RuntimeDataContainer>();
     bool toRender = false;
-    unordered_set<EffectData*> psToRenderNames;
-    unordered_set<EffectData*> vsToRenderNames;
-    unordered_set<EffectData*> csToRenderNames;
+    effect_bitset psToRenderNames;
+    effect_bitset vsToRenderNames;
+    effect_bitset csToRenderNames;
 
     if (invocation & MATCH_EFFECT_PS) {
         RenderingManager::QueueOrDequeue(
@@ -203,14 +229,18 @@ void RenderingEffectManager::RenderEffects(command_list* cmd_list, uint64_t call
     }
 
     bool rendered = false;
-    vector<EffectData*> psRemovalList;
-    vector<EffectData*> vsRemovalList;
-    vector<EffectData*> csRemovalList;
+    effect_set psRemovalList;
+    effect_set vsRemovalList;
+    effect_set csRemovalList;
 
-    if (psToRenderNames.size() == 0 && vsToRenderNames.size() == 0) {
+    if (psToRenderNames.none() && vsToRenderNames.none()) {
         return;
     }
 
+    // Which command list renders a technique is settled by EffectData::Claim, the lock only keeps the runtime from being driven by several
+    // recording threads at once
+    unique_lock<shared_mutex> renderLock(deviceData.render_mutex);
+
     if (!deviceData.rendered_effects) {
         deviceData.current_runtime->render_effects(cmd_list, resource_view{ 0 }, resource_view{ 0 });
         deviceData.rendered_effects = true;
@@ -218,11 +248,11 @@ void RenderingEffectManager::RenderEffects(command_list* cmd_list, uint64_t call
 
     shared_lock<shared_mutex> techLock(runtimeData.technique_mutex);
     rendered =
-      (psToRenderNames.size() > 0) &&
+      !psToRenderNames.none() &&
         _RenderEffects(cmd_list, deviceData, runtimeData, commandListData.ps.techniquesToRender, psRemovalList, psToRenderNames) ||
-      (vsToRenderNames.size() > 0) &&
+      !vsToRenderNames.none() &&
         _RenderEffects(cmd_list, deviceData, runtimeData, commandListData.vs.techniquesToRender, vsRemovalList, vsToRenderNames) ||
-      (csToRenderNames.size() > 0) && _RenderEffects(cmd_list, deviceData, runtimeData, commandListData.cs.techniquesToRender, csRemovalList, csToRenderNames);
+      !csToRenderNames.none() && _RenderEffects(cmd_list, deviceData, runtimeData, commandListData.cs.techniquesToRender, csRemovalList, csToRenderNames);
     techLock.unlock();
 
     for (auto& g : psRemovalList) {
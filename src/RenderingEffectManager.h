@@ -24,7 +24,7 @@ class __declspec(novtable) RenderingEffectManager final {
                         DeviceDataContainer& deviceData,
                         RuntimeDataContainer& runtimeData,
                         const effect_queue& techniquesToRender,
-                        std::vector<EffectData*>& removalList,
-                        const std::unordered_set<EffectData*>& toRenderNames);
+                        effect_set& removalList,
+                        const effect_bitset& toRenderNames);
 };
 }
\ No newline at end of file
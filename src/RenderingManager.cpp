@@ -256,7 +256,7 @@ void RenderingManager::QueueOrDequeue(command_list* cmd_list,
                                       DeviceDataContainer& deviceData,
                                       CommandListDataContainer& commandListData,
                                       effect_queue& queue,
-                                      unordered_set<EffectData*>& immediateQueue,
+                                      effect_bitset& immediateQueue,
                                       uint64_t callLocation,
                                       uint32_t layoutIndex,
                                       uint64_t action) {
@@ -281,7 +281,7 @@ void RenderingManager::QueueOrDequeue(command_list* cmd_list,
 
         // Queue updates depending on the place their supposed to be called at
         if (data.resource != 0 && (!callLocation && !data.invocationLocation || callLocation & data.invocationLocation)) {
-            immediateQueue.insert(name);
+            immediateQueue.set(name->index);
         }
 
         it++;
@@ -83,7 +83,7 @@ class __declspec(novtable) RenderingManager final {
                                DeviceDataContainer& deviceData,
                                CommandListDataContainer& commandListData,
                                effect_queue& queue,
-                               std::unordered_set<EffectData*>& immediateQueue,
+                               effect_bitset& immediateQueue,
                                uint64_t callLocation,
                                uint32_t layoutIndex,
                                uint64_t action);
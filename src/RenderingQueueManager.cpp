@@ -24,11 +24,12 @@ void RenderingQueueManager::_CheckCallForCommandList(ShaderData& sData,
     const uint64_t match_binding = MATCH_BINDING_PS << sData.id;
     const uint64_t match_const = MATCH_CONST_PS << sData.id;
     const uint64_t match_preview = MATCH_PREVIEW_PS << sData.id;
+    const uint64_t epoch = runtimeData.frameEpoch.load(memory_order_acquire);
 
     if (sData.blockedShaderGroups != nullptr) {
         for (auto group : *sData.blockedShaderGroups) {
             if (group->isActive()) {
-                if (group->getExtractConstants() && !deviceData.constantsUpdated.contains(group)) {
+                if (group->getExtractConstants() && !deviceData.constantsUpdated.test(group->getIndex())) {
                     if (!sData.constantBuffersToUpdate.contains(group)) {
                         sData.constantBuffersToUpdate.emplace(group);
                         queue_mask |= match_const;
@@ -48,7 +49,7 @@ void RenderingQueueManager::_CheckCallForCommandList(ShaderData& sData,
                     }
                 }
 
-                if (group->isProvidingTextureBinding() && !deviceData.bindingsUpdated.contains(group)) {
+                if (group->isProvidingTextureBinding() && !deviceData.bindingsUpdated.test(group->getIndex())) {
                     if (!sData.bindingsToUpdate.contains(group)) {
                         if (!group->getCopyTextureBinding() || group->getExtractResourceViews()) {
                             sData.bindingsToUpdate.emplace(group, ResourceRenderData{ group, CALL_DRAW, resource{ 0 }, format::unknown });
@@ -62,42 +63,16 @@ void RenderingQueueManager::_CheckCallForCommandList(ShaderData& sData,
                     }
                 }
 
-                if (group->getAllowAllTechniques()) {
-                    auto& preferred = group->GetPreferredTechniqueData();
-
-                    for (const auto& techData : runtimeData.allEnabledTechniques) {
-                        if (group->getHasTechniqueExceptions() && preferred.contains(techData)) {
-                            continue;
-                        }
-
-                        if (!techData->rendered) {
-                            if (!sData.techniquesToRender.contains(techData)) {
-                                if (group->getRenderToResourceViews()) {
-                                    sData.techniquesToRender.emplace(techData, ResourceRenderData{ group, CALL_DRAW, resource{ 0 }, format::unknown });
-                                    queue_mask |= (match_effect << CALL_DRAW * MATCH_DELIMITER);
-                                } else {
-                                    sData.techniquesToRender.emplace(
-                                      techData, ResourceRenderData{ group, group->getInvocationLocation(), resource{ 0 }, format::unknown });
-                                    queue_mask |=
-                                      (match_effect << (group->getInvocationLocation() * MATCH_DELIMITER)) | (match_effect << (CALL_DRAW * MATCH_DELIMITER));
-                                }
-                            }
-                        }
-                    }
-                } else if (group->preferredTechniques().size() > 0) {
-                    auto& preferred = group->GetPreferredTechniqueData();
-
-                    for (auto& eff : preferred) {
-                        if (!eff->rendered && !sData.techniquesToRender.contains(eff)) {
-                            if (group->getRenderToResourceViews()) {
-                                sData.techniquesToRender.emplace(eff, ResourceRenderData{ group, CALL_DRAW, resource{ 0 }, format::unknown });
-                                queue_mask |= (match_effect << CALL_DRAW * MATCH_DELIMITER);
-                            } else {
-                                sData.techniquesToRender.emplace(eff,
-                                                                 ResourceRenderData{ group, group->getInvocationLocation(), resource{ 0 }, format::unknown });
-                                queue_mask |=
-                                  (match_effect << (group->getInvocationLocation() * MATCH_DELIMITER)) | (match_effect << (CALL_DRAW * MATCH_DELIMITER));
-                            }
+                // The schedule only holds the enabled techniques assigned to the group, in rendering order
+                for (const auto& eff : group->GetScheduledTechniques()) {
+                    if (!eff->IsRendered(epoch) && !sData.techniquesToRender.contains(eff)) {
+                        if (group->getRenderToResourceViews()) {
+                            sData.techniquesToRender.emplace(eff, ResourceRenderData{ group, CALL_DRAW, resource{ 0 }, format::unknown });
+                            queue_mask |= (match_effect << CALL_DRAW * MATCH_DELIMITER);
+                        } else {
+                            sData.techniquesToRender.emplace(eff, ResourceRenderData{ group, group->getInvocationLocation(), resource{ 0 }, format::unknown });
+                            queue_mask |=
+                              (match_effect << (group->getInvocationLocation() * MATCH_DELIMITER)) | (match_effect << (CALL_DRAW * MATCH_DELIMITER));
                         }
                     }
                 }
@@ -117,16 +92,13 @@ void RenderingQueueManager::CheckCallForCommandList(reshade::api::command_list*
     DeviceDataContainer& deviceData = commandList->get_device()->get_private_data<DeviceDataContainer>();
     RuntimeDataContainer& runtimeData = deviceData.current_runtime->get_private_data<RuntimeDataContainer>();
 
+    // Scheduling only writes to the command list's own queues. Whether a group or technique was already handled by another command list is
+    // tested lock-free here and settled for good by the binding/render managers when the work is actually executed.
     shared_lock<shared_mutex> t_mutex(runtimeData.technique_mutex);
-    unique_lock<shared_mutex> b_mutex(deviceData.binding_mutex);
-    unique_lock<shared_mutex> r_mutex(deviceData.render_mutex);
 
     _CheckCallForCommandList(commandListData.ps, commandListData, deviceData, runtimeData);
     _CheckCallForCommandList(commandListData.vs, commandListData, deviceData, runtimeData);
     _CheckCallForCommandList(commandListData.cs, commandListData, deviceData, runtimeData);
-
-    b_mutex.unlock();
-    r_mutex.unlock();
 }
 
 void RenderingQueueManager::_RescheduleGroups(ShaderData& sData, CommandListDataContainer& commandListData, DeviceDataContainer& deviceData) {
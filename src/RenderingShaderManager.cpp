@@ -192,7 +192,13 @@ void RenderingShaderManager::ApplyShader(command_list* cmd_list,
         return;
     }
 
-    cmd_list->get_private_data<state_tracking>().capture(cmd_list, true);
+    state_tracking& state = cmd_list->get_private_data<state_tracking>();
+    state.capture(cmd_list, true);
+
+    // Binding the pipeline resets the primitive topology, the push descriptors replace the root signature of all graphics stages on D3D12
+    state.mark_dirty(StateTracking::dirty_render_targets | StateTracking::dirty_pipelines | StateTracking::dirty_pipeline_states |
+                       StateTracking::dirty_viewports | StateTracking::dirty_scissor_rects | StateTracking::dirty_descriptors,
+                     shader_stage::all_graphics);
 
     cmd_list->bind_render_targets_and_depth_stencil(1, &rtv_dst);
 
@@ -42,22 +42,25 @@ ShaderManager::ShaderManager()
 void ShaderManager::addHashHandlePair(uint32_t shaderHash, uint64_t pipelineHandle) {
     if (pipelineHandle > 0 && shaderHash > 0) {
         unique_lock lock(_hashHandlesMutex);
-        _handleToShaderHash[pipelineHandle] = shaderHash;
+        _handleToShaderHash.insert_or_assign(pipelineHandle, shaderHash);
         _shaderHashes.emplace(shaderHash);
     }
 }
 
 void ShaderManager::removeHandle(uint64_t handle) {
     unique_lock ulock(_hashHandlesMutex);
-    if (_handleToShaderHash.contains(handle)) {
-        const auto& it = _handleToShaderHash.find(handle);
-        const auto& shaderHash = it->second;
-        _handleToShaderHash.erase(handle);
+    const uint32_t shaderHash = _handleToShaderHash.erase(handle);
+    if (shaderHash > 0) {
         _collectedActiveShaderHashes.erase(shaderHash);
         _shaderHashes.erase(shaderHash);
     }
 }
 
+void ShaderManager::reclaimRetiredHandles() {
+    unique_lock ulock(_hashHandlesMutex);
+    _handleToShaderHash.reclaim();
+}
+
 void ShaderManager::startHuntingMode(const unordered_set<uint32_t> currentMarkedHashes) {
     // copy the currently marked hashes (from the active group) to the set of marked hashes.
     {
@@ -177,10 +180,10 @@ void ShaderManager::huntPreviousShader(bool ctrlPressed) {
         bool foundHash = false;
         uint32_t hash = 0;
         while (index != _activeHuntedShaderIndex) {
+            // unordered_set iterators are only guaranteed to be forward iterators, step back by advancing from the start
             if (it == _collectedActiveShaderHashes.begin()) {
-                it = _collectedActiveShaderHashes.end();
-                --it;
                 index = static_cast<int32_t>(_collectedActiveShaderHashes.size()) - 1;
+                it = std::next(_collectedActiveShaderHashes.begin(), index);
             }
             hash = *it;
             if (_markedShaderHashes.contains(hash)) {
@@ -188,8 +191,8 @@ void ShaderManager::huntPreviousShader(bool ctrlPressed) {
                 foundHash = true;
                 break;
             }
-            --it;
             index--;
+            it = std::next(_collectedActiveShaderHashes.begin(), index);
         }
         if (foundHash) {
             _activeHuntedShaderIndex = index;
@@ -237,9 +240,7 @@ bool ShaderManager::isBlockedShader(uint32_t shaderHash) {
     return toReturn;
 }
 
-void ShaderManager::addActivePipelineHandle(uint64_t handle) {
-    // get the shader hash bound to this pipeline handle
-    const auto shaderHash = getShaderHash(handle);
+void ShaderManager::addActiveShaderHash(uint32_t shaderHash) {
     if (shaderHash > 0) {
         unique_lock lock(_collectedActiveHandlesMutex);
         _collectedActiveShaderHashes.emplace(shaderHash);
@@ -261,9 +262,6 @@ void ShaderManager::toggleMarkOnHuntedShader() {
 }
 
 uint32_t ShaderManager::getShaderHash(uint64_t handle) {
-    if (!_handleToShaderHash.contains(handle)) {
-        return 0;
-    }
-    return _handleToShaderHash.at(handle);
+    return safeGetShaderHash(handle);
 }
 }
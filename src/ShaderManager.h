@@ -33,12 +33,12 @@
 #pragma once
 
 #include "CDataFile.h"
+#include "ConcurrentHandleMap.h"
 #include "ToggleGroup.h"
 #include <map>
 #include <reshade_api_device.hpp>
 #include <reshade_api_pipeline.hpp>
 #include <shared_mutex>
-#include <tsl/robin_map.h>
 #include <unordered_set>
 
 namespace ShaderToggler {
@@ -84,7 +84,7 @@ class ShaderManager {
     /// <param name="handle"></param>
     /// <returns></returns>
     uint32_t getShaderHash(uint64_t handle);
-    void addActivePipelineHandle(uint64_t handle);
+    void addActiveShaderHash(uint32_t shaderHash);
     void toggleMarkOnHuntedShader();
     void resetActiveHuntedShader();
 
@@ -129,25 +129,24 @@ class ShaderManager {
         return _markedShaderHashes.size();
     }
 
-    bool isKnownHandle(uint64_t pipelineHandle) {
-        std::shared_lock lock(_hashHandlesMutex);
-        return _handleToShaderHash.contains(pipelineHandle);
-    }
-
-    inline uint32_t safeGetShaderHash(uint64_t pipelineHandle) {
-        std::shared_lock lock(_hashHandlesMutex);
-        const auto& it = _handleToShaderHash.find(pipelineHandle);
+    // Lock-free, the handle map only takes _hashHandlesMutex on the writer side
+    bool isKnownHandle(uint64_t pipelineHandle) const { return _handleToShaderHash.contains(pipelineHandle); }
 
-        return it == _handleToShaderHash.end() ? 0 : it->second;
+    inline uint32_t safeGetShaderHash(uint64_t pipelineHandle) const {
+        uint32_t shaderHash = 0;
+        return _handleToShaderHash.find(pipelineHandle, shaderHash) ? shaderHash : 0;
     }
 
+    /// <summary>
+    /// Frees handle map storage which can no longer be referenced by readers. Meant to be called once per present.
+    /// </summary>
+    void reclaimRetiredHandles();
+
   private:
     void setActiveHuntedShaderHandle();
 
     std::unordered_set<uint32_t> _shaderHashes; // all shader hashes added through init pipeline
-    // std::unordered_map<uint64_t, uint32_t> _handleToShaderHash;		// pipeline handle per shader hash. Handle is removed when a pipeline is
-    // destroyed.
-    tsl::robin_map<uint64_t, uint32_t> _handleToShaderHash;
+    ConcurrentHandleMap<uint32_t> _handleToShaderHash; // pipeline handle per shader hash. Handle is removed when a pipeline is destroyed.
     std::unordered_set<uint32_t> _collectedActiveShaderHashes; // shader hashes bound to pipeline handles which were collected during the collection phase after
                                                                // hunting was enabled, which are the pipeline handles active during the last X frames
     std::unordered_set<uint32_t> _markedShaderHashes;          // the hashes for shaders which are currently marked.
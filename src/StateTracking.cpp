@@ -5,6 +5,8 @@
 
 #include "StateTracking.h"
 #include "reshade.hpp"
+#include <algorithm>
+#include <atomic>
 #include <limits>
 
 using namespace reshade::api;
@@ -12,6 +14,20 @@ using namespace StateTracking;
 
 bool state_tracking::track_descriptors = true;
 
+// Layout params nobody reads per shader stage, the complement of what was passed to state_tracking::set_tracking_interest.
+// Zero until then, so everything is captured.
+static std::array<std::atomic<uint64_t>, ALL_SHADER_STAGES_SIZE> s_tracking_ignored = {};
+
+static inline bool is_tracking_interest(int32_t stage_index, uint32_t layout_param) {
+    return ((s_tracking_ignored[stage_index].load(std::memory_order_relaxed) >> std::min(layout_param, 63u)) & 1) == 0;
+}
+
+void state_tracking::set_tracking_interest(const std::array<uint64_t, ALL_SHADER_STAGES_SIZE>& params) {
+    for (uint32_t i = 0; i < ALL_SHADER_STAGES_SIZE; i++) {
+        s_tracking_ignored[i].store(~params[i], std::memory_order_relaxed);
+    }
+}
+
 void state_block::apply_descriptors_dx12_vulkan(command_list* cmd_list) const {
     uint32_t shader_stages_set = 0;
     for (uint32_t stageIdx = 0; stageIdx < ALL_SHADER_STAGES_SIZE; stageIdx++) {
@@ -26,7 +42,7 @@ void state_block::apply_descriptors_dx12_vulkan(command_list* cmd_list) const {
         // shader_stages_set |= static_cast<uint32_t>(stages);
 
         // Restore root signature and descriptor heaps
-        if (pipelinelayout != 0) {
+        if (pipelinelayout != 0 && (static_cast<uint32_t>(stages) & dirty_shader_stages) != 0) {
             cmd_list->bind_descriptor_tables(stages, pipelinelayout, 0, 0, nullptr);
         } else {
             continue;
@@ -39,27 +55,24 @@ void state_block::apply_descriptors_dx12_vulkan(command_list* cmd_list) const {
                 cmd_list->bind_descriptor_tables(stages, pipelinelayout, i, 1, &root_table[i].descriptor_table);
             }
 
-            if (root_table[i].type == root_entry_type::push_constants && root_table[i].buffer_index >= 0 &&
-                constant_buffer[root_table[i].buffer_index].size() > 0) {
-                cmd_list->push_constants(stages,
-                                         pipelinelayout,
-                                         i,
-                                         0,
-                                         static_cast<uint32_t>(constant_buffer[root_table[i].buffer_index].size()),
-                                         constant_buffer[root_table[i].buffer_index].data());
+            if (root_table[i].type == root_entry_type::push_constants && root_table[i].constants.size > 0) {
+                cmd_list->push_constants(stages, pipelinelayout, i, 0, root_table[i].constants.size, root_table[i].constants.data);
             }
         }
     }
 }
 
 void state_block::apply_descriptors(command_list* cmd_list) const {
+    if ((static_cast<uint32_t>(shader_stage::pixel) & dirty_shader_stages) == 0) {
+        return;
+    }
+
     auto& [desc_layout, descriptors] = cmd_list->get_private_data<state_tracking>().root_tables[0];
     const size_t it = std::min(static_cast<size_t>(2), descriptors.size());
 
     for (uint32_t i = 0; i < it; i++) {
-        if (descriptors[i].type == root_entry_type::push_descriptors && descriptors[i].buffer_index >= 0 &&
-            descriptor_buffer[0][descriptors[i].buffer_index].size() > 0) {
-            const descriptor_tracking::descriptor_data* desc = &descriptor_buffer[0][descriptors[i].buffer_index][0];
+        if (descriptors[i].type == root_entry_type::push_descriptors && descriptors[i].descriptors.size > 0) {
+            const descriptor_tracking::descriptor_data* desc = descriptors[i].descriptors.data;
 
             switch (desc->type) {
                 case descriptor_type::sampler:
@@ -112,6 +125,14 @@ void state_block::capture(command_list* cmd_list, bool force_restore) {
     }
 }
 
+void state_block::mark_dirty(uint32_t state, shader_stage stages) {
+    dirty_state |= state;
+
+    if (state & dirty_descriptors) {
+        dirty_shader_stages |= static_cast<uint32_t>(stages);
+    }
+}
+
 void state_block::apply(command_list* cmd_list, bool force_restore) {
     switch (cmd_list->get_device()->get_api()) {
         case device_api::d3d9:
@@ -120,6 +141,9 @@ void state_block::apply(command_list* cmd_list, bool force_restore) {
         default:
             apply_default(cmd_list, force_restore);
     }
+
+    dirty_state = dirty_none;
+    dirty_shader_stages = 0;
 }
 
 void state_block::apply_dx9(reshade::api::command_list* cmd_list, bool force_restore) {
@@ -144,35 +168,43 @@ void state_block::apply_default(reshade::api::command_list* cmd_list, bool force
         return;
     }
 
-    if (!render_targets.empty() || depth_stencil != 0)
+    if ((dirty_state & dirty_render_targets) && (!render_targets.empty() || depth_stencil != 0))
         cmd_list->bind_render_targets_and_depth_stencil(static_cast<uint32_t>(render_targets.size()), render_targets.data(), depth_stencil);
 
-    uint32_t pipeline_stages_set = 0;
-    for (uint32_t s = 0; s < ALL_PIPELINE_STAGES_SIZE; s++) {
-        if ((static_cast<uint32_t>(current_pipeline_stage[s]) | pipeline_stages_set) > pipeline_stages_set) {
-            pipeline_stages_set |= static_cast<uint32_t>(current_pipeline_stage[s]);
-            cmd_list->bind_pipeline(current_pipeline_stage[s], current_pipeline[s]);
+    if (dirty_state & dirty_pipelines) {
+        uint32_t pipeline_stages_set = 0;
+        for (uint32_t s = 0; s < ALL_PIPELINE_STAGES_SIZE; s++) {
+            if ((static_cast<uint32_t>(current_pipeline_stage[s]) | pipeline_stages_set) > pipeline_stages_set) {
+                pipeline_stages_set |= static_cast<uint32_t>(current_pipeline_stage[s]);
+                cmd_list->bind_pipeline(current_pipeline_stage[s], current_pipeline[s]);
+            }
         }
     }
 
-    if (primitive_topology != primitive_topology::undefined)
-        cmd_list->bind_pipeline_state(dynamic_state::primitive_topology, static_cast<uint32_t>(primitive_topology));
-    if (blend_constant != 0)
-        cmd_list->bind_pipeline_state(dynamic_state::blend_constant, blend_constant);
-    if (sample_mask != 0xFFFFFFFF)
-        cmd_list->bind_pipeline_state(dynamic_state::sample_mask, sample_mask);
-    if (front_stencil_reference_value != 0)
-        cmd_list->bind_pipeline_state(dynamic_state::front_stencil_reference_value, front_stencil_reference_value);
-    if (cmd_list->get_device()->get_api() >= device_api::d3d12) {
-        if (back_stencil_reference_value != 0)
-            cmd_list->bind_pipeline_state(dynamic_state::back_stencil_reference_value, back_stencil_reference_value);
+    if (dirty_state & dirty_pipeline_states) {
+        if (primitive_topology != primitive_topology::undefined)
+            cmd_list->bind_pipeline_state(dynamic_state::primitive_topology, static_cast<uint32_t>(primitive_topology));
+        if (blend_constant != 0)
+            cmd_list->bind_pipeline_state(dynamic_state::blend_constant, blend_constant);
+        if (sample_mask != 0xFFFFFFFF)
+            cmd_list->bind_pipeline_state(dynamic_state::sample_mask, sample_mask);
+        if (front_stencil_reference_value != 0)
+            cmd_list->bind_pipeline_state(dynamic_state::front_stencil_reference_value, front_stencil_reference_value);
+        if (cmd_list->get_device()->get_api() >= device_api::d3d12) {
+            if (back_stencil_reference_value != 0)
+                cmd_list->bind_pipeline_state(dynamic_state::back_stencil_reference_value, back_stencil_reference_value);
+        }
     }
 
-    if (!viewports.empty())
+    if ((dirty_state & dirty_viewports) && !viewports.empty())
         cmd_list->bind_viewports(0, static_cast<uint32_t>(viewports.size()), viewports.data());
-    if (!scissor_rects.empty())
+    if ((dirty_state & dirty_scissor_rects) && !scissor_rects.empty())
         cmd_list->bind_scissor_rects(0, static_cast<uint32_t>(scissor_rects.size()), scissor_rects.data());
 
+    if (!(dirty_state & dirty_descriptors)) {
+        return;
+    }
+
     if (cmd_list->get_device()->get_api() == device_api::d3d12 || cmd_list->get_device()->get_api() == device_api::vulkan) {
         apply_descriptors_dx12_vulkan(cmd_list);
     } else {
@@ -192,11 +224,15 @@ void state_block::clear() {
     scissor_rects.clear();
     root_tables.fill(make_pair(pipeline_layout{ 0 }, std::vector<root_entry>()));
     root_table_stages.fill(static_cast<shader_stage>(0));
-    std::for_each(constant_buffer.begin(), constant_buffer.end(), [](std::vector<std::vector<uint32_t>>& v) { v.clear(); });
-    std::for_each(descriptor_buffer.begin(), descriptor_buffer.end(), [](std::vector<std::vector<descriptor_tracking::descriptor_data>>& v) { v.clear(); });
+    descriptor_storage.reset();
+    descriptor_storage_spare.reset();
+    constant_storage.reset();
+    constant_storage_spare.reset();
     current_pipeline.fill(pipeline{ 0 });
     current_pipeline_stage.fill(static_cast<pipeline_stage>(0));
     resource_barrier_track.clear();
+    dirty_state = dirty_none;
+    dirty_shader_stages = 0;
 }
 
 void state_block::clear_present(effect_runtime* runtime) {
@@ -204,6 +240,32 @@ void state_block::clear_present(effect_runtime* runtime) {
     depth_stencil = { 0 };
 }
 
+void state_block::compact_storage() {
+    descriptor_storage_spare.reset();
+    constant_storage_spare.reset();
+
+    for (auto& [layout, root_table] : root_tables) {
+        for (auto& entry : root_table) {
+            if (entry.descriptors.data != nullptr) {
+                descriptor_span moved = descriptor_storage_spare.allocate(entry.descriptors.size);
+                std::copy_n(entry.descriptors.data, entry.descriptors.size, moved.data);
+                entry.descriptors = moved;
+            }
+
+            if (entry.constants.data != nullptr) {
+                constant_span moved = constant_storage_spare.allocate(entry.constants.size);
+                std::copy_n(entry.constants.data, entry.constants.size, moved.data);
+                entry.constants = moved;
+            }
+        }
+    }
+
+    std::swap(descriptor_storage, descriptor_storage_spare);
+    std::swap(constant_storage, constant_storage_spare);
+    descriptor_storage_spare.reset();
+    constant_storage_spare.reset();
+}
+
 static inline int32_t get_shader_stage_index(shader_stage stages) {
     const uint32_t stage_value = static_cast<uint32_t>(stages);
 
@@ -229,7 +291,9 @@ static inline int32_t get_pipeline_stage_index(pipeline_stage stages) {
 }
 
 static void on_init_command_list(command_list* cmd_list) {
-    cmd_list->create_private_data<state_tracking>();
+    auto& state = cmd_list->create_private_data<state_tracking>();
+    state.device = cmd_list->get_device();
+    state.api = state.device->get_api();
 
     auto& deviceState = cmd_list->get_device()->get_private_data<DeviceStateTracking>();
     std::unique_lock<std::shared_mutex> lock(deviceState.cmd_list_mutex);
@@ -337,28 +401,18 @@ static void on_bind_scissor_rects(command_list* cmd_list, uint32_t first, uint32
         state.scissor_rects[i + first] = rects[i];
 }
 
-static void on_bind_descriptor_tables(command_list* cmd_list,
-                                      shader_stage stages,
-                                      pipeline_layout layout,
-                                      uint32_t first,
-                                      uint32_t count,
-                                      const descriptor_table* tables) {
+void state_block::bind_descriptor_tables(shader_stage stages, pipeline_layout layout, uint32_t first, uint32_t count, const descriptor_table* tables) {
     int32_t idx = get_shader_stage_index(stages);
 
     if (idx < 0)
         return;
 
-    auto& state_tracker = cmd_list->get_private_data<state_tracking>();
-    const auto& descriptor_state = cmd_list->get_device()->get_private_data<descriptor_tracking>();
-    auto& [desc_layout, root_table] = state_tracker.root_tables[idx];
-    auto& state_stages = state_tracker.root_table_stages[idx];
-    auto& descriptor_buffer = state_tracker.descriptor_buffer[idx];
-    auto& constant_buffer = state_tracker.constant_buffer[idx];
+    const auto& descriptor_state = device->get_private_data<descriptor_tracking>();
+    auto& [desc_layout, root_table] = root_tables[idx];
+    auto& state_stages = root_table_stages[idx];
 
     if (desc_layout != layout) {
         root_table.clear(); // Layout changed, which resets all descriptor set bindings
-        descriptor_buffer.clear();
-        constant_buffer.clear();
     }
 
     desc_layout = layout;
@@ -379,25 +433,51 @@ static void on_bind_descriptor_tables(command_list* cmd_list,
                 max_descriptor_size = std::max(max_descriptor_size, range.binding + range.count);
         }
 
-        std::vector<descriptor_tracking::descriptor_data> descriptors(max_descriptor_size);
+        // Only the size is known at this point, most bound tables are never inspected before they're replaced
+        root_table[i + first] = { root_entry_type::descriptor_table, descriptor_span{ nullptr, max_descriptor_size }, tables[i] };
+    }
+}
 
-        for (uint32_t k = 0; k < param.descriptor_table.count; ++k) {
-            const descriptor_range& range = param.descriptor_table.ranges[k];
+void state_block::resolve_descriptor_table(uint32_t stageIndex, uint32_t layout_param) {
+    auto& [layout, root_table] = root_tables[stageIndex];
+
+    if (root_table.size() <= layout_param)
+        return;
 
-            if (range.count == UINT32_MAX || range.type == descriptor_type::sampler)
-                continue; // Skip unbounded ranges
+    root_entry& entry = root_table[layout_param];
 
-            uint32_t base_offset = 0;
-            descriptor_heap heap = { 0 };
-            cmd_list->get_device()->get_descriptor_heap_offset(tables[i], range.binding, 0, &heap, &base_offset);
+    if (entry.type != root_entry_type::descriptor_table || entry.descriptors.data != nullptr || entry.descriptors.size == 0)
+        return;
 
-            descriptor_state.set_all_descriptors(heap, base_offset, range.count, descriptors, range.binding);
-        }
+    const auto& descriptor_state = device->get_private_data<descriptor_tracking>();
+    const pipeline_layout_param param = descriptor_state.get_pipeline_layout_param(layout, layout_param);
+
+    // Snapshots live until the command list is reset or compacted, rebinding a table doesn't return the previous one to the arena
+    descriptor_span descriptors = descriptor_storage.allocate(entry.descriptors.size);
+
+    for (uint32_t k = 0; k < param.descriptor_table.count; ++k) {
+        const descriptor_range& range = param.descriptor_table.ranges[k];
+
+        if (range.count == UINT32_MAX || range.type == descriptor_type::sampler)
+            continue; // Skip unbounded ranges
 
-        descriptor_buffer.push_back(std::move(descriptors));
+        uint32_t base_offset = 0;
+        descriptor_heap heap = { 0 };
+        device->get_descriptor_heap_offset(entry.descriptor_table, range.binding, 0, &heap, &base_offset);
 
-        root_table[i + first] = { root_entry_type::descriptor_table, static_cast<int32_t>(descriptor_buffer.size()) - 1, tables[i] };
+        descriptor_state.set_all_descriptors(heap, base_offset, range.count, descriptors.data, range.binding);
     }
+
+    entry.descriptors = descriptors;
+}
+
+static void on_bind_descriptor_tables(command_list* cmd_list,
+                                      shader_stage stages,
+                                      pipeline_layout layout,
+                                      uint32_t first,
+                                      uint32_t count,
+                                      const descriptor_table* tables) {
+    cmd_list->get_private_data<state_tracking>().bind_descriptor_tables(stages, layout, first, count, tables);
 }
 
 static void on_bind_descriptor_tables_no_track(command_list* cmd_list,
@@ -414,13 +494,9 @@ static void on_bind_descriptor_tables_no_track(command_list* cmd_list,
     auto& state_tracker = cmd_list->get_private_data<state_tracking>();
     auto& [desc_layout, root_table] = state_tracker.root_tables[idx];
     auto& state_stages = state_tracker.root_table_stages[idx];
-    auto& constant_buffer = state_tracker.constant_buffer[idx];
-    auto& descriptor_buffer = state_tracker.descriptor_buffer[idx];
 
     if (desc_layout != layout) {
         root_table.clear(); // Layout changed, which resets all descriptor set bindings
-        constant_buffer.clear();
-        descriptor_buffer.clear();
     }
 
     desc_layout = layout;
@@ -434,9 +510,9 @@ static void on_bind_descriptor_tables_no_track(command_list* cmd_list,
     }
 }
 
-static inline void fill_descriptors(std::vector<descriptor_tracking::descriptor_data>& table, const descriptor_table_update& update) {
+static inline void fill_descriptors(descriptor_span& table, const descriptor_table_update& update) {
     for (uint32_t i = 0; i < update.count; i++) {
-        descriptor_tracking::descriptor_data& descriptor = table[update.binding + i];
+        descriptor_tracking::descriptor_data& descriptor = table.data[update.binding + i];
 
         descriptor.type = update.type;
 
@@ -473,11 +549,21 @@ static void on_push_descriptors(command_list* cmd_list,
     auto& state_tracker = cmd_list->get_private_data<state_tracking>();
     auto& [desc_layout, root_table] = state_tracker.root_tables[idx];
     auto& state_stages = state_tracker.root_table_stages[idx];
-    auto& descriptor_buffer = state_tracker.descriptor_buffer[idx];
 
     desc_layout = layout;
     state_stages = stages;
 
+    // Outside of D3D12 and Vulkan the first two pixel shader params are restored after rendering effects, see apply_descriptors
+    const bool restored = idx == 0 && layout_param < 2 && state_tracker.api != device_api::d3d12 && state_tracker.api != device_api::vulkan;
+
+    if (!restored && !is_tracking_interest(idx, layout_param)) {
+        if (root_table.size() > layout_param) {
+            root_table[layout_param] = {};
+        }
+
+        return;
+    }
+
     if (root_table.size() < layout_param + 1) {
         root_table.resize(layout_param + 1);
     }
@@ -486,17 +572,25 @@ static void on_push_descriptors(command_list* cmd_list,
 
     // Initialize table for descriptors
     if (root_table_entry.type == root_entry_type::undefined) {
-        std::vector<descriptor_tracking::descriptor_data> buf(update.binding + update.count);
+        descriptor_span buf = state_tracker.descriptor_storage.allocate(update.binding + update.count);
 
         fill_descriptors(buf, update);
 
-        descriptor_buffer.push_back(std::move(buf));
-        root_table_entry = { root_entry_type::push_descriptors, static_cast<int32_t>(descriptor_buffer.size()) - 1, {} };
+        root_table_entry = { root_entry_type::push_descriptors, buf, {} };
     } else {
-        auto& buf = descriptor_buffer[root_table_entry.buffer_index];
+        state_tracker.resolve_descriptor_table(idx, layout_param);
+
+        auto& buf = root_table_entry.descriptors;
 
-        if (buf.size() < update.binding + update.count) {
-            buf.resize(update.binding + update.count);
+        // Arena allocations can't grow in place, move to a larger one
+        if (buf.size < update.binding + update.count) {
+            descriptor_span grown = state_tracker.descriptor_storage.allocate(update.binding + update.count);
+
+            if (buf.size > 0) {
+                std::copy_n(buf.data, buf.size, grown.data);
+            }
+
+            buf = grown;
         }
 
         fill_descriptors(buf, update);
@@ -518,52 +612,55 @@ static void on_push_constants(command_list* cmd_list,
     auto& state_tracker = cmd_list->get_private_data<state_tracking>();
     auto& [desc_layout, root_table] = state_tracker.root_tables[idx];
     auto& state_stages = state_tracker.root_table_stages[idx];
-    auto& constant_buffer = state_tracker.constant_buffer[idx];
 
     desc_layout = layout;
     state_stages = stages;
 
+    // D3D12 and Vulkan restore all push constants after rendering effects, see apply_descriptors_dx12_vulkan
+    const bool restored = state_tracker.api == device_api::d3d12 || state_tracker.api == device_api::vulkan;
+
+    if (!restored && !is_tracking_interest(idx, layout_param)) {
+        if (root_table.size() > layout_param) {
+            root_table[layout_param] = {};
+        }
+
+        return;
+    }
+
     if (root_table.size() < layout_param + 1) {
         root_table.resize(layout_param + 1);
     }
 
     auto& root_table_entry = root_table[layout_param];
 
-    // Not buffered yet, initialize
-    if (root_table_entry.type == root_entry_type::undefined) {
-        std::vector<uint32_t> buf(first + count);
-
-        for (uint32_t i = 0; i < count; i++) {
-            buf[first + i] = reinterpret_cast<const uint32_t*>(values)[i];
-        }
+    if (root_table_entry.type != root_entry_type::push_constants) {
+        root_table_entry = constant_span{};
+    }
 
-        constant_buffer.push_back(std::move(buf));
+    auto& buf = root_table_entry.constants;
 
-        root_table_entry = { root_entry_type::push_constants, static_cast<int32_t>(constant_buffer.size()) - 1, {} };
-    } else // Write to existing buffer index
-    {
-        auto& buf = constant_buffer[root_table_entry.buffer_index];
+    // Arena allocations can't grow in place, move to a larger one. Once a param reached its size, capturing is a plain copy.
+    if (buf.size < first + count) {
+        constant_span grown = state_tracker.constant_storage.allocate(first + count);
 
-        if (buf.size() < first + count) {
-            buf.resize(first + count);
+        if (buf.size > 0) {
+            std::copy_n(buf.data, buf.size, grown.data);
         }
 
-        for (uint32_t i = 0; i < count; i++) {
-            buf[first + i] = reinterpret_cast<const uint32_t*>(values)[i];
-        }
+        buf = grown;
     }
+
+    std::copy_n(static_cast<const uint32_t*>(values), count, buf.data + first);
 }
 
-const descriptor_tracking::descriptor_data* state_block::get_descriptor_at(uint32_t stageIndex, uint32_t layout_param, uint32_t binding) const {
+const descriptor_tracking::descriptor_data* state_block::get_descriptor_at(uint32_t stageIndex, uint32_t layout_param, uint32_t binding) {
     if (root_tables[stageIndex].second.size() > layout_param) {
-        const auto& root_entry = root_tables[stageIndex].second[layout_param];
+        resolve_descriptor_table(stageIndex, layout_param);
 
-        if ((root_entry.type == root_entry_type::push_descriptors || root_entry.type == root_entry_type::descriptor_table) && root_entry.buffer_index >= 0) {
-            const auto& table_entry = descriptor_buffer[stageIndex][root_entry.buffer_index];
+        const auto& root_entry = root_tables[stageIndex].second[layout_param];
 
-            if (table_entry.size() > binding) {
-                return &table_entry[binding];
-            }
+        if ((root_entry.type == root_entry_type::push_descriptors || root_entry.type == root_entry_type::descriptor_table) && root_entry.descriptors.size > binding) {
+            return &root_entry.descriptors.data[binding];
         }
     }
 
@@ -574,10 +671,10 @@ const size_t state_block::get_root_table_entry_size_at(uint32_t stageIndex, uint
     if (root_tables[stageIndex].second.size() > layout_param) {
         const auto& root_entry = root_tables[stageIndex].second[layout_param];
 
-        if ((root_entry.type == root_entry_type::push_descriptors || root_entry.type == root_entry_type::descriptor_table) && root_entry.buffer_index >= 0) {
-            return descriptor_buffer[stageIndex][root_entry.buffer_index].size();
-        } else if (root_entry.type == root_entry_type::push_constants && root_entry.buffer_index >= 0) {
-            return constant_buffer[root_entry.buffer_index].size();
+        if (root_entry.type == root_entry_type::push_descriptors || root_entry.type == root_entry_type::descriptor_table) {
+            return root_entry.descriptors.size;
+        } else if (root_entry.type == root_entry_type::push_constants) {
+            return root_entry.constants.size;
         }
     }
 
@@ -588,16 +685,16 @@ const size_t state_block::get_root_table_size_at(uint32_t stageIndex) const {
     return root_tables[stageIndex].second.size();
 }
 
-const std::vector<uint32_t>* state_block::get_constants_at(uint32_t stageIndex, uint32_t layout_param) const {
+constant_span state_block::get_constants_at(uint32_t stageIndex, uint32_t layout_param) const {
     if (root_tables[stageIndex].second.size() > layout_param) {
         const auto& root_entry = root_tables[stageIndex].second[layout_param];
 
-        if (root_entry.type == root_entry_type::push_constants && root_entry.buffer_index >= 0) {
-            return &constant_buffer[stageIndex][root_entry.buffer_index];
+        if (root_entry.type == root_entry_type::push_constants) {
+            return root_entry.constants;
         }
     }
 
-    return nullptr;
+    return {};
 }
 
 static void on_reset_command_list(command_list* cmd_list) {
@@ -609,6 +706,9 @@ static void on_reshade_present(effect_runtime* runtime) {
     if (runtime->get_device()->get_api() != device_api::d3d12 && runtime->get_device()->get_api() != device_api::vulkan) {
         auto& state = runtime->get_command_queue()->get_immediate_command_list()->get_private_data<state_tracking>();
         state.clear_present(runtime);
+
+        // The immediate context is never reset, keep its descriptor arena from growing over the frames
+        state.compact_storage();
     }
 }
 
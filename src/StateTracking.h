@@ -6,8 +6,10 @@
 #pragma once
 
 #include "DescriptorTracking.h"
+#include <algorithm>
 #include <array>
 #include <d3d9.h>
+#include <memory>
 #include <shared_mutex>
 #include <unordered_map>
 #include <unordered_set>
@@ -43,26 +45,123 @@ struct barrier_track {
     int32_t ref_count = 0;
 };
 
+/// <summary>
+/// Elements of a root table entry, pointing into a span_arena of the owning state block.
+/// </summary>
+template <typename T>
+struct arena_span {
+    T* data = nullptr;
+    uint32_t size = 0;
+};
+
+/// <summary>
+/// Descriptors of a root table entry. Bound descriptor tables start out with data == nullptr and size set to the bound range, the descriptors
+/// are read from the tracked heaps on first access, see state_block::resolve_descriptor_table.
+/// </summary>
+using descriptor_span = arena_span<descriptor_tracking::descriptor_data>;
+/// <summary>
+/// 32 bit values of a push constants root table entry.
+/// </summary>
+using constant_span = arena_span<uint32_t>;
+
+/// <summary>
+/// Bump allocator for the captured state of a command list. Chunks are kept when the arena is reset, so a command list which reached its
+/// steady state doesn't allocate anymore. Memory is only given back to the arena as a whole.
+/// </summary>
+template <typename T, uint32_t CHUNK_SIZE>
+class span_arena {
+  public:
+    /// <summary>
+    /// Returns count value initialized elements which stay valid until the next reset.
+    /// </summary>
+    arena_span<T> allocate(uint32_t count) {
+        if (count == 0) {
+            return {};
+        }
+
+        while (current_chunk < chunks.size() && chunks[current_chunk].capacity - chunk_offset < count) {
+            current_chunk++;
+            chunk_offset = 0;
+        }
+
+        if (current_chunk == chunks.size()) {
+            const uint32_t capacity = std::max(CHUNK_SIZE, count);
+            chunks.push_back({ std::make_unique<T[]>(capacity), capacity });
+        }
+
+        arena_span<T> span = { chunks[current_chunk].data.get() + chunk_offset, count };
+        std::fill_n(span.data, count, T{});
+        chunk_offset += count;
+
+        return span;
+    }
+
+    void reset() {
+        current_chunk = 0;
+        chunk_offset = 0;
+    }
+
+    size_t reserved_bytes() const {
+        size_t elements = 0;
+
+        for (const auto& c : chunks) {
+            elements += c.capacity;
+        }
+
+        return elements * sizeof(T);
+    }
+
+  private:
+    struct chunk {
+        std::unique_ptr<T[]> data;
+        uint32_t capacity = 0;
+    };
+
+    std::vector<chunk> chunks;
+    size_t current_chunk = 0;
+    uint32_t chunk_offset = 0;
+};
+
+using descriptor_arena = span_arena<descriptor_tracking::descriptor_data, 1024>;
+using constant_arena = span_arena<uint32_t, 4096>;
+
+/// <summary>
+/// State categories restored by state_block::apply. Code which overwrites command list state marks what it touched with state_block::mark_dirty,
+/// apply then only restores those categories.
+/// </summary>
+enum dirty_state_flags : uint32_t {
+    dirty_none = 0,
+    dirty_render_targets = 1 << 0,
+    dirty_pipelines = 1 << 1,
+    dirty_pipeline_states = 1 << 2,
+    dirty_viewports = 1 << 3,
+    dirty_scissor_rects = 1 << 4,
+    dirty_descriptors = 1 << 5, // descriptor tables, push descriptors and push constants of the marked shader stages
+    dirty_all = (1 << 6) - 1
+};
+
 enum class root_entry_type : int32_t { undefined = -1, push_constants = 1, descriptor_table = 0, push_descriptors = 2, push_descriptors_with_ranges = 3 };
 
 struct root_entry {
     constexpr root_entry()
       : type(root_entry_type::undefined)
-      , buffer_index(-1)
       , descriptor_table({ 0 }) {}
-    constexpr root_entry(root_entry_type t, int32_t index, const reshade::api::descriptor_table& table)
+    constexpr root_entry(const constant_span& span)
+      : type(root_entry_type::push_constants)
+      , descriptor_table({ 0 })
+      , constants(span) {}
+    constexpr root_entry(root_entry_type t, const descriptor_span& span, const reshade::api::descriptor_table& table)
       : type(t)
-      , buffer_index(index)
-      , descriptor_table(table) {}
+      , descriptor_table(table)
+      , descriptors(span) {}
     constexpr root_entry(const reshade::api::descriptor_table& table)
       : type(root_entry_type::descriptor_table)
-      , buffer_index(-1)
       , descriptor_table(table) {}
 
     root_entry_type type = root_entry_type::undefined;
-    int32_t buffer_index = -1;
-    ;
     reshade::api::descriptor_table descriptor_table = {};
+    descriptor_span descriptors; // descriptor tables and push descriptors
+    constant_span constants;     // push constants
 };
 
 struct state_block {
@@ -72,27 +171,62 @@ struct state_block {
     /// <param name="cmd_list">Target command list to bind the state on.</param>
 
     void capture(reshade::api::command_list* cmd_list, bool force_restore = false);
+    /// <summary>
+    /// Records that state of the given categories was overwritten, dirty_descriptors only for the shader stages passed in.
+    /// </summary>
+    void mark_dirty(uint32_t state, reshade::api::shader_stage stages = reshade::api::shader_stage::all);
 
+    /// <summary>
+    /// Restores the state marked dirty since the last apply and clears the marks.
+    /// </summary>
     void apply(reshade::api::command_list* cmd_list, bool force_restore = false);
     void apply_dx9(reshade::api::command_list* cmd_list, bool force_restore);
     void apply_default(reshade::api::command_list* cmd_list, bool force_restore) const;
 
     void apply_descriptors_dx12_vulkan(reshade::api::command_list* cmd_list) const;
+    /// <summary>
+    /// Restores the first two pixel shader params outside of D3D12 and Vulkan. Does nothing unless the pixel stage was marked dirty, marks for
+    /// other stages only matter on D3D12 and Vulkan.
+    /// </summary>
     void apply_descriptors(reshade::api::command_list* cmd_list) const;
 
     void start_resource_barrier_tracking(reshade::api::resource res, reshade::api::resource_usage current_usage);
     reshade::api::resource_usage stop_resource_barrier_tracking(reshade::api::resource res);
 
-    const descriptor_tracking::descriptor_data* get_descriptor_at(uint32_t stageIndex, uint32_t layout_param, uint32_t binding) const;
+    /// <summary>
+    /// Records descriptor tables bound to the given shader stages. The descriptors aren't read until the table is first accessed.
+    /// </summary>
+    void bind_descriptor_tables(reshade::api::shader_stage stages,
+                                reshade::api::pipeline_layout layout,
+                                uint32_t first,
+                                uint32_t count,
+                                const reshade::api::descriptor_table* tables);
+    /// <summary>
+    /// Reads the descriptors of a bound descriptor table from the tracked heaps if that didn't happen yet. Heap updates between the bind and
+    /// this call are visible in the result, which matches what the GPU reads when the draw executes.
+    /// </summary>
+    void resolve_descriptor_table(uint32_t stageIndex, uint32_t layout_param);
+
+    const descriptor_tracking::descriptor_data* get_descriptor_at(uint32_t stageIndex, uint32_t layout_param, uint32_t binding);
     const size_t get_root_table_entry_size_at(uint32_t stageIndex, uint32_t layout_param) const;
     const size_t get_root_table_size_at(uint32_t stageIndex) const;
-    const std::vector<uint32_t>* get_constants_at(uint32_t stageIndex, uint32_t layout_param) const;
+    constant_span get_constants_at(uint32_t stageIndex, uint32_t layout_param) const;
 
     /// <summary>
     /// Removes all state in this state block.
     /// </summary>
     void clear();
     void clear_present(reshade::api::effect_runtime* runtime);
+    /// <summary>
+    /// Moves the descriptors and push constants still referenced by the root tables into the spare arenas and resets the other ones. Used for
+    /// command lists which are never reset, like the immediate context. Unresolved descriptor tables stay unresolved.
+    /// </summary>
+    void compact_storage();
+
+    reshade::api::device* device = nullptr;
+    reshade::api::device_api api = reshade::api::device_api::d3d11;
+    uint32_t dirty_state = dirty_none;
+    uint32_t dirty_shader_stages = 0;
 
     std::vector<reshade::api::resource_view> render_targets;
     reshade::api::resource_view depth_stencil = { 0 };
@@ -108,8 +242,10 @@ struct state_block {
 
     std::array<std::pair<reshade::api::pipeline_layout, std::vector<root_entry>>, ALL_SHADER_STAGES_SIZE> root_tables;
     std::array<reshade::api::shader_stage, ALL_SHADER_STAGES_SIZE> root_table_stages;
-    std::array<std::vector<std::vector<uint32_t>>, ALL_SHADER_STAGES_SIZE> constant_buffer;
-    std::array<std::vector<std::vector<descriptor_tracking::descriptor_data>>, ALL_SHADER_STAGES_SIZE> descriptor_buffer;
+    descriptor_arena descriptor_storage;
+    descriptor_arena descriptor_storage_spare;
+    constant_arena constant_storage;
+    constant_arena constant_storage_spare;
 
     std::unordered_map<uint64_t, barrier_track> resource_barrier_track;
 
@@ -136,6 +272,11 @@ class __declspec(uuid("c9abddf0-f9c2-4a7b-af49-89d8d470e207")) state_tracking :
     /// Unregisters all the necessary add-on events for state tracking to work.
     /// </summary>
     static void unregister_events();
+    /// <summary>
+    /// Sets the layout params the addon reads per shader stage, bit n standing for param n and bit 63 for every param from 63 on.
+    /// Descriptors and push constants of other params are only captured if they're needed to restore the state. Everything is captured by default.
+    /// </summary>
+    static void set_tracking_interest(const std::array<uint64_t, StateTracking::ALL_SHADER_STAGES_SIZE>& params);
 
   private:
     static bool track_descriptors;
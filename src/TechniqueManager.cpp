@@ -7,8 +7,9 @@ using namespace std;
 size_t TechniqueManager::charBufferSize = CHAR_BUFFER_SIZE;
 char TechniqueManager::charBuffer[CHAR_BUFFER_SIZE];
 
-TechniqueManager::TechniqueManager(KeyMonitor& kMonitor)
-  : keyMonitor(kMonitor) {}
+TechniqueManager::TechniqueManager(KeyMonitor& kMonitor, AddonImGui::AddonUIData& data)
+  : keyMonitor(kMonitor)
+  , uiData(data) {}
 
 void TechniqueManager::AddEffectsReloadingCallback(std::function<void(reshade::api::effect_runtime*)> callback) {
     effectsReloadingCallback.push_back(callback);
@@ -30,13 +31,63 @@ void TechniqueManager::SignalEffectsReloaded(reshade::api::effect_runtime* runti
     }
 }
 
-void TechniqueManager::OnReshadeReloadedEffects(reshade::api::effect_runtime* runtime) {
-    RuntimeDataContainer& data = runtime->get_private_data<RuntimeDataContainer>();
-    unique_lock<shared_mutex> lock(data.technique_mutex);
+void TechniqueManager::UpdateGroupSchedules(reshade::api::effect_runtime* runtime, EffectData* effect) {
+    DeviceDataContainer& deviceData = runtime->get_device()->get_private_data<DeviceDataContainer>();
+
+    if (deviceData.current_runtime != runtime) {
+        return;
+    }
+
+    for (auto& [_, group] : uiData.GetToggleGroups()) {
+        if (effect->enabled && group.IsSchedulingTechnique(effect)) {
+            group.ScheduleTechnique(effect);
+        } else {
+            group.UnscheduleTechnique(effect);
+        }
+    }
+}
+
+void TechniqueManager::RebuildGroupSchedules(reshade::api::effect_runtime* runtime, RuntimeDataContainer& data) {
+    DeviceDataContainer& deviceData = runtime->get_device()->get_private_data<DeviceDataContainer>();
 
+    if (deviceData.current_runtime == runtime) {
+        uiData.AssignPreferredGroupTechniques(data.allTechniques, data.allSortedTechniques);
+    }
+}
+
+void TechniqueManager::ClearTechniques(RuntimeDataContainer& data) {
     data.allEnabledTechniques.clear();
     data.allTechniques.clear();
     data.allSortedTechniques.clear();
+    data.allTimedTechniques.clear();
+    data.allScreenshotExcludedTechniques.clear();
+}
+
+void TechniqueManager::AddTechnique(RuntimeDataContainer& data, const std::string& key, EffectData&& effect) {
+    const auto& it = data.allTechniques.emplace(key, effect);
+    EffectData* eff = &it.first->second;
+
+    eff->index = static_cast<uint32_t>(data.allSortedTechniques.size());
+    data.allSortedTechniques.push_back(eff);
+
+    if (eff->enabled) {
+        data.allEnabledTechniques.set(eff->index);
+    }
+
+    if (eff->timeout >= 0) {
+        data.allTimedTechniques.push_back(eff);
+    }
+
+    if (!eff->enabled_in_screenshot) {
+        data.allScreenshotExcludedTechniques.push_back(eff);
+    }
+}
+
+void TechniqueManager::OnReshadeReloadedEffects(reshade::api::effect_runtime* runtime) {
+    RuntimeDataContainer& data = runtime->get_private_data<RuntimeDataContainer>();
+    unique_lock<shared_mutex> lock(data.technique_mutex);
+
+    ClearTechniques(data);
 
     Rendering::RenderingManager::EnumerateTechniques(
       runtime, [&data, this](effect_runtime* runtime, effect_technique technique, string& name, string& eff_name) {
@@ -56,14 +107,11 @@ void TechniqueManager::OnReshadeReloadedEffects(reshade::api::effect_runtime* ru
               return;
           }
 
-          const auto& it = data.allTechniques.emplace(name + " [" + eff_name + "]", EffectData{ technique, runtime, enabled });
-          data.allSortedTechniques.push_back(&it.first->second);
-
-          if (enabled) {
-              data.allEnabledTechniques.emplace(&it.first->second);
-          }
+          AddTechnique(data, name + " [" + eff_name + "]", EffectData{ technique, runtime, enabled });
       });
 
+    RebuildGroupSchedules(runtime, data);
+
     int32_t enabledCount = static_cast<int32_t>(data.allTechniques.size());
 
     if (enabledCount == 0 || enabledCount < data.previousEnableCount) {
@@ -105,15 +153,13 @@ bool TechniqueManager::OnReshadeSetTechniqueState(reshade::api::effect_runtime*
     it->second.enabled = enabled;
 
     if (!enabled) {
-        if (data.allEnabledTechniques.contains(&it->second)) {
-            data.allEnabledTechniques.erase(&it->second);
-        }
+        data.allEnabledTechniques.reset(it->second.index);
     } else {
-        if (data.allEnabledTechniques.find(&it->second) == data.allEnabledTechniques.end()) {
-            data.allEnabledTechniques.emplace(&it->second);
-        }
+        data.allEnabledTechniques.set(it->second.index);
     }
 
+    UpdateGroupSchedules(runtime, &it->second);
+
     return false;
 }
 
@@ -121,9 +167,7 @@ bool TechniqueManager::OnReshadeReorderTechniques(reshade::api::effect_runtime*
     RuntimeDataContainer& data = runtime->get_private_data<RuntimeDataContainer>();
     unique_lock<shared_mutex> lock(data.technique_mutex);
 
-    data.allEnabledTechniques.clear();
-    data.allTechniques.clear();
-    data.allSortedTechniques.clear();
+    ClearTechniques(data);
 
     for (uint32_t i = 0; i < count; i++) {
         effect_technique technique = techniques[i];
@@ -154,14 +198,11 @@ bool TechniqueManager::OnReshadeReorderTechniques(reshade::api::effect_runtime*
             continue;
         }
 
-        const auto& it = data.allTechniques.emplace(effKey, EffectData{ technique, runtime, enabled });
-        data.allSortedTechniques.push_back(&it.first->second);
-
-        if (enabled) {
-            data.allEnabledTechniques.emplace(&it.first->second);
-        }
+        AddTechnique(data, effKey, EffectData{ technique, runtime, enabled });
     }
 
+    RebuildGroupSchedules(runtime, data);
+
     return false;
 }
 
@@ -169,24 +210,24 @@ void TechniqueManager::OnReshadePresent(reshade::api::effect_runtime* runtime) {
     RuntimeDataContainer& deviceData = runtime->get_private_data<RuntimeDataContainer>();
     unique_lock<shared_mutex> lock(deviceData.technique_mutex);
 
-    for (auto el = deviceData.allEnabledTechniques.begin(); el != deviceData.allEnabledTechniques.end();) {
-        EffectData const* eff = *el;
+    // Advancing the epoch releases all claims of the previous frame at once
+    const uint64_t epoch = deviceData.frameEpoch.fetch_add(1, std::memory_order_acq_rel) + 1;
 
-        // Get rid of techniques with a timeout. We don't actually have a timer, so just get rid of them after they were rendered at least once
-        if (eff->timeout >= 0 && eff->technique != 0 &&
+    // Get rid of techniques with a timeout. We don't actually have a timer, so just get rid of them after they were rendered at least once
+    for (const auto& eff : deviceData.allTimedTechniques) {
+        if (deviceData.allEnabledTechniques.test(eff->index) && eff->technique != 0 &&
             std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - eff->timeout_start).count() >= eff->timeout) {
             runtime->set_technique_state(eff->technique, false);
-            el = deviceData.allEnabledTechniques.erase(el);
-            continue;
+            deviceData.allEnabledTechniques.reset(eff->index);
+            eff->enabled = false;
+            UpdateGroupSchedules(runtime, eff);
         }
+    }
 
-        // Prevent effects that are not supposed to be in screenshots from being rendered when ReShade is taking a screenshot
-        if (!eff->enabled_in_screenshot && keyMonitor.GetKeyState(KeyMonitor::KEY_SCREEN_SHOT) == KeyState::KET_STATE_PRESSED) {
-            eff->rendered = true;
-        } else {
-            eff->rendered = false;
+    // Prevent effects that are not supposed to be in screenshots from being rendered when ReShade is taking a screenshot by claiming them upfront
+    if (deviceData.allScreenshotExcludedTechniques.size() > 0 && keyMonitor.GetKeyState(KeyMonitor::KEY_SCREEN_SHOT) == KeyState::KET_STATE_PRESSED) {
+        for (const auto& eff : deviceData.allScreenshotExcludedTechniques) {
+            eff->Claim(epoch);
         }
-
-        el++;
     }
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "AddonUIData.h"
 #include "KeyMonitor.h"
 #include "PipelinePrivateData.h"
 #include "RenderingManager.h"
@@ -10,7 +11,7 @@
 namespace ShaderToggler {
 class __declspec(novtable) TechniqueManager final {
   public:
-    TechniqueManager(ShaderToggler::KeyMonitor& keyMonitor);
+    TechniqueManager(ShaderToggler::KeyMonitor& keyMonitor, AddonImGui::AddonUIData& data);
 
     void OnReshadeReloadedEffects(reshade::api::effect_runtime* runtime);
     bool OnReshadeSetTechniqueState(reshade::api::effect_runtime* runtime, reshade::api::effect_technique technique, bool enabled);
@@ -23,7 +24,23 @@ class __declspec(novtable) TechniqueManager final {
     void SignalEffectsReloaded(reshade::api::effect_runtime* runtime);
 
   private:
+    static void ClearTechniques(RuntimeDataContainer& data);
+    /// <summary>
+    /// Stores the technique under key and registers it in the sorted, enabled, timed and screenshot exclusion lists.
+    /// </summary>
+    static void AddTechnique(RuntimeDataContainer& data, const std::string& key, EffectData&& effect);
+    /// <summary>
+    /// Adds/removes a single technique to/from the schedule of every group after its enabled state changed. Groups only ever schedule techniques
+    /// of the device's current runtime, state changes on any other runtime are ignored.
+    /// </summary>
+    void UpdateGroupSchedules(reshade::api::effect_runtime* runtime, EffectData* effect);
+    /// <summary>
+    /// Rebuilds all group schedules after the techniques of the runtime have been re-enumerated. Has to be called with the technique_mutex held.
+    /// </summary>
+    void RebuildGroupSchedules(reshade::api::effect_runtime* runtime, RuntimeDataContainer& data);
+
     KeyMonitor& keyMonitor;
+    AddonImGui::AddonUIData& uiData;
     std::vector<std::function<void(reshade::api::effect_runtime*)>> effectsReloadingCallback;
     std::vector<std::function<void(reshade::api::effect_runtime*)>> effectsReloadedCallback;
 
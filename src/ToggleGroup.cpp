@@ -32,7 +32,10 @@
 
 #include "ToggleGroup.h"
 #include "stdafx.h"
+#include <algorithm>
+#include <mutex>
 #include <sstream>
+#include <vector>
 
 using namespace std;
 
@@ -83,6 +86,7 @@ ToggleGroup::ToggleGroup()
 ToggleGroup::ToggleGroup(const ToggleGroup& other)
   : ToggleGroup() {
     _id = other._id;
+    _index = other._index;
     _name = other._name;
     _keybind = other._keybind;
     _vertexShaderHashes = other._vertexShaderHashes;
@@ -119,7 +123,9 @@ ToggleGroup::ToggleGroup(const ToggleGroup& other)
     _textureBindingName = other._textureBindingName;
     _preferredTechniques = other._preferredTechniques;
     _preferredTechniqueData = other._preferredTechniqueData;
+    _scheduledTechniques = other._scheduledTechniques;
     _varOffsetMapping = other._varOffsetMapping;
+    _varMappingVersion++;
     _cbCycle = other._cbCycle;
     _srvCycle = other._srvCycle;
     _rtCycle = other._rtCycle;
@@ -129,7 +135,8 @@ ToggleGroup::ToggleGroup(const ToggleGroup& other)
     _renderSrvSlotIndex = other._renderSrvSlotIndex;
 }
 
-void ToggleGroup::AssignPreferredTechniqueData(std::unordered_map<std::string, EffectData>& allTechniques) {
+void ToggleGroup::AssignPreferredTechniqueData(std::unordered_map<std::string, EffectData>& allTechniques,
+                                               const std::vector<EffectData*>& allSortedTechniques) {
     _preferredTechniqueData.clear();
 
     for (auto& techName : _preferredTechniques) {
@@ -138,12 +145,46 @@ void ToggleGroup::AssignPreferredTechniqueData(std::unordered_map<std::string, E
             _preferredTechniqueData.emplace(&techData->second);
         }
     }
+
+    _scheduledTechniques.clear();
+
+    for (const auto& effect : allSortedTechniques) {
+        if (effect->enabled && IsSchedulingTechnique(effect)) {
+            _scheduledTechniques.push_back(effect);
+        }
+    }
 }
 
 const std::unordered_set<EffectData*>& ToggleGroup::GetPreferredTechniqueData() {
     return _preferredTechniqueData;
 }
 
+bool ToggleGroup::IsSchedulingTechnique(EffectData* effect) const {
+    if (_allowAllTechniques) {
+        return !_hasTechniqueExceptions || !_preferredTechniqueData.contains(effect);
+    }
+
+    return _preferredTechniqueData.contains(effect);
+}
+
+void ToggleGroup::ScheduleTechnique(EffectData* effect) {
+    const auto& it = std::lower_bound(
+      _scheduledTechniques.begin(), _scheduledTechniques.end(), effect, [](const EffectData* lhs, const EffectData* rhs) { return lhs->index < rhs->index; });
+
+    if (it == _scheduledTechniques.end() || *it != effect) {
+        _scheduledTechniques.insert(it, effect);
+    }
+}
+
+void ToggleGroup::UnscheduleTechnique(EffectData* effect) {
+    const auto& it = std::lower_bound(
+      _scheduledTechniques.begin(), _scheduledTechniques.end(), effect, [](const EffectData* lhs, const EffectData* rhs) { return lhs->index < rhs->index; });
+
+    if (it != _scheduledTechniques.end() && *it == effect) {
+        _scheduledTechniques.erase(it);
+    }
+}
+
 int ToggleGroup::getNewGroupId() {
     static atomic_int s_groupId = 0;
 
@@ -151,6 +192,32 @@ int ToggleGroup::getNewGroupId() {
     return s_groupId;
 }
 
+static mutex s_groupIndexMutex;
+static vector<bool> s_groupIndicesInUse;
+
+uint32_t ToggleGroup::acquireGroupIndex() {
+    unique_lock<mutex> lock(s_groupIndexMutex);
+
+    auto it = std::find(s_groupIndicesInUse.begin(), s_groupIndicesInUse.end(), false);
+    const uint32_t index = static_cast<uint32_t>(std::distance(s_groupIndicesInUse.begin(), it));
+
+    if (it == s_groupIndicesInUse.end()) {
+        s_groupIndicesInUse.push_back(true);
+    } else {
+        s_groupIndicesInUse[index] = true;
+    }
+
+    return index;
+}
+
+void ToggleGroup::releaseGroupIndex(uint32_t index) {
+    unique_lock<mutex> lock(s_groupIndexMutex);
+
+    if (index < s_groupIndicesInUse.size()) {
+        s_groupIndicesInUse[index] = false;
+    }
+}
+
 GroupResource& ToggleGroup::GetGroupResource(GroupResourceType type) {
     return _group_buffers[static_cast<uint32_t>(type)];
 }
@@ -198,14 +265,16 @@ void ToggleGroup::setName(string newName) {
     _name = newName;
 }
 
-bool ToggleGroup::SetVarMapping(uintptr_t offset, string& variable, bool prev) {
-    _varOffsetMapping.emplace(variable, make_tuple(offset, prev));
+bool ToggleGroup::SetVarMapping(uintptr_t offset, string& variable, uint32_t framesBack) {
+    _varOffsetMapping.emplace(variable, make_tuple(offset, framesBack));
+    _varMappingVersion++;
 
     return true; // do some sanity checking?
 }
 
 bool ToggleGroup::RemoveVarMapping(string& variable) {
     _varOffsetMapping.erase(variable);
+    _varMappingVersion++;
 
     return true; // do some sanity checking?
 }
@@ -240,10 +309,11 @@ void ToggleGroup::saveState(CDataFile& iniFile, int groupCounter) const {
 
     counter = 0;
     for (const auto& [varName, varData] : _varOffsetMapping) {
-        const auto& [varOffset, varUsePref] = varData;
+        const auto& [varOffset, varFramesBack] = varData;
         iniFile.SetUInt("Offset" + std::to_string(counter), static_cast<uint32_t>(varOffset), "", constantsCategory);
         iniFile.SetValue("Variable" + std::to_string(counter), varName, "", constantsCategory);
-        iniFile.SetBool("UsePreviousValue" + std::to_string(counter), varUsePref, "", constantsCategory);
+        iniFile.SetBool("UsePreviousValue" + std::to_string(counter), varFramesBack > 0, "", constantsCategory);
+        iniFile.SetUInt("PreviousValueFrames" + std::to_string(counter), varFramesBack, "", constantsCategory);
         counter++;
     }
     iniFile.SetUInt("AmountConstants", counter, "", constantsCategory);
@@ -380,11 +450,16 @@ void ToggleGroup::loadState(CDataFile& iniFile, int groupCounter) {
     for (int i = 0; i < amountConstants; i++) {
         uint32_t offset = iniFile.GetUInt("Offset" + std::to_string(i), constantsCategory);
         string varName = iniFile.GetString("Variable" + std::to_string(i), constantsCategory);
-        bool prevValue = iniFile.GetBool("UsePreviousValue" + std::to_string(i), constantsCategory);
+        uint32_t framesBack = iniFile.GetUInt("PreviousValueFrames" + std::to_string(i), constantsCategory);
+        // Older configurations only know the previous value
+        if (framesBack == UINT_MAX) {
+            framesBack = iniFile.GetBool("UsePreviousValue" + std::to_string(i), constantsCategory) ? 1 : 0;
+        }
         if (offset != UINT_MAX && varName.size() > 0) {
-            _varOffsetMapping.emplace(varName, make_tuple(offset, prevValue));
+            _varOffsetMapping.emplace(varName, make_tuple(offset, framesBack));
         }
     }
+    _varMappingVersion++;
 
     _name = iniFile.GetValue("Name", sectionRoot);
     if (_name.size() <= 0) {
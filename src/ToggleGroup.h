@@ -36,6 +36,7 @@
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 #include <imgui.h>
 #include "CDataFile.h"
 #include "EffectData.h"
@@ -85,6 +86,11 @@ class ToggleGroup {
     ToggleGroup(const ToggleGroup& other);
 
     static int getNewGroupId();
+    /// <summary>
+    /// Hands out the lowest free dense index. Dense indices are reused after releaseGroupIndex, unlike group ids, so they can address bitsets.
+    /// </summary>
+    static uint32_t acquireGroupIndex();
+    static void releaseGroupIndex(uint32_t index);
 
     void setToggleKey(uint32_t keybind) { _keybind = keybind; }
     void setName(std::string newName);
@@ -117,6 +123,8 @@ class ToggleGroup {
     bool isEditing() { return _isEditing; }
     bool isEmpty() const { return _vertexShaderHashes.size() <= 0 && _pixelShaderHashes.size() <= 0; }
     int getId() const { return _id; }
+    uint32_t getIndex() const { return _index; }
+    void setIndex(uint32_t index) { _index = index; }
     const std::unordered_set<std::string>& preferredTechniques() const { return _preferredTechniques; }
     void setPreferredTechniques(std::unordered_set<std::string>& techniques) { _preferredTechniques = techniques; }
     std::unordered_set<uint32_t> getPixelShaderHashes() const { return _pixelShaderHashes; }
@@ -174,9 +182,12 @@ class ToggleGroup {
     void setRequeueAfterRTMatchingFailure(bool requeue) { _requeueAfterRTMatchingFailure = requeue; }
     bool getCopyTextureBinding() const { return _copyTextureBinding; }
     void setCopyTextureBinding(bool copy) { _copyTextureBinding = copy; }
-    const std::unordered_map<std::string, std::tuple<uintptr_t, bool>>& GetVarOffsetMapping() const { return _varOffsetMapping; }
-    bool SetVarMapping(uintptr_t, std::string&, bool);
+    // Maps a variable to its offset and how many extractions back its value is taken from, 0 being the current one
+    const std::unordered_map<std::string, std::tuple<uintptr_t, uint32_t>>& GetVarOffsetMapping() const { return _varOffsetMapping; }
+    bool SetVarMapping(uintptr_t, std::string&, uint32_t);
     bool RemoveVarMapping(std::string&);
+    // Bumped whenever the variable mapping changes
+    uint32_t getVarMappingVersion() const { return _varMappingVersion; }
     bool getClearPreviewAlpha() const { return _previewClearAlpha; }
     void setClearPreviewAlpha(bool previewClearAlpha) { _previewClearAlpha = previewClearAlpha; }
     bool getToneMap() const { return _tonemapHDRtoSDRtoHDR; }
@@ -214,11 +225,28 @@ class ToggleGroup {
     bool AlphaClear() { return false; }
     bool BindingEnabled() { return _isProvidingTextureBinding && _copyTextureBinding; }
     bool BindingClear() { return _clearBindings; }
-    void AssignPreferredTechniqueData(std::unordered_map<std::string, EffectData>& allTechniques);
+    /// <summary>
+    /// Resolves the preferred technique names against allTechniques and rebuilds the technique schedule from the enabled techniques.
+    /// </summary>
+    void AssignPreferredTechniqueData(std::unordered_map<std::string, EffectData>& allTechniques, const std::vector<EffectData*>& allSortedTechniques);
     const std::unordered_set<EffectData*>& GetPreferredTechniqueData();
+    /// <summary>
+    /// True if the technique is rendered by this group while it's enabled, according to the allow all/exception/preferred settings.
+    /// </summary>
+    bool IsSchedulingTechnique(EffectData* effect) const;
+    /// <summary>
+    /// Adds/removes a single technique to/from the schedule, keeping it in EffectData::index order.
+    /// </summary>
+    void ScheduleTechnique(EffectData* effect);
+    void UnscheduleTechnique(EffectData* effect);
+    /// <summary>
+    /// The enabled techniques this group renders, in rendering order.
+    /// </summary>
+    const std::vector<EffectData*>& GetScheduledTechniques() const { return _scheduledTechniques; }
 
   private:
     int _id;
+    uint32_t _index = 0;
     std::string _name;
     uint32_t _keybind;
     std::unordered_set<uint32_t> _vertexShaderHashes;
@@ -259,7 +287,9 @@ class ToggleGroup {
     std::string _textureBindingName;
     std::unordered_set<std::string> _preferredTechniques;
     std::unordered_set<EffectData*> _preferredTechniqueData;
-    std::unordered_map<std::string, std::tuple<uintptr_t, bool>> _varOffsetMapping;
+    std::vector<EffectData*> _scheduledTechniques;
+    std::unordered_map<std::string, std::tuple<uintptr_t, uint32_t>> _varOffsetMapping;
+    uint32_t _varMappingVersion = 0;
     DescriptorCycle _cbCycle;
     DescriptorCycle _srvCycle;
     DescriptorCycle _rtCycle;
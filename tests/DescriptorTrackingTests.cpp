@@ -0,0 +1,226 @@
+#include "DescriptorTracking.h"
+#include "MockDevice.h"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace reshade::api;
+using namespace ShaderToggler::Tests;
+
+namespace {
+// descriptor_tracking is used directly, none of its event handlers are registered
+class DescriptorTrackingTest : public ::testing::Test {
+  protected:
+    void UpdateViews(uint32_t heap, uint32_t offset, const std::vector<resource_view>& views, descriptor_type type = descriptor_type::shader_resource_view) {
+        descriptor_table_update update;
+        update.table = MockDevice::MakeTable(heap, offset);
+        update.count = static_cast<uint32_t>(views.size());
+        update.type = type;
+        update.descriptors = views.data();
+        tracking.update_descriptors(&device, 1, &update);
+    }
+
+    MockDevice device;
+    descriptor_tracking tracking;
+};
+
+std::vector<resource_view> MakeViews(uint64_t first, uint32_t count) {
+    std::vector<resource_view> views(count);
+    for (uint32_t i = 0; i < count; i++) {
+        views[i] = { first + i };
+    }
+    return views;
+}
+}
+
+TEST_F(DescriptorTrackingTest, UnknownHeapReturnsNull) {
+    EXPECT_EQ(tracking.get_shader_resource_view({ 1 }, 0).handle, 0u);
+    EXPECT_EQ(tracking.get_sampler({ 1 }, 0).handle, 0u);
+    EXPECT_EQ(tracking.get_buffer_range({ 1 }, 0).buffer.handle, 0u);
+}
+
+TEST_F(DescriptorTrackingTest, UpdateIsVisibleAtHeapOffset) {
+    UpdateViews(1, 10, MakeViews(100, 4));
+
+    for (uint32_t i = 0; i < 4; i++) {
+        EXPECT_EQ(tracking.get_shader_resource_view({ 1 }, 10 + i).handle, 100u + i);
+        EXPECT_EQ(tracking.get_sampler({ 1 }, 10 + i).handle, 0u);
+    }
+
+    // Neighbours in the same chunk were never written
+    EXPECT_EQ(tracking.get_shader_resource_view({ 1 }, 9).handle, 0u);
+    EXPECT_EQ(tracking.get_shader_resource_view({ 1 }, 14).handle, 0u);
+    // Other heaps are separate
+    EXPECT_EQ(tracking.get_shader_resource_view({ 2 }, 10).handle, 0u);
+}
+
+TEST_F(DescriptorTrackingTest, UpdateAcrossChunkBoundary) {
+    // Chunks hold 4096 descriptors
+    UpdateViews(1, 4090, MakeViews(200, 16));
+
+    for (uint32_t i = 0; i < 16; i++) {
+        EXPECT_EQ(tracking.get_shader_resource_view({ 1 }, 4090 + i).handle, 200u + i);
+    }
+}
+
+TEST_F(DescriptorTrackingTest, OffsetsBeyondMirroredRangeAreIgnored) {
+    // 1024 chunks of 4096 descriptors are mirrored per heap
+    constexpr uint32_t limit = 1024 * 4096;
+    UpdateViews(1, limit - 2, MakeViews(300, 4));
+
+    EXPECT_EQ(tracking.get_shader_resource_view({ 1 }, limit - 2).handle, 300u);
+    EXPECT_EQ(tracking.get_shader_resource_view({ 1 }, limit - 1).handle, 301u);
+    EXPECT_EQ(tracking.get_shader_resource_view({ 1 }, limit).handle, 0u);
+}
+
+TEST_F(DescriptorTrackingTest, DescriptorTypesResolveToTheirGetters) {
+    const sampler_with_resource_view combined[] = { { { 7 }, { 8 } } };
+    descriptor_table_update update;
+    update.table = MockDevice::MakeTable(1, 0);
+    update.count = 1;
+    update.type = descriptor_type::sampler_with_resource_view;
+    update.descriptors = combined;
+    tracking.update_descriptors(&device, 1, &update);
+
+    const buffer_range ranges[] = { { { 9 }, 16, 64 } };
+    update.table = MockDevice::MakeTable(1, 1);
+    update.type = descriptor_type::constant_buffer;
+    update.descriptors = ranges;
+    tracking.update_descriptors(&device, 1, &update);
+
+    EXPECT_EQ(tracking.get_sampler({ 1 }, 0).handle, 7u);
+    EXPECT_EQ(tracking.get_shader_resource_view({ 1 }, 0).handle, 8u);
+    EXPECT_EQ(tracking.get_buffer_range({ 1 }, 0).buffer.handle, 0u);
+
+    const buffer_range range = tracking.get_buffer_range({ 1 }, 1);
+    EXPECT_EQ(range.buffer.handle, 9u);
+    EXPECT_EQ(range.offset, 16u);
+    EXPECT_EQ(range.size, 64u);
+    EXPECT_EQ(tracking.get_shader_resource_view({ 1 }, 1).handle, 0u);
+}
+
+TEST_F(DescriptorTrackingTest, CopyBetweenHeaps) {
+    UpdateViews(1, 0, MakeViews(100, 8));
+
+    descriptor_table_copy copy;
+    copy.source_table = MockDevice::MakeTable(1, 2);
+    copy.dest_table = MockDevice::MakeTable(2, 4094);
+    copy.count = 4;
+    tracking.copy_descriptors(&device, 1, &copy);
+
+    for (uint32_t i = 0; i < 4; i++) {
+        EXPECT_EQ(tracking.get_shader_resource_view({ 2 }, 4094 + i).handle, 102u + i);
+    }
+    EXPECT_EQ(tracking.get_shader_resource_view({ 2 }, 4098).handle, 0u);
+}
+
+TEST_F(DescriptorTrackingTest, CopyFromUntrackedSourceClearsDestination) {
+    UpdateViews(2, 0, MakeViews(100, 4));
+
+    descriptor_table_copy copy;
+    copy.source_table = MockDevice::MakeTable(1, 0);
+    copy.dest_table = MockDevice::MakeTable(2, 1);
+    copy.count = 2;
+    tracking.copy_descriptors(&device, 1, &copy);
+
+    EXPECT_EQ(tracking.get_shader_resource_view({ 2 }, 0).handle, 100u);
+    EXPECT_EQ(tracking.get_shader_resource_view({ 2 }, 1).handle, 0u);
+    EXPECT_EQ(tracking.get_shader_resource_view({ 2 }, 2).handle, 0u);
+    EXPECT_EQ(tracking.get_shader_resource_view({ 2 }, 3).handle, 103u);
+}
+
+TEST_F(DescriptorTrackingTest, SetAllDescriptorsSkipsUnwrittenChunks) {
+    UpdateViews(1, 4094, MakeViews(100, 2));
+
+    std::vector<descriptor_tracking::descriptor_data> list(8);
+    list[7].view = { 999 };
+    tracking.set_all_descriptors({ 1 }, 4092, 4, list.data(), 4);
+
+    EXPECT_EQ(list[6].view.handle, 100u);
+    EXPECT_EQ(list[7].view.handle, 101u);
+    EXPECT_EQ(list[4].view.handle, 0u);
+
+    // The chunk after the last written one doesn't exist, its entries are left alone
+    list[0].view = { 555 };
+    tracking.set_all_descriptors({ 1 }, 4096, 1, list.data(), 0);
+    EXPECT_EQ(list[0].view.handle, 555u);
+}
+
+TEST_F(DescriptorTrackingTest, ConcurrentWritersOnDistinctSlots) {
+    constexpr uint32_t threadCount = 4;
+    constexpr uint32_t perThread = 10000;
+
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < threadCount; t++) {
+        threads.emplace_back([this, t]() {
+            for (uint32_t i = 0; i < perThread; i++) {
+                const resource_view view = { 1 + t * perThread + i };
+                descriptor_table_update update;
+                update.table = MockDevice::MakeTable(1 + (i & 1), t * perThread + i);
+                update.count = 1;
+                update.type = descriptor_type::shader_resource_view;
+                update.descriptors = &view;
+                tracking.update_descriptors(&device, 1, &update);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    for (uint32_t slot = 0; slot < threadCount * perThread; slot++) {
+        ASSERT_EQ(tracking.get_shader_resource_view({ 1 + (slot % perThread & 1) }, slot).handle, 1u + slot);
+    }
+}
+
+TEST_F(DescriptorTrackingTest, CopySpanningSeveralChunks) {
+    UpdateViews(1, 100, MakeViews(1000, 10000));
+
+    descriptor_table_copy copy;
+    copy.source_table = MockDevice::MakeTable(1, 100);
+    copy.dest_table = MockDevice::MakeTable(2, 4000);
+    copy.count = 10000;
+    tracking.copy_descriptors(&device, 1, &copy);
+
+    for (uint32_t i = 0; i < 10000; i++) {
+        ASSERT_EQ(tracking.get_shader_resource_view({ 2 }, 4000 + i).handle, 1000u + i);
+    }
+    EXPECT_EQ(tracking.get_shader_resource_view({ 2 }, 3999).handle, 0u);
+    EXPECT_EQ(tracking.get_shader_resource_view({ 2 }, 14000).handle, 0u);
+}
+
+TEST_F(DescriptorTrackingTest, CopyFromPartiallyWrittenSource) {
+    // Only the second source chunk exists, the run out of the first one clears its part of the destination
+    UpdateViews(1, 4096, MakeViews(500, 8));
+    UpdateViews(2, 0, MakeViews(900, 16));
+
+    descriptor_table_copy copy;
+    copy.source_table = MockDevice::MakeTable(1, 4092);
+    copy.dest_table = MockDevice::MakeTable(2, 0);
+    copy.count = 8;
+    tracking.copy_descriptors(&device, 1, &copy);
+
+    for (uint32_t i = 0; i < 4; i++) {
+        EXPECT_EQ(tracking.get_shader_resource_view({ 2 }, i).handle, 0u);
+        EXPECT_EQ(tracking.get_shader_resource_view({ 2 }, 4 + i).handle, 500u + i);
+    }
+    EXPECT_EQ(tracking.get_shader_resource_view({ 2 }, 8).handle, 908u);
+}
+
+TEST_F(DescriptorTrackingTest, SamplerUpdateAcrossChunkBoundary) {
+    std::vector<sampler> samplers(8);
+    for (uint32_t i = 0; i < samplers.size(); i++) {
+        samplers[i] = { 50u + i };
+    }
+
+    descriptor_table_update update;
+    update.table = MockDevice::MakeTable(1, 4092);
+    update.count = static_cast<uint32_t>(samplers.size());
+    update.type = descriptor_type::sampler;
+    update.descriptors = samplers.data();
+    tracking.update_descriptors(&device, 1, &update);
+
+    for (uint32_t i = 0; i < samplers.size(); i++) {
+        EXPECT_EQ(tracking.get_sampler({ 1 }, 4092 + i).handle, 50u + i);
+    }
+}
@@ -0,0 +1,187 @@
+#include "AddonUIData.h"
+#include "MockDevice.h"
+#include "PipelinePrivateData.h"
+#include "RenderingEffectManager.h"
+#include "RenderingQueueManager.h"
+#include "RenderingShaderManager.h"
+#include "ResourceManager.h"
+#include "StateTracking.h"
+#include "ToggleGroupResourceManager.h"
+#include <atomic>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <new>
+
+using namespace reshade::api;
+using namespace ShaderToggler;
+using namespace ShaderToggler::Tests;
+
+// Counts every heap allocation of the test executable, the tests only look at the difference over the calls they make
+static std::atomic_uint64_t g_allocations = 0;
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (void* p = std::malloc(size > 0 ? size : 1)) {
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+constexpr uint32_t EFFECTS = 6;
+constexpr uint32_t MATCHED_HASH = 0x1234;
+constexpr uint32_t OTHER_HASH = 0x5678;
+
+// The rendering and queue managers the bind, draw and present handlers in Main.cpp drive, with two active groups scheduling three techniques
+// each. The command list renders to a back buffer sized target, so every technique is rendered once per frame.
+class HotPathAllocationTest : public ::testing::Test {
+  protected:
+    HotPathAllocationTest()
+      : device(device_api::d3d12)
+      , runtime(&device)
+      , cmdList(&device)
+      , uiData(nullptr, nullptr, nullptr, nullptr, &collectorFrameCounter)
+      , shaderManager(uiData, resourceManager)
+      , effectManager(uiData, resourceManager, shaderManager, groupResourceManager)
+      , queueManager(uiData, resourceManager) {}
+
+    void SetUp() override {
+        deviceData = &device.create_private_data<DeviceDataContainer>();
+        deviceData->current_runtime = &runtime;
+        runtimeData = &runtime.create_private_data<RuntimeDataContainer>();
+        cmdData = &cmdList.create_private_data<CommandListDataContainer>();
+        state_tracking& state = cmdList.create_private_data<state_tracking>();
+        state.device = &device;
+        state.api = device.get_api();
+
+        resource target = {};
+        resource_view targetView = {};
+        device.create_resource(resource_desc(1920, 1080, 1, 1, format::r8g8b8a8_unorm, 1, memory_heap::gpu_only, resource_usage::render_target),
+                               nullptr,
+                               resource_usage::render_target,
+                               &target);
+        device.create_resource_view(target, resource_usage::render_target, resource_view_desc(format::r8g8b8a8_unorm), &targetView);
+        state.render_targets = { targetView };
+
+        for (uint32_t i = 0; i < EFFECTS; i++) {
+            effects[i].technique = { 0x100u + i };
+            effects[i].enabled = true;
+            effects[i].index = i;
+            runtimeData->allSortedTechniques.push_back(&effects[i]);
+        }
+
+        for (uint32_t g = 0; g < 2; g++) {
+            groups[g].setIndex(g);
+            groups[g].toggleActive();
+
+            for (uint32_t i = g; i < EFFECTS; i += 2) {
+                groups[g].ScheduleTechnique(&effects[i]);
+            }
+
+            matchedGroups.push_back(&groups[g]);
+        }
+    }
+
+    void TearDown() override {
+        cmdList.destroy_private_data<state_tracking>();
+        cmdList.destroy_private_data<CommandListDataContainer>();
+        runtime.destroy_private_data<RuntimeDataContainer>();
+        device.destroy_private_data<DeviceDataContainer>();
+    }
+
+    // What onBindPipeline does for a pixel shader, with the matched groups as the dispatch record's group list
+    void BindPixelShader(uint32_t hash) {
+        uint64_t pipelineChanged = 0;
+
+        if (cmdData->ps.activeShaderHash != hash) {
+            pipelineChanged = Rendering::MATCH_EFFECT_PS | Rendering::MATCH_BINDING_PS | Rendering::MATCH_PREVIEW_PS | Rendering::MATCH_CONST_PS;
+            cmdData->ps.constantBuffersToUpdate.clear();
+        }
+
+        cmdData->ps.blockedShaderGroups = hash == MATCHED_HASH ? &matchedGroups : nullptr;
+        cmdData->ps.activeShaderHash = hash;
+
+        if (pipelineChanged > 0) {
+            if (cmdData->commandQueue & Rendering::CHECK_MATCH_BIND_PIPELINE_EFFECT && !(cmdData->commandQueue & pipelineChanged & Rendering::MATCH_EFFECT)) {
+                effectManager.RenderEffects(&cmdList, Rendering::CALL_BIND_PIPELINE, pipelineChanged & Rendering::MATCH_EFFECT);
+            }
+
+            queueManager.ClearQueue(*cmdData, pipelineChanged);
+            queueManager.CheckCallForCommandList(&cmdList);
+        }
+    }
+
+    // What CheckDrawCall does for a draw
+    void Draw() {
+        const uint64_t matchModifier = Rendering::MATCH_PS | Rendering::MATCH_VS;
+
+        if (cmdData->commandQueue & Rendering::MATCH_EFFECT & matchModifier) {
+            effectManager.RenderEffects(&cmdList, Rendering::CALL_DRAW, Rendering::MATCH_EFFECT & matchModifier);
+        }
+    }
+
+    // Two passes with a matched and an unmatched shader each, then the per present epoch advance
+    void Frame() {
+        for (uint32_t pass = 0; pass < 2; pass++) {
+            BindPixelShader(MATCHED_HASH);
+            Draw();
+            Draw();
+            BindPixelShader(OTHER_HASH);
+            Draw();
+        }
+
+        runtimeData->frameEpoch.fetch_add(1);
+        deviceData->rendered_effects = false;
+    }
+
+    MockDevice device;
+    MockEffectRuntime runtime;
+    MockCommandList cmdList;
+    std::atomic_uint32_t collectorFrameCounter = 0;
+    AddonImGui::AddonUIData uiData;
+    Rendering::ResourceManager resourceManager;
+    Rendering::ToggleGroupResourceManager groupResourceManager;
+    Rendering::RenderingShaderManager shaderManager;
+    Rendering::RenderingEffectManager effectManager;
+    Rendering::RenderingQueueManager queueManager;
+
+    EffectData effects[EFFECTS];
+    ToggleGroup groups[2] = { ToggleGroup("first", 0), ToggleGroup("second", 1) };
+    std::vector<ToggleGroup*> matchedGroups;
+    DeviceDataContainer* deviceData = nullptr;
+    RuntimeDataContainer* runtimeData = nullptr;
+    CommandListDataContainer* cmdData = nullptr;
+};
+}
+
+TEST_F(HotPathAllocationTest, EveryTechniqueRendersOncePerFrame) {
+    for (uint32_t frame = 1; frame <= 4; frame++) {
+        Frame();
+        EXPECT_EQ(runtime.techniqueRenders, frame * EFFECTS);
+    }
+}
+
+TEST_F(HotPathAllocationTest, SteadyStateBindsAndDrawsDontAllocate) {
+    // The first frames create the resource views of the render target and settle the queues
+    for (uint32_t frame = 0; frame < 4; frame++) {
+        Frame();
+    }
+
+    const uint64_t rendered = runtime.techniqueRenders;
+    const uint64_t allocations = g_allocations.load();
+
+    for (uint32_t frame = 0; frame < 64; frame++) {
+        Frame();
+    }
+
+    EXPECT_EQ(g_allocations.load() - allocations, 0u);
+    EXPECT_EQ(runtime.techniqueRenders - rendered, 64u * EFFECTS);
+}
@@ -0,0 +1,412 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <reshade.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ShaderToggler::Tests {
+/// <summary>
+/// Private data storage shared by all mock objects, keyed by the address of the type tag standing in for the GUID.
+/// </summary>
+template<typename Base>
+class MockObject : public Base {
+  public:
+    bool get_private_data(const uint8_t guid[16], uint64_t* data) const override {
+        const auto& it = _privateData.find(guid);
+        *data = it != _privateData.end() ? it->second : 0;
+        return it != _privateData.end();
+    }
+    void set_private_data(const uint8_t guid[16], const uint64_t data) override { _privateData[guid] = data; }
+    uint64_t get_native() const override { return reinterpret_cast<uintptr_t>(this); }
+
+  private:
+    std::unordered_map<const uint8_t*, uint64_t> _privateData;
+};
+
+/// <summary>
+/// Device which hands out increasing handles and remembers the descriptions objects were created with. Descriptor tables encode their heap in
+/// the upper and their base offset in the lower 32 bits of the handle, see MakeTable.
+/// </summary>
+class MockDevice final : public MockObject<reshade::api::device> {
+  public:
+    explicit MockDevice(reshade::api::device_api api = reshade::api::device_api::d3d12)
+      : _api(api) {}
+
+    static reshade::api::descriptor_table MakeTable(uint32_t heap, uint32_t offset) { return { (static_cast<uint64_t>(heap) << 32) | offset }; }
+
+    reshade::api::device_api get_api() const override { return _api; }
+    bool check_capability(reshade::api::device_caps) const override { return true; }
+    bool check_format_support(reshade::api::format, reshade::api::resource_usage) const override { return true; }
+
+    bool create_sampler(const reshade::api::sampler_desc&, reshade::api::sampler* out_handle) override {
+        out_handle->handle = NextHandle();
+        return true;
+    }
+    void destroy_sampler(reshade::api::sampler) override {}
+
+    bool create_resource(const reshade::api::resource_desc& desc,
+                         const reshade::api::subresource_data*,
+                         reshade::api::resource_usage,
+                         reshade::api::resource* out_handle,
+                         void** = nullptr) override {
+        std::unique_lock<std::mutex> lock(_mutex);
+        out_handle->handle = NextHandle();
+        _resources[out_handle->handle] = desc;
+        if (desc.type == reshade::api::resource_type::buffer) {
+            _bufferData[out_handle->handle].resize(desc.buffer.size);
+        }
+        resourcesCreated++;
+        return true;
+    }
+    void destroy_resource(reshade::api::resource handle) override {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _resources.erase(handle.handle);
+        _bufferData.erase(handle.handle);
+        resourcesDestroyed++;
+    }
+    reshade::api::resource_desc get_resource_desc(reshade::api::resource resource) const override {
+        std::unique_lock<std::mutex> lock(_mutex);
+        const auto& it = _resources.find(resource.handle);
+        return it != _resources.end() ? it->second : reshade::api::resource_desc();
+    }
+
+    bool create_resource_view(reshade::api::resource resource,
+                              reshade::api::resource_usage,
+                              const reshade::api::resource_view_desc& desc,
+                              reshade::api::resource_view* out_handle) override {
+        std::unique_lock<std::mutex> lock(_mutex);
+        out_handle->handle = NextHandle();
+        _views[out_handle->handle] = { resource, desc };
+        return true;
+    }
+    void destroy_resource_view(reshade::api::resource_view handle) override {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _views.erase(handle.handle);
+    }
+    reshade::api::resource get_resource_from_view(reshade::api::resource_view view) const override {
+        std::unique_lock<std::mutex> lock(_mutex);
+        const auto& it = _views.find(view.handle);
+        return it != _views.end() ? it->second.first : reshade::api::resource{ 0 };
+    }
+    reshade::api::resource_view_desc get_resource_view_desc(reshade::api::resource_view view) const override {
+        std::unique_lock<std::mutex> lock(_mutex);
+        const auto& it = _views.find(view.handle);
+        return it != _views.end() ? it->second.second : reshade::api::resource_view_desc();
+    }
+
+    bool map_buffer_region(reshade::api::resource resource, uint64_t offset, uint64_t, reshade::api::map_access, void** out_data) override {
+        std::unique_lock<std::mutex> lock(_mutex);
+        const auto& it = _bufferData.find(resource.handle);
+        if (it == _bufferData.end()) {
+            return false;
+        }
+        *out_data = it->second.data() + offset;
+        return true;
+    }
+    void unmap_buffer_region(reshade::api::resource) override {}
+
+    bool create_pipeline(reshade::api::pipeline_layout, uint32_t, const reshade::api::pipeline_subobject*, reshade::api::pipeline* out_handle) override {
+        out_handle->handle = NextHandle();
+        return true;
+    }
+    void destroy_pipeline(reshade::api::pipeline) override {}
+
+    bool create_pipeline_layout(uint32_t, const reshade::api::pipeline_layout_param*, reshade::api::pipeline_layout* out_handle) override {
+        out_handle->handle = NextHandle();
+        return true;
+    }
+    void destroy_pipeline_layout(reshade::api::pipeline_layout) override {}
+
+    void get_descriptor_heap_offset(reshade::api::descriptor_table table,
+                                    uint32_t binding,
+                                    uint32_t array_offset,
+                                    reshade::api::descriptor_heap* out_heap,
+                                    uint32_t* out_offset) const override {
+        out_heap->handle = table.handle >> 32;
+        *out_offset = static_cast<uint32_t>(table.handle) + binding + array_offset;
+    }
+
+    bool create_fence(uint64_t initial_value, reshade::api::fence_flags, reshade::api::fence* out_handle, void** = nullptr) override {
+        std::unique_lock<std::mutex> lock(_mutex);
+        out_handle->handle = NextHandle();
+        _fences[out_handle->handle] = initial_value;
+        return true;
+    }
+    void destroy_fence(reshade::api::fence handle) override {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _fences.erase(handle.handle);
+    }
+    uint64_t get_completed_fence_value(reshade::api::fence fence) const override {
+        std::unique_lock<std::mutex> lock(_mutex);
+        const auto& it = _fences.find(fence.handle);
+        return it != _fences.end() ? it->second : 0;
+    }
+    // The mock GPU finishes work the moment it is submitted
+    void SignalFence(reshade::api::fence fence, uint64_t value) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _fences[fence.handle] = value;
+    }
+
+    size_t GetLiveResourceCount() const {
+        std::unique_lock<std::mutex> lock(_mutex);
+        return _resources.size();
+    }
+
+    uint64_t resourcesCreated = 0;
+    uint64_t resourcesDestroyed = 0;
+
+  private:
+    uint64_t NextHandle() { return ++_nextHandle; }
+
+    reshade::api::device_api _api;
+    // Handles start high, so they never collide with the small constants tests use for heaps and layouts
+    std::atomic<uint64_t> _nextHandle = 0x10000;
+    mutable std::mutex _mutex;
+    std::unordered_map<uint64_t, reshade::api::resource_desc> _resources;
+    std::unordered_map<uint64_t, std::vector<uint8_t>> _bufferData;
+    std::unordered_map<uint64_t, std::pair<reshade::api::resource, reshade::api::resource_view_desc>> _views;
+    std::unordered_map<uint64_t, uint64_t> _fences;
+};
+
+/// <summary>
+/// Command list which counts the calls made on it and remembers the last bound state. Nothing is executed.
+/// </summary>
+class MockCommandList final : public MockObject<reshade::api::command_list> {
+  public:
+    explicit MockCommandList(MockDevice* device)
+      : _device(device) {}
+
+    reshade::api::device* get_device() override { return _device; }
+
+    void barrier(uint32_t count, const reshade::api::resource*, const reshade::api::resource_usage*, const reshade::api::resource_usage*) override {
+        barriers += count;
+    }
+
+    void begin_render_pass(uint32_t, const reshade::api::render_pass_render_target_desc*, const reshade::api::render_pass_depth_stencil_desc*) override {}
+    void end_render_pass() override {}
+    void bind_render_targets_and_depth_stencil(uint32_t count, const reshade::api::resource_view* rtvs, reshade::api::resource_view dsv = { 0 }) override {
+        renderTargetBinds++;
+        renderTargets.assign(rtvs, rtvs + count);
+        depthStencil = dsv;
+    }
+
+    void bind_pipeline(reshade::api::pipeline_stage, reshade::api::pipeline pipeline) override {
+        pipelineBinds++;
+        lastPipeline = pipeline;
+    }
+    void bind_pipeline_states(uint32_t count, const reshade::api::dynamic_state*, const uint32_t*) override { pipelineStateBinds += count; }
+    void bind_viewports(uint32_t, uint32_t count, const reshade::api::viewport*) override { viewportBinds += count; }
+    void bind_scissor_rects(uint32_t, uint32_t count, const reshade::api::rect*) override { scissorBinds += count; }
+
+    void push_constants(reshade::api::shader_stage, reshade::api::pipeline_layout, uint32_t, uint32_t, uint32_t, const void*) override { constantPushes++; }
+    void push_descriptors(reshade::api::shader_stage, reshade::api::pipeline_layout, uint32_t, const reshade::api::descriptor_table_update&) override {
+        descriptorPushes++;
+    }
+    void bind_descriptor_tables(reshade::api::shader_stage, reshade::api::pipeline_layout, uint32_t, uint32_t, const reshade::api::descriptor_table*) override {
+        descriptorTableBinds++;
+    }
+
+    void bind_index_buffer(reshade::api::resource, uint64_t, uint32_t) override { indexBufferBinds++; }
+    void bind_vertex_buffers(uint32_t, uint32_t count, const reshade::api::resource*, const uint64_t*, const uint32_t*) override { vertexBufferBinds += count; }
+
+    void draw(uint32_t, uint32_t, uint32_t, uint32_t) override { draws++; }
+    void draw_indexed(uint32_t, uint32_t, uint32_t, int32_t, uint32_t) override { draws++; }
+    void dispatch(uint32_t, uint32_t, uint32_t) override { dispatches++; }
+
+    void copy_resource(reshade::api::resource, reshade::api::resource) override { resourceCopies++; }
+    void copy_buffer_region(reshade::api::resource, uint64_t, reshade::api::resource, uint64_t, uint64_t) override { bufferCopies++; }
+
+    void clear_render_target_view(reshade::api::resource_view, const float[4], uint32_t = 0, const reshade::api::rect* = nullptr) override { clears++; }
+
+    /// <summary>
+    /// Calls which put device state back after the add-on rendered something in between the application's draws.
+    /// </summary>
+    uint64_t GetRestoreCalls() const {
+        return renderTargetBinds + pipelineBinds + pipelineStateBinds + viewportBinds + scissorBinds + constantPushes + descriptorPushes + descriptorTableBinds +
+               indexBufferBinds + vertexBufferBinds;
+    }
+    void ResetCounters() {
+        barriers = renderTargetBinds = pipelineBinds = pipelineStateBinds = viewportBinds = scissorBinds = 0;
+        constantPushes = descriptorPushes = descriptorTableBinds = indexBufferBinds = vertexBufferBinds = 0;
+        draws = dispatches = resourceCopies = bufferCopies = clears = 0;
+    }
+
+    uint64_t barriers = 0;
+    uint64_t renderTargetBinds = 0;
+    uint64_t pipelineBinds = 0;
+    uint64_t pipelineStateBinds = 0;
+    uint64_t viewportBinds = 0;
+    uint64_t scissorBinds = 0;
+    uint64_t constantPushes = 0;
+    uint64_t descriptorPushes = 0;
+    uint64_t descriptorTableBinds = 0;
+    uint64_t indexBufferBinds = 0;
+    uint64_t vertexBufferBinds = 0;
+    uint64_t draws = 0;
+    uint64_t dispatches = 0;
+    uint64_t resourceCopies = 0;
+    uint64_t bufferCopies = 0;
+    uint64_t clears = 0;
+
+    std::vector<reshade::api::resource_view> renderTargets;
+    reshade::api::resource_view depthStencil = { 0 };
+    reshade::api::pipeline lastPipeline = { 0 };
+
+  private:
+    MockDevice* _device;
+};
+
+class MockCommandQueue final : public MockObject<reshade::api::command_queue> {
+  public:
+    explicit MockCommandQueue(MockDevice* device)
+      : _device(device)
+      , _immediate(device) {}
+
+    reshade::api::device* get_device() override { return _device; }
+    reshade::api::command_queue_type get_type() const override { return reshade::api::command_queue_type::graphics; }
+    void wait_idle() const override {}
+    void flush_immediate_command_list() const override {}
+    reshade::api::command_list* get_immediate_command_list() override { return &_immediate; }
+
+    bool signal(reshade::api::fence fence, uint64_t value) override {
+        _device->SignalFence(fence, value);
+        return true;
+    }
+    bool wait(reshade::api::fence, uint64_t) override { return true; }
+
+    MockCommandList& GetImmediate() { return _immediate; }
+
+  private:
+    MockDevice* _device;
+    MockCommandList _immediate;
+};
+
+/// <summary>
+/// Effect runtime holding the techniques added with AddTechnique, its back buffer is a single render target of the given size. Technique handles
+/// are the index of the technique plus one.
+/// </summary>
+class MockEffectRuntime final : public MockObject<reshade::api::effect_runtime> {
+  public:
+    MockEffectRuntime(MockDevice* device, uint32_t width = 1920, uint32_t height = 1080)
+      : _device(device)
+      , _queue(device) {
+        device->create_resource(reshade::api::resource_desc(width,
+                                                            height,
+                                                            1,
+                                                            1,
+                                                            reshade::api::format::r8g8b8a8_unorm,
+                                                            1,
+                                                            reshade::api::memory_heap::gpu_only,
+                                                            reshade::api::resource_usage::render_target),
+                                nullptr,
+                                reshade::api::resource_usage::render_target,
+                                &_backBuffer);
+    }
+
+    reshade::api::device* get_device() override { return _device; }
+    void* get_hwnd() const override { return nullptr; }
+    reshade::api::resource get_back_buffer(uint32_t) override { return _backBuffer; }
+    uint32_t get_back_buffer_count() const override { return 1; }
+    uint32_t get_current_back_buffer_index() const override { return 0; }
+    reshade::api::color_space get_color_space() const override { return reshade::api::color_space::srgb_nonlinear; }
+
+    reshade::api::command_queue* get_command_queue() override { return &_queue; }
+    MockCommandQueue& GetQueue() { return _queue; }
+
+    void render_effects(reshade::api::command_list*, reshade::api::resource_view, reshade::api::resource_view = { 0 }) override { effectRenders++; }
+    void render_technique(reshade::api::effect_technique, reshade::api::command_list*, reshade::api::resource_view, reshade::api::resource_view = { 0 }) override {
+        techniqueRenders++;
+    }
+
+    bool get_effects_state() const override { return true; }
+    void set_effects_state(bool) override {}
+
+    void get_screenshot_width_and_height(uint32_t* out_width, uint32_t* out_height) const override {
+        const reshade::api::resource_desc desc = _device->get_resource_desc(_backBuffer);
+        *out_width = desc.texture.width;
+        *out_height = desc.texture.height;
+    }
+
+    bool is_key_down(uint32_t) const override { return false; }
+    bool is_key_pressed(uint32_t) const override { return false; }
+    bool is_key_released(uint32_t) const override { return false; }
+
+    void AddTechnique(const std::string& name, const std::string& effectName, bool enabled) { _techniques.push_back({ name, effectName, enabled }); }
+
+    void enumerate_techniques(const char*, void (*callback)(reshade::api::effect_runtime*, reshade::api::effect_technique, void*), void* user_data) override {
+        for (uint64_t i = 0; i < _techniques.size(); i++) {
+            callback(this, { i + 1 }, user_data);
+        }
+    }
+
+    void get_technique_name(reshade::api::effect_technique technique, char* name, size_t* name_size) const override {
+        const MockTechnique* data = FindTechnique(technique);
+        CopyString(data != nullptr ? data->name.c_str() : "", name, name_size);
+    }
+    void get_technique_effect_name(reshade::api::effect_technique technique, char* effect_name, size_t* effect_name_size) const override {
+        const MockTechnique* data = FindTechnique(technique);
+        CopyString(data != nullptr ? data->effectName.c_str() : "", effect_name, effect_name_size);
+    }
+    bool get_technique_state(reshade::api::effect_technique technique) const override {
+        const MockTechnique* data = FindTechnique(technique);
+        return data != nullptr && data->enabled;
+    }
+    void set_technique_state(reshade::api::effect_technique technique, bool enabled) override {
+        if (technique.handle > 0 && technique.handle <= _techniques.size()) {
+            _techniques[technique.handle - 1].enabled = enabled;
+        }
+    }
+
+    bool get_annotation_bool_from_technique(reshade::api::effect_technique, const char*, bool*, size_t, size_t = 0) const override { return false; }
+    bool get_annotation_int_from_technique(reshade::api::effect_technique, const char*, int32_t*, size_t, size_t = 0) const override { return false; }
+
+    void enumerate_uniform_variables(const char*, void (*)(reshade::api::effect_runtime*, reshade::api::effect_uniform_variable, void*), void*) override {}
+    void get_uniform_variable_type(reshade::api::effect_uniform_variable,
+                                   reshade::api::format* out_base_type,
+                                   uint32_t* = nullptr,
+                                   uint32_t* = nullptr,
+                                   uint32_t* = nullptr) const override {
+        *out_base_type = reshade::api::format::unknown;
+    }
+    bool get_annotation_string_from_uniform_variable(reshade::api::effect_uniform_variable, const char*, char*, size_t*) const override { return false; }
+
+    void set_uniform_value_float(reshade::api::effect_uniform_variable, const float*, size_t, size_t = 0) override {}
+    void set_uniform_value_int(reshade::api::effect_uniform_variable, const int32_t*, size_t, size_t = 0) override {}
+    void set_uniform_value_uint(reshade::api::effect_uniform_variable, const uint32_t*, size_t, size_t = 0) override {}
+
+    void update_texture_bindings(const char*, reshade::api::resource_view, reshade::api::resource_view = { 0 }) override {}
+
+    uint64_t effectRenders = 0;
+    uint64_t techniqueRenders = 0;
+
+  private:
+    struct MockTechnique {
+        std::string name;
+        std::string effectName;
+        bool enabled;
+    };
+
+    const MockTechnique* FindTechnique(reshade::api::effect_technique technique) const {
+        return technique.handle > 0 && technique.handle <= _techniques.size() ? &_techniques[technique.handle - 1] : nullptr;
+    }
+
+    static void CopyString(const char* value, char* out, size_t* out_size) {
+        if (out != nullptr && *out_size > 0) {
+            strncpy(out, value, *out_size - 1);
+            out[*out_size - 1] = '\0';
+        }
+        *out_size = strlen(value) + 1;
+    }
+
+    MockDevice* _device;
+    MockCommandQueue _queue;
+    reshade::api::resource _backBuffer = { 0 };
+    std::vector<MockTechnique> _techniques;
+};
+}
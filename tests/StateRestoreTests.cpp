@@ -0,0 +1,201 @@
+#include "AddonUIData.h"
+#include "MockDevice.h"
+#include "PipelinePrivateData.h"
+#include "RenderingShaderManager.h"
+#include "ResourceManager.h"
+#include "StateTracking.h"
+#include <gtest/gtest.h>
+
+using namespace reshade::api;
+using namespace ShaderToggler::Tests;
+using namespace StateTracking;
+
+namespace {
+constexpr uint32_t PIXEL = 0; // indices into ALL_SHADER_STAGES
+constexpr uint32_t VERTEX = 1;
+constexpr uint32_t COMPUTE = 2;
+
+// Captured state the mock command list starts with: one render target, pixel and vertex shader pipelines, a topology, a viewport, a scissor
+// rect and root tables for the pixel, vertex and compute stages. None of the state tracking event handlers are registered.
+class StateRestoreTest : public ::testing::Test {
+  protected:
+    explicit StateRestoreTest(device_api api)
+      : device(api)
+      , cmdList(&device)
+      , uiData(nullptr, nullptr, nullptr, nullptr, &collectorFrameCounter)
+      , shaderManager(uiData, resourceManager) {}
+
+    void SetUp() override {
+        device.create_private_data<descriptor_tracking>();
+        DeviceDataContainer& deviceData = device.create_private_data<DeviceDataContainer>();
+        deviceData.customShader.copyPipeline = { { 0x500 }, { 0x501 }, { 0x502 } };
+        deviceData.customShader.alphaPreservingCopyPipeline = { { 0x510 }, { 0x511 }, { 0x512 } };
+
+        state = &cmdList.create_private_data<state_tracking>();
+        state->device = &device;
+        state->api = device.get_api();
+
+        state->render_targets = { { 11 } };
+        state->current_pipeline[0] = { 21 };
+        state->current_pipeline_stage[0] = pipeline_stage::pixel_shader;
+        state->current_pipeline[1] = { 22 };
+        state->current_pipeline_stage[1] = pipeline_stage::vertex_shader;
+        state->primitive_topology = primitive_topology::triangle_list;
+        state->viewports = { { 0.0f, 0.0f, 1920.0f, 1080.0f, 0.0f, 1.0f } };
+        state->scissor_rects = { { 0, 0, 1920, 1080 } };
+
+        constant_span constants = state->constant_storage.allocate(4);
+        descriptor_span pushed = state->descriptor_storage.allocate(1);
+        pushed.data[0].type = descriptor_type::shader_resource_view;
+        pushed.data[0].view = { 31 };
+
+        state->root_tables[PIXEL] = { { 0x100 }, { root_entry(descriptor_table{ 41 }), root_entry(constants) } };
+        state->root_table_stages[PIXEL] = shader_stage::pixel;
+        state->root_tables[VERTEX] = { { 0x101 }, { root_entry(descriptor_table{ 42 }) } };
+        state->root_table_stages[VERTEX] = shader_stage::vertex;
+        state->root_tables[COMPUTE] = { { 0x102 }, { root_entry(descriptor_table{ 43 }) } };
+        state->root_table_stages[COMPUTE] = shader_stage::compute;
+
+        if (device.get_api() != device_api::d3d12) {
+            // Outside of D3D12 the first two pixel shader params are restored as push descriptors
+            state->root_tables[PIXEL].second = { root_entry(root_entry_type::push_descriptors, pushed, {}),
+                                                 root_entry(root_entry_type::push_descriptors, pushed, {}) };
+        }
+    }
+
+    void TearDown() override {
+        cmdList.destroy_private_data<state_tracking>();
+        device.destroy_private_data<DeviceDataContainer>();
+        device.destroy_private_data<descriptor_tracking>();
+    }
+
+    // Everything apply restored when it rebound all captured state unconditionally
+    static constexpr uint64_t FULL_RESTORE_D3D12 = 1 + 2 + 1 + 1 + 1 + 3 + 2 + 2; // targets, pipelines, topology, viewport, scissor, ps, vs, cs tables
+
+    MockDevice device;
+    MockCommandList cmdList;
+    std::atomic_uint32_t collectorFrameCounter = 0;
+    AddonImGui::AddonUIData uiData;
+    Rendering::ResourceManager resourceManager;
+    Rendering::RenderingShaderManager shaderManager;
+    state_tracking* state = nullptr;
+};
+
+class StateRestoreD3D12Test : public StateRestoreTest {
+  protected:
+    StateRestoreD3D12Test()
+      : StateRestoreTest(device_api::d3d12) {}
+};
+
+class StateRestoreD3D11Test : public StateRestoreTest {
+  protected:
+    StateRestoreD3D11Test()
+      : StateRestoreTest(device_api::d3d11) {}
+};
+}
+
+TEST_F(StateRestoreD3D12Test, NothingDirtyRestoresNothing) {
+    state->apply(&cmdList);
+
+    EXPECT_EQ(cmdList.GetRestoreCalls(), 0u);
+}
+
+TEST_F(StateRestoreD3D12Test, EffectsMarkEverythingDirty) {
+    // What RenderingEffectManager::_RenderEffects marks before the runtime renders techniques
+    state->mark_dirty(dirty_all, shader_stage::all);
+    state->apply(&cmdList);
+
+    EXPECT_EQ(cmdList.GetRestoreCalls(), FULL_RESTORE_D3D12);
+    EXPECT_EQ(cmdList.renderTargets, state->render_targets);
+
+    // The marks are cleared, a second apply has nothing left to do
+    cmdList.ResetCounters();
+    state->apply(&cmdList);
+
+    EXPECT_EQ(cmdList.GetRestoreCalls(), 0u);
+}
+
+TEST_F(StateRestoreD3D12Test, OnlyMarkedCategoriesAreRestored) {
+    state->mark_dirty(dirty_viewports | dirty_scissor_rects);
+    state->apply(&cmdList);
+
+    EXPECT_EQ(cmdList.viewportBinds, 1u);
+    EXPECT_EQ(cmdList.scissorBinds, 1u);
+    EXPECT_EQ(cmdList.GetRestoreCalls(), 2u);
+
+    // Root signature, table and push constants of the pixel stage only
+    cmdList.ResetCounters();
+    state->mark_dirty(dirty_descriptors, shader_stage::pixel);
+    state->apply(&cmdList);
+
+    EXPECT_EQ(cmdList.descriptorTableBinds, 2u);
+    EXPECT_EQ(cmdList.constantPushes, 1u);
+    EXPECT_EQ(cmdList.GetRestoreCalls(), 3u);
+}
+
+TEST_F(StateRestoreD3D12Test, CopyShaderRestoresGraphicsStagesOnly) {
+    shaderManager.CopyResource(&cmdList, { 51 }, { 52 }, 1920, 1080);
+
+    // Render target, pipeline, two push descriptors, viewport and scissor rect of the copy itself
+    constexpr uint64_t copyCalls = 6;
+    EXPECT_EQ(cmdList.draws, 1u);
+    EXPECT_EQ(cmdList.GetRestoreCalls() - copyCalls, FULL_RESTORE_D3D12 - 2); // the compute root table is left alone
+    EXPECT_EQ(cmdList.renderTargets, state->render_targets);
+    EXPECT_EQ(state->dirty_state, dirty_none);
+}
+
+TEST_F(StateRestoreD3D12Test, PreserveAlphaCopyRestoresMidLoop) {
+    // _RenderEffects with copyPreserveAlpha: mark everything, render techniques, then copy the alpha back, which applies the state itself
+    state->mark_dirty(dirty_all, shader_stage::all);
+    shaderManager.CopyResourceMaskAlpha(&cmdList, { 51 }, { 52 }, 1920, 1080);
+
+    constexpr uint64_t copyCalls = 6;
+    EXPECT_EQ(cmdList.GetRestoreCalls() - copyCalls, FULL_RESTORE_D3D12);
+    EXPECT_EQ(cmdList.renderTargets, state->render_targets);
+    EXPECT_EQ(cmdList.lastPipeline.handle, 22u);
+
+    // The apply at the end of RenderEffects finds the marks cleared and the state already in place
+    cmdList.ResetCounters();
+    state->apply(&cmdList);
+
+    EXPECT_EQ(cmdList.GetRestoreCalls(), 0u);
+    EXPECT_EQ(cmdList.renderTargets, state->render_targets);
+
+    // A later group marks again and gets its own restore
+    state->mark_dirty(dirty_all, shader_stage::all);
+    state->apply(&cmdList);
+
+    EXPECT_EQ(cmdList.GetRestoreCalls(), FULL_RESTORE_D3D12);
+}
+
+TEST_F(StateRestoreD3D11Test, EffectsRestoreNothingWithoutForce) {
+    // The runtime keeps its own state block on D3D11, the apply at the end of RenderEffects only clears the marks
+    state->mark_dirty(dirty_all, shader_stage::all);
+    state->apply(&cmdList);
+
+    EXPECT_EQ(cmdList.GetRestoreCalls(), 0u);
+    EXPECT_EQ(state->dirty_state, dirty_none);
+}
+
+TEST_F(StateRestoreD3D11Test, DescriptorsOnlyRestoredForDirtyPixelStage) {
+    // Only the first two pixel shader params are restored, marking other stages has no descriptor work
+    state->mark_dirty(dirty_descriptors, shader_stage::vertex | shader_stage::compute);
+    state->apply(&cmdList, true);
+
+    EXPECT_EQ(cmdList.GetRestoreCalls(), 0u);
+
+    state->mark_dirty(dirty_descriptors, shader_stage::pixel);
+    state->apply(&cmdList, true);
+
+    EXPECT_EQ(cmdList.descriptorPushes, 2u);
+    EXPECT_EQ(cmdList.GetRestoreCalls(), 2u);
+}
+
+TEST_F(StateRestoreD3D11Test, CopyShaderRestoresEverythingItMarked) {
+    shaderManager.CopyResourceMaskAlpha(&cmdList, { 51 }, { 52 }, 1920, 1080);
+
+    // Own calls: render target, pipeline, two push descriptors, viewport and scissor rect. Restored: render target, both pipelines, topology,
+    // viewport, scissor rect and the two pixel shader push descriptors.
+    EXPECT_EQ(cmdList.GetRestoreCalls(), 6u + 1 + 2 + 1 + 1 + 1 + 2);
+    EXPECT_EQ(cmdList.renderTargets, state->render_targets);
+}
@@ -0,0 +1,214 @@
+#include "MockDevice.h"
+#include "StateTracking.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace reshade::api;
+using namespace ShaderToggler::Tests;
+using namespace StateTracking;
+
+namespace {
+constexpr pipeline_layout LAYOUT = { 0x100 };
+constexpr uint32_t PIXEL = 0; // index of shader_stage::pixel in ALL_SHADER_STAGES
+
+// Param 0 is a table of 4 shader resource views followed by 2 constant buffers, with a sampler range that isn't captured. Param 1 holds push
+// constants, param 2 a table ending in an unbounded range.
+const descriptor_range TABLE_RANGES[] = {
+    { 0, 0, 0, 4, shader_stage::all, 1, descriptor_type::shader_resource_view },
+    { 4, 4, 0, 2, shader_stage::all, 1, descriptor_type::constant_buffer },
+    { 0, 0, 0, 2, shader_stage::all, 1, descriptor_type::sampler },
+};
+const descriptor_range UNBOUNDED_RANGES[] = {
+    { 0, 0, 0, 3, shader_stage::all, 1, descriptor_type::shader_resource_view },
+    { 3, 3, 0, UINT32_MAX, shader_stage::all, 1, descriptor_type::shader_resource_view },
+};
+
+// state_block and descriptor_tracking are used directly, none of their event handlers are registered
+class StateTrackingTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        tracking = &device.create_private_data<descriptor_tracking>();
+
+        const pipeline_layout_param params[] = { pipeline_layout_param(3, TABLE_RANGES), pipeline_layout_param(constant_range{}),
+                                                 pipeline_layout_param(2, UNBOUNDED_RANGES) };
+        tracking->register_pipeline_layout(LAYOUT, 3, params);
+
+        state.device = &device;
+        state.api = device_api::d3d12;
+    }
+
+    void TearDown() override { device.destroy_private_data<descriptor_tracking>(); }
+
+    void UpdateViews(uint32_t heap, uint32_t offset, uint64_t first, uint32_t count) {
+        std::vector<resource_view> views(count);
+        for (uint32_t i = 0; i < count; i++) {
+            views[i] = { first + i };
+        }
+
+        descriptor_table_update update;
+        update.table = MockDevice::MakeTable(heap, offset);
+        update.count = count;
+        update.type = descriptor_type::shader_resource_view;
+        update.descriptors = views.data();
+        tracking->update_descriptors(&device, 1, &update);
+    }
+
+    void UpdateBuffers(uint32_t heap, uint32_t offset, uint64_t first, uint32_t count) {
+        std::vector<buffer_range> buffers(count);
+        for (uint32_t i = 0; i < count; i++) {
+            buffers[i] = { { first + i }, 16 * i, 256 };
+        }
+
+        descriptor_table_update update;
+        update.table = MockDevice::MakeTable(heap, offset);
+        update.count = count;
+        update.type = descriptor_type::constant_buffer;
+        update.descriptors = buffers.data();
+        tracking->update_descriptors(&device, 1, &update);
+    }
+
+    // What binding the table captured before descriptors were resolved lazily
+    std::vector<descriptor_tracking::descriptor_data> EagerSnapshot(descriptor_table table, uint32_t layout_param) const {
+        const pipeline_layout_param param = tracking->get_pipeline_layout_param(LAYOUT, layout_param);
+
+        uint32_t size = 0;
+        for (uint32_t k = 0; k < param.descriptor_table.count; ++k) {
+            const descriptor_range& range = param.descriptor_table.ranges[k];
+            if (range.count != UINT32_MAX && range.type != descriptor_type::sampler)
+                size = std::max(size, range.binding + range.count);
+        }
+
+        std::vector<descriptor_tracking::descriptor_data> snapshot(size, descriptor_tracking::descriptor_data{});
+        for (uint32_t k = 0; k < param.descriptor_table.count; ++k) {
+            const descriptor_range& range = param.descriptor_table.ranges[k];
+            if (range.count == UINT32_MAX || range.type == descriptor_type::sampler)
+                continue;
+
+            uint32_t base_offset = 0;
+            descriptor_heap heap = { 0 };
+            device.get_descriptor_heap_offset(table, range.binding, 0, &heap, &base_offset);
+            tracking->set_all_descriptors(heap, base_offset, range.count, snapshot.data(), range.binding);
+        }
+
+        return snapshot;
+    }
+
+    void ExpectMatches(uint32_t layout_param, const std::vector<descriptor_tracking::descriptor_data>& expected) {
+        ASSERT_EQ(state.get_root_table_entry_size_at(PIXEL, layout_param), expected.size());
+
+        for (uint32_t i = 0; i < expected.size(); i++) {
+            const descriptor_tracking::descriptor_data* actual = state.get_descriptor_at(PIXEL, layout_param, i);
+            ASSERT_NE(actual, nullptr);
+            EXPECT_EQ(actual->type, expected[i].type) << "binding " << i;
+            EXPECT_EQ(actual->view.handle, expected[i].view.handle) << "binding " << i;
+            EXPECT_EQ(actual->constant.buffer.handle, expected[i].constant.buffer.handle) << "binding " << i;
+            EXPECT_EQ(actual->constant.offset, expected[i].constant.offset) << "binding " << i;
+        }
+
+        EXPECT_EQ(state.get_descriptor_at(PIXEL, layout_param, static_cast<uint32_t>(expected.size())), nullptr);
+    }
+
+    MockDevice device;
+    descriptor_tracking* tracking = nullptr;
+    state_block state;
+};
+}
+
+TEST_F(StateTrackingTest, BoundTableMatchesEagerSnapshot) {
+    UpdateViews(1, 100, 1000, 4);
+    UpdateBuffers(1, 104, 2000, 2);
+
+    const descriptor_table table = MockDevice::MakeTable(1, 100);
+    const auto expected = EagerSnapshot(table, 0);
+    state.bind_descriptor_tables(shader_stage::pixel, LAYOUT, 0, 1, &table);
+
+    ExpectMatches(0, expected);
+    EXPECT_EQ(state.get_descriptor_at(PIXEL, 0, 1)->view.handle, 1001u);
+    EXPECT_EQ(state.get_descriptor_at(PIXEL, 0, 5)->constant.buffer.handle, 2001u);
+}
+
+TEST_F(StateTrackingTest, TableWithUnboundedRangeMatchesEagerSnapshot) {
+    UpdateViews(2, 4094, 3000, 8); // Crosses a chunk boundary of the tracked heap
+
+    const descriptor_table tables[] = { MockDevice::MakeTable(2, 4094) };
+    const auto expected = EagerSnapshot(tables[0], 2);
+    state.bind_descriptor_tables(shader_stage::pixel, LAYOUT, 2, 1, tables);
+
+    ExpectMatches(2, expected);
+}
+
+TEST_F(StateTrackingTest, RebindsMatchEagerSnapshotOfTheLastTable) {
+    for (uint32_t i = 0; i < 16; i++) {
+        UpdateViews(1, i * 8, 100 * i, 4);
+        UpdateBuffers(1, i * 8 + 4, 100 * i + 50, 2);
+    }
+
+    for (uint32_t i = 0; i < 16; i++) {
+        const descriptor_table table = MockDevice::MakeTable(1, i * 8);
+        state.bind_descriptor_tables(shader_stage::pixel, LAYOUT, 0, 1, &table);
+
+        // Only every fourth table is inspected, the others are replaced before anything reads them
+        if (i % 4 == 3) {
+            ExpectMatches(0, EagerSnapshot(table, 0));
+        }
+    }
+}
+
+TEST_F(StateTrackingTest, SizeIsKnownBeforeResolving) {
+    const descriptor_table table = MockDevice::MakeTable(1, 0);
+    state.bind_descriptor_tables(shader_stage::pixel, LAYOUT, 0, 1, &table);
+
+    EXPECT_EQ(state.get_root_table_entry_size_at(PIXEL, 0), 6u);
+    EXPECT_EQ(state.root_tables[PIXEL].second[0].descriptors.data, nullptr);
+    EXPECT_EQ(state.descriptor_storage.reserved_bytes(), 0u);
+
+    // Push constant params of the layout aren't touched by binding tables
+    EXPECT_EQ(state.root_tables[PIXEL].second.size(), 1u);
+}
+
+TEST_F(StateTrackingTest, ResolvesOnlyOnce) {
+    UpdateViews(1, 0, 500, 4);
+
+    const descriptor_table table = MockDevice::MakeTable(1, 0);
+    state.bind_descriptor_tables(shader_stage::pixel, LAYOUT, 0, 1, &table);
+
+    const descriptor_tracking::descriptor_data* first = state.get_descriptor_at(PIXEL, 0, 0);
+    UpdateViews(1, 0, 600, 4);
+    const descriptor_tracking::descriptor_data* second = state.get_descriptor_at(PIXEL, 0, 0);
+
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(second->view.handle, 500u);
+}
+
+TEST_F(StateTrackingTest, HeapUpdatesBeforeFirstAccessAreVisible) {
+    UpdateViews(1, 0, 500, 4);
+
+    const descriptor_table table = MockDevice::MakeTable(1, 0);
+    state.bind_descriptor_tables(shader_stage::pixel, LAYOUT, 0, 1, &table);
+
+    // The eager capture would still hold 500, the GPU reads the heap when the draw executes and sees 700
+    UpdateViews(1, 0, 700, 4);
+
+    EXPECT_EQ(state.get_descriptor_at(PIXEL, 0, 0)->view.handle, 700u);
+    ExpectMatches(0, EagerSnapshot(table, 0));
+}
+
+TEST_F(StateTrackingTest, CompactKeepsResolvedAndLazyTables) {
+    UpdateViews(1, 0, 500, 4);
+    UpdateViews(2, 0, 800, 3);
+
+    const descriptor_table table = MockDevice::MakeTable(1, 0);
+    const descriptor_table unbounded = MockDevice::MakeTable(2, 0);
+    state.bind_descriptor_tables(shader_stage::pixel, LAYOUT, 0, 1, &table);
+    state.bind_descriptor_tables(shader_stage::pixel, LAYOUT, 2, 1, &unbounded);
+
+    const auto expected = EagerSnapshot(table, 0);
+    ASSERT_NE(state.get_descriptor_at(PIXEL, 0, 0), nullptr);
+
+    state.compact_storage();
+
+    EXPECT_NE(state.root_tables[PIXEL].second[0].descriptors.data, nullptr);
+    EXPECT_EQ(state.root_tables[PIXEL].second[2].descriptors.data, nullptr);
+    ExpectMatches(0, expected);
+    ExpectMatches(2, EagerSnapshot(unbounded, 2));
+}
@@ -0,0 +1,539 @@
+#pragma once
+
+#include "EventTrace.h"
+#include "MockDevice.h"
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <reshade.hpp>
+#include <string>
+#include <vector>
+#include <windows.h>
+
+// Main.cpp, linked in by the executables which replay traces through the add-on
+BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID);
+
+namespace ShaderToggler::Tests {
+/// <summary>
+/// Returns 4 bytes of shader code whose crc32 is hash, so pipelines hash to the values recorded in a trace when the add-on creates them again.
+/// Runs the crc backwards from the final value to find the table index every byte has to produce, then forwards to find the bytes.
+/// </summary>
+inline std::vector<uint8_t> ShaderCodeForHash(uint32_t hash) {
+    uint32_t table[256];
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (uint32_t k = 0; k < 8; k++) {
+            c = c & 1 ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+        }
+        table[i] = c;
+    }
+
+    // The top bytes of the table entries are unique, each one names the index that produced the top byte of the state after it
+    uint8_t indices[4];
+    uint32_t state = ~hash;
+    for (int32_t k = 3; k >= 0; k--) {
+        uint32_t index = 0;
+        while ((table[index] >> 24) != (state >> 24)) {
+            index++;
+        }
+
+        indices[k] = static_cast<uint8_t>(index);
+        state = (state ^ table[index]) << 8;
+    }
+
+    std::vector<uint8_t> code(4);
+    state = 0xFFFFFFFF;
+    for (uint32_t k = 0; k < 4; k++) {
+        code[k] = static_cast<uint8_t>((state ^ indices[k]) & 0xFF);
+        state = (state >> 8) ^ table[indices[k]];
+    }
+
+    return code;
+}
+
+/// <summary>
+/// Writes config as the add-on's ini file into a directory of its own, makes that the working directory and loads the add-on from Main.cpp. The
+/// stand-in GetModuleFileNameW returns no path, so the add-on reads its ini from the working directory. The add-on stays loaded for the rest
+/// of the process, only the first call has an effect.
+/// </summary>
+inline void AttachAddon(const std::string& config) {
+    static bool s_attached = false;
+
+    if (s_attached) {
+        return;
+    }
+
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "shadertoggler_replay";
+    std::filesystem::create_directories(dir);
+    std::ofstream(dir / HASH_FILE_NAME, std::ios::out | std::ios::trunc) << config;
+    std::filesystem::current_path(dir);
+
+    DllMain(nullptr, DLL_PROCESS_ATTACH, nullptr);
+    s_attached = true;
+}
+
+/// <summary>
+/// Shape of the trace WriteSyntheticTrace generates. Every eighth pipeline is a compute pipeline, the others carry a pixel and a vertex shader.
+/// </summary>
+struct SyntheticTraceDesc {
+    uint32_t frames = 8;
+    uint32_t pipelines = 256;
+    uint32_t commandLists = 2;
+    uint32_t drawsPerCommandList = 500;
+
+    static constexpr uint64_t LAYOUT = 0x900;
+
+    static uint32_t PixelHash(uint32_t pipeline) { return 0xA0000 + pipeline; }
+    static uint32_t VertexHash(uint32_t pipeline) { return 0xB0000 + pipeline % 64; }
+    static uint32_t ComputeHash(uint32_t pipeline) { return 0xC0000 + pipeline; }
+    static bool IsCompute(uint32_t pipeline) { return pipeline % 8 == 7; }
+
+    /// <summary>
+    /// Add-on configuration with two active groups matching every 32nd pixel shader, one rendering its techniques at the matched draw and one
+    /// when the pipeline changes afterwards. Both render every enabled technique.
+    /// </summary>
+    std::string Config() const {
+        std::string config = "[General]\nAmountGroups=2\n";
+
+        for (uint32_t g = 0; g < 2; g++) {
+            const std::string section = "Group" + std::to_string(g);
+            config += "[" + section + "]\nName=Replay" + std::to_string(g) + "\nActive=1\nInvocationLocation=" + std::to_string(g) +
+                      "\nMatchSwapchainResolutionOnly=0\nAllowAllTechniques=1\n";
+
+            std::string hashes;
+            uint32_t amount = 0;
+            for (uint32_t i = g + 1; i < pipelines; i += 32) {
+                if (!IsCompute(i)) {
+                    hashes += "ShaderHash" + std::to_string(amount++) + "=" + std::to_string(PixelHash(i)) + "\n";
+                }
+            }
+
+            config += "[" + section + "_PixelShaders]\nAmountHashes=" + std::to_string(amount) + "\n" + hashes;
+        }
+
+        return config;
+    }
+};
+
+/// <summary>
+/// Writes a trace in the format EventTraceRecorder records, standing in for a game capture. Each command list binds a render target, two
+/// descriptor tables and push constants, then draws with a pipeline bound before every fourth draw. Pipelines are picked pseudo randomly.
+/// </summary>
+inline bool WriteSyntheticTrace(const std::filesystem::path& path, const SyntheticTraceDesc& desc) {
+    std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+
+    TraceFileHeader fileHeader;
+    fileHeader.api = static_cast<uint32_t>(reshade::api::device_api::d3d12);
+    fileHeader.frames = desc.frames;
+    file.write(reinterpret_cast<const char*>(&fileHeader), sizeof(fileHeader));
+
+    const auto append = [&file](TraceRecordType type, uint64_t cmdList, const void* data, uint32_t size, const void* extra = nullptr, uint32_t extraSize = 0) {
+        TraceRecordHeader header{ type, {}, size + extraSize, cmdList };
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(static_cast<const char*>(data), size);
+        if (extraSize > 0) {
+            file.write(static_cast<const char*>(extra), extraSize);
+        }
+    };
+
+    for (uint32_t i = 0; i < desc.pipelines; i++) {
+        TraceInitPipeline record{ 0x10000 + i * 16ull, 0, 0, 0 };
+        if (SyntheticTraceDesc::IsCompute(i)) {
+            record.csHash = SyntheticTraceDesc::ComputeHash(i);
+        } else {
+            record.psHash = SyntheticTraceDesc::PixelHash(i);
+            record.vsHash = SyntheticTraceDesc::VertexHash(i);
+        }
+
+        append(TraceRecordType::INIT_PIPELINE, 0, &record, sizeof(record));
+    }
+
+    uint32_t seed = 1;
+    uint32_t constants[16] = {};
+
+    for (uint32_t frame = 0; frame < desc.frames; frame++) {
+        for (uint32_t c = 0; c < desc.commandLists; c++) {
+            const uint64_t cmdList = 0x1000 + c;
+
+            const reshade::api::resource_view rtv = { 0x7000 + c };
+            const TraceBindRenderTargets targets{ 1, 0 };
+            append(TraceRecordType::BIND_RENDER_TARGETS, cmdList, &targets, sizeof(targets), &rtv, sizeof(rtv));
+
+            const TracePushConstants push{ static_cast<uint32_t>(reshade::api::shader_stage::pixel), SyntheticTraceDesc::LAYOUT, 2, 0, 16 };
+            append(TraceRecordType::PUSH_CONSTANTS, cmdList, &push, sizeof(push), constants, sizeof(constants));
+
+            for (uint32_t d = 0; d < desc.drawsPerCommandList; d++) {
+                seed = seed * 1664525 + 1013904223;
+                const uint32_t pipeline = (seed >> 8) % desc.pipelines;
+
+                if (d % 16 == 0) {
+                    const reshade::api::descriptor_table tables[] = { MockDevice::MakeTable(1, (seed >> 4) % 1024 * 8), MockDevice::MakeTable(1, d * 8) };
+                    const TraceBindDescriptorTables bind{ static_cast<uint32_t>(reshade::api::shader_stage::pixel), SyntheticTraceDesc::LAYOUT, 0, 2 };
+                    append(TraceRecordType::BIND_DESCRIPTOR_TABLES, cmdList, &bind, sizeof(bind), tables, sizeof(tables));
+                }
+
+                if (d % 4 == 0) {
+                    const reshade::api::pipeline_stage stages =
+                      SyntheticTraceDesc::IsCompute(pipeline) ? reshade::api::pipeline_stage::compute_shader : reshade::api::pipeline_stage::all_graphics;
+                    const TraceBindPipeline bind{ static_cast<uint32_t>(stages), 0x10000 + pipeline * 16ull };
+                    append(TraceRecordType::BIND_PIPELINE, cmdList, &bind, sizeof(bind));
+
+                    if (SyntheticTraceDesc::IsCompute(pipeline)) {
+                        const TraceDispatch dispatch{ 8, 8, 1 };
+                        append(TraceRecordType::DISPATCH, cmdList, &dispatch, sizeof(dispatch));
+                    }
+                }
+
+                const TraceDraw draw{ 3 * (d % 64 + 1), 1 };
+                append(TraceRecordType::DRAW_INDEXED, cmdList, &draw, sizeof(draw));
+            }
+        }
+
+        append(TraceRecordType::PRESENT, 0, nullptr, 0);
+    }
+
+    return file.good();
+}
+
+/// <summary>
+/// Feeds a recorded trace through the event handlers registered by the add-on, against a mock device. Load reads the whole trace upfront, so
+/// Replay only measures the add-on.
+///
+/// A trace doesn't hold everything the add-on would have seen in the game, the replay fills the gaps:
+/// - Pipelines are created by Attach, with shader code hashing to the recorded values. Replay raises the command list events only, so it can run
+///   any number of times.
+/// - Pipeline layouts are reconstructed from how the trace uses their params. Descriptor tables hold a range of 8 shader resource views.
+/// - Every recorded render target view is replaced with a view of its own back buffer sized texture.
+/// - Command lists are reset after every present, the way D3D12 and Vulkan games reuse them.
+/// </summary>
+class TraceReplay final {
+  public:
+    ~TraceReplay() { Detach(); }
+
+    /// <summary>
+    /// Reads the trace at path and creates the mock device and runtime for it. Techniques added to GetRuntime before Attach are loaded by the
+    /// add-on. Returns false if the trace doesn't validate.
+    /// </summary>
+    bool Load(const std::filesystem::path& path) {
+        TraceSummary summary;
+        if (!ValidateEventTrace(path, summary).empty()) {
+            return false;
+        }
+
+        EventTraceReader reader;
+        reader.Open(path);
+
+        _device = std::make_unique<MockDevice>(static_cast<reshade::api::device_api>(reader.GetHeader().api));
+        _runtime = std::make_unique<MockEffectRuntime>(_device.get());
+        _frames = reader.GetHeader().frames;
+
+        TraceRecordHeader header;
+        std::vector<uint8_t> payload;
+
+        while (reader.Next(header, payload)) {
+            switch (header.type) {
+                case TraceRecordType::INIT_PIPELINE: {
+                    TraceInitPipeline record;
+                    memcpy(&record, payload.data(), sizeof(record));
+                    _pipelines.push_back(record);
+                } break;
+                case TraceRecordType::BIND_PIPELINE:
+                    Add<TraceBindPipeline>(header, payload);
+                    break;
+                case TraceRecordType::BIND_RENDER_TARGETS: {
+                    ReplayRecord& record = Add<TraceBindRenderTargets>(header, payload);
+                    const TraceBindRenderTargets& bind = Get<TraceBindRenderTargets>(record);
+                    auto* rtvs = reinterpret_cast<reshade::api::resource_view*>(&_data[record.extra]);
+
+                    for (uint32_t i = 0; i < bind.count; i++) {
+                        rtvs[i] = GetStandInView(rtvs[i]);
+                    }
+                } break;
+                case TraceRecordType::DRAW:
+                case TraceRecordType::DRAW_INDEXED:
+                    Add<TraceDraw>(header, payload);
+                    break;
+                case TraceRecordType::DISPATCH:
+                    Add<TraceDispatch>(header, payload);
+                    break;
+                case TraceRecordType::DRAW_OR_DISPATCH_INDIRECT:
+                    Add<TraceDrawOrDispatchIndirect>(header, payload);
+                    break;
+                case TraceRecordType::PUSH_DESCRIPTORS: {
+                    const TracePushDescriptors& push = Get<TracePushDescriptors>(Add<TracePushDescriptors>(header, payload));
+                    UseLayoutParam(push.layout, push.layoutParam) = reshade::api::pipeline_layout_param(reshade::api::descriptor_range{
+                      push.binding, 0, 0, push.count, reshade::api::shader_stage::all, 1, static_cast<reshade::api::descriptor_type>(push.type) });
+                } break;
+                case TraceRecordType::PUSH_CONSTANTS: {
+                    const TracePushConstants& push = Get<TracePushConstants>(Add<TracePushConstants>(header, payload));
+                    UseLayoutParam(push.layout, push.layoutParam) =
+                      reshade::api::pipeline_layout_param(reshade::api::constant_range{ 0, 0, 0, 0, push.first + push.count, reshade::api::shader_stage::all });
+                } break;
+                case TraceRecordType::BIND_DESCRIPTOR_TABLES: {
+                    const TraceBindDescriptorTables& bind = Get<TraceBindDescriptorTables>(Add<TraceBindDescriptorTables>(header, payload));
+                    for (uint32_t i = 0; i < bind.count; i++) {
+                        UseLayoutParam(bind.layout, bind.first + i) = reshade::api::pipeline_layout_param(1, &TABLE_RANGE);
+                    }
+                } break;
+                case TraceRecordType::PRESENT:
+                    _records.push_back({ TraceRecordType::PRESENT, nullptr, 0, 0 });
+                    break;
+            }
+        }
+
+        return true;
+    }
+
+    /// <summary>
+    /// Raises the events the add-on sees from the moment the game creates its device until the first frame: the device, effect runtime,
+    /// render targets, command lists, pipeline layouts and pipelines of the trace.
+    /// </summary>
+    void Attach() {
+        using namespace reshade;
+
+        invoke_addon_event<addon_event::init_device>(_device.get());
+        invoke_addon_event<addon_event::init_effect_runtime>(_runtime.get());
+        invoke_addon_event<addon_event::reshade_reloaded_effects>(_runtime.get());
+
+        for (const auto& [_, view] : _views) {
+            const api::resource resource = _device->get_resource_from_view(view);
+            invoke_addon_event<addon_event::init_resource>(
+              _device.get(), _device->get_resource_desc(resource), nullptr, api::resource_usage::render_target, resource);
+            invoke_addon_event<addon_event::init_resource_view>(
+              _device.get(), resource, api::resource_usage::render_target, _device->get_resource_view_desc(view), view);
+        }
+
+        for (const auto& [_, cmdList] : _commandLists) {
+            invoke_addon_event<addon_event::init_command_list>(cmdList.get());
+        }
+
+        for (const auto& [layout, params] : _layouts) {
+            invoke_addon_event<addon_event::init_pipeline_layout>(_device.get(), static_cast<uint32_t>(params.size()), params.data(), api::pipeline_layout{ layout });
+        }
+
+        for (const TraceInitPipeline& pipeline : _pipelines) {
+            const std::vector<uint8_t> psCode = ShaderCodeForHash(pipeline.psHash);
+            const std::vector<uint8_t> vsCode = ShaderCodeForHash(pipeline.vsHash);
+            const std::vector<uint8_t> csCode = ShaderCodeForHash(pipeline.csHash);
+
+            api::shader_desc ps = { psCode.data(), psCode.size() };
+            api::shader_desc vs = { vsCode.data(), vsCode.size() };
+            api::shader_desc cs = { csCode.data(), csCode.size() };
+
+            std::vector<api::pipeline_subobject> subobjects;
+            if (pipeline.psHash != 0)
+                subobjects.push_back({ api::pipeline_subobject_type::pixel_shader, 1, &ps });
+            if (pipeline.vsHash != 0)
+                subobjects.push_back({ api::pipeline_subobject_type::vertex_shader, 1, &vs });
+            if (pipeline.csHash != 0)
+                subobjects.push_back({ api::pipeline_subobject_type::compute_shader, 1, &cs });
+
+            invoke_addon_event<addon_event::init_pipeline>(
+              _device.get(), api::pipeline_layout{ 0 }, static_cast<uint32_t>(subobjects.size()), subobjects.data(), api::pipeline{ pipeline.pipeline });
+        }
+
+        _attached = true;
+    }
+
+    /// <summary>
+    /// Raises the recorded command list events and presents once. Returns the amount of events raised.
+    /// </summary>
+    uint64_t Replay() {
+        using namespace reshade;
+
+        for (const ReplayRecord& record : _records) {
+            api::command_list* cmdList = record.cmdList;
+
+            switch (record.type) {
+                case TraceRecordType::BIND_PIPELINE: {
+                    const TraceBindPipeline& bind = Get<TraceBindPipeline>(record);
+                    invoke_addon_event<addon_event::bind_pipeline>(cmdList, static_cast<api::pipeline_stage>(bind.stages), api::pipeline{ bind.pipeline });
+                } break;
+                case TraceRecordType::BIND_RENDER_TARGETS: {
+                    const TraceBindRenderTargets& bind = Get<TraceBindRenderTargets>(record);
+                    invoke_addon_event<addon_event::bind_render_targets_and_depth_stencil>(
+                      cmdList, bind.count, reinterpret_cast<const api::resource_view*>(&_data[record.extra]), api::resource_view{ bind.dsv });
+                } break;
+                case TraceRecordType::DRAW: {
+                    const TraceDraw& draw = Get<TraceDraw>(record);
+                    invoke_addon_event<addon_event::draw>(cmdList, draw.count, draw.instanceCount, 0u, 0u);
+                } break;
+                case TraceRecordType::DRAW_INDEXED: {
+                    const TraceDraw& draw = Get<TraceDraw>(record);
+                    invoke_addon_event<addon_event::draw_indexed>(cmdList, draw.count, draw.instanceCount, 0u, 0, 0u);
+                } break;
+                case TraceRecordType::DISPATCH: {
+                    const TraceDispatch& dispatch = Get<TraceDispatch>(record);
+                    invoke_addon_event<addon_event::dispatch>(cmdList, dispatch.groupCountX, dispatch.groupCountY, dispatch.groupCountZ);
+                } break;
+                case TraceRecordType::DRAW_OR_DISPATCH_INDIRECT: {
+                    const TraceDrawOrDispatchIndirect& indirect = Get<TraceDrawOrDispatchIndirect>(record);
+                    invoke_addon_event<addon_event::draw_or_dispatch_indirect>(
+                      cmdList, static_cast<api::indirect_command>(indirect.type), api::resource{ indirect.buffer }, indirect.offset, indirect.drawCount, indirect.stride);
+                } break;
+                case TraceRecordType::PUSH_DESCRIPTORS: {
+                    const TracePushDescriptors& push = Get<TracePushDescriptors>(record);
+                    const api::descriptor_table_update update{
+                        {}, push.binding, push.arrayOffset, push.count, static_cast<api::descriptor_type>(push.type), &_data[record.extra]
+                    };
+                    invoke_addon_event<addon_event::push_descriptors>(
+                      cmdList, static_cast<api::shader_stage>(push.stages), api::pipeline_layout{ push.layout }, push.layoutParam, update);
+                } break;
+                case TraceRecordType::PUSH_CONSTANTS: {
+                    const TracePushConstants& push = Get<TracePushConstants>(record);
+                    invoke_addon_event<addon_event::push_constants>(cmdList,
+                                                                    static_cast<api::shader_stage>(push.stages),
+                                                                    api::pipeline_layout{ push.layout },
+                                                                    push.layoutParam,
+                                                                    push.first,
+                                                                    push.count,
+                                                                    static_cast<const void*>(&_data[record.extra]));
+                } break;
+                case TraceRecordType::BIND_DESCRIPTOR_TABLES: {
+                    const TraceBindDescriptorTables& bind = Get<TraceBindDescriptorTables>(record);
+                    invoke_addon_event<addon_event::bind_descriptor_tables>(cmdList,
+                                                                            static_cast<api::shader_stage>(bind.stages),
+                                                                            api::pipeline_layout{ bind.layout },
+                                                                            bind.first,
+                                                                            bind.count,
+                                                                            reinterpret_cast<const api::descriptor_table*>(&_data[record.extra]));
+                } break;
+                case TraceRecordType::PRESENT:
+                    Present();
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        return _records.size();
+    }
+
+    /// <summary>
+    /// Raises the destroy events for everything Attach created.
+    /// </summary>
+    void Detach() {
+        using namespace reshade;
+
+        if (!_attached) {
+            return;
+        }
+
+        for (const TraceInitPipeline& pipeline : _pipelines) {
+            invoke_addon_event<addon_event::destroy_pipeline>(_device.get(), api::pipeline{ pipeline.pipeline });
+        }
+
+        for (const auto& [layout, _] : _layouts) {
+            invoke_addon_event<addon_event::destroy_pipeline_layout>(_device.get(), api::pipeline_layout{ layout });
+        }
+
+        for (const auto& [_, cmdList] : _commandLists) {
+            invoke_addon_event<addon_event::destroy_command_list>(cmdList.get());
+        }
+
+        for (const auto& [_, view] : _views) {
+            const api::resource resource = _device->get_resource_from_view(view);
+            invoke_addon_event<addon_event::destroy_resource_view>(_device.get(), view);
+            invoke_addon_event<addon_event::destroy_resource>(_device.get(), resource);
+        }
+
+        invoke_addon_event<addon_event::destroy_effect_runtime>(_runtime.get());
+        invoke_addon_event<addon_event::destroy_device>(_device.get());
+
+        _attached = false;
+    }
+
+    MockDevice& GetDevice() { return *_device; }
+    MockEffectRuntime& GetRuntime() { return *_runtime; }
+    uint32_t GetFrames() const { return _frames; }
+
+  private:
+    struct ReplayRecord {
+        TraceRecordType type;
+        MockCommandList* cmdList;
+        uint32_t fixed; // index into _data of the fixed part of the payload
+        uint32_t extra; // index into _data of the elements following it
+    };
+
+    static constexpr reshade::api::descriptor_range TABLE_RANGE = { 0, 0, 0, 8, reshade::api::shader_stage::all, 1, reshade::api::descriptor_type::shader_resource_view };
+
+    // Copies size bytes to the end of _data and returns their index, every copy starts 8 byte aligned
+    uint32_t Store(const uint8_t* data, size_t size) {
+        const uint32_t index = static_cast<uint32_t>(_data.size());
+        _data.resize(_data.size() + (size + 7) / 8);
+        if (size > 0) {
+            memcpy(&_data[index], data, size);
+        }
+        return index;
+    }
+
+    template<typename T>
+    ReplayRecord& Add(const TraceRecordHeader& header, const std::vector<uint8_t>& payload) {
+        auto& cmdList = _commandLists[header.commandList];
+        if (cmdList == nullptr) {
+            cmdList = std::make_unique<MockCommandList>(_device.get());
+        }
+
+        const uint32_t fixed = Store(payload.data(), sizeof(T));
+        const uint32_t extra = Store(payload.data() + sizeof(T), payload.size() - sizeof(T));
+        return _records.emplace_back(ReplayRecord{ header.type, cmdList.get(), fixed, extra });
+    }
+
+    template<typename T>
+    const T& Get(const ReplayRecord& record) const {
+        return *reinterpret_cast<const T*>(&_data[record.fixed]);
+    }
+
+    reshade::api::pipeline_layout_param& UseLayoutParam(uint64_t layout, uint32_t param) {
+        std::vector<reshade::api::pipeline_layout_param>& params = _layouts[layout];
+        if (params.size() <= param) {
+            params.resize(param + 1, reshade::api::pipeline_layout_param(reshade::api::constant_range{}));
+        }
+        return params[param];
+    }
+
+    reshade::api::resource_view GetStandInView(reshade::api::resource_view view) {
+        reshade::api::resource_view& standIn = _views[view.handle];
+
+        if (standIn == 0 && view != 0) {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            _runtime->get_screenshot_width_and_height(&width, &height);
+
+            reshade::api::resource resource = {};
+            const reshade::api::resource_desc desc(
+              width, height, 1, 1, reshade::api::format::r8g8b8a8_unorm, 1, reshade::api::memory_heap::gpu_only, reshade::api::resource_usage::render_target);
+            _device->create_resource(desc, nullptr, reshade::api::resource_usage::render_target, &resource);
+            _device->create_resource_view(resource, reshade::api::resource_usage::render_target, reshade::api::resource_view_desc(desc.texture.format), &standIn);
+        }
+
+        return standIn;
+    }
+
+    void Present() {
+        using namespace reshade;
+
+        api::command_queue* queue = _runtime->get_command_queue();
+        invoke_addon_event<addon_event::present>(queue, nullptr, nullptr, nullptr, 0u, nullptr);
+        invoke_addon_event<addon_event::reshade_present>(_runtime.get());
+
+        for (const auto& [_, cmdList] : _commandLists) {
+            invoke_addon_event<addon_event::reset_command_list>(cmdList.get());
+        }
+    }
+
+    std::unique_ptr<MockDevice> _device;
+    std::unique_ptr<MockEffectRuntime> _runtime;
+    std::map<uint64_t, std::unique_ptr<MockCommandList>> _commandLists;
+    std::map<uint64_t, std::vector<reshade::api::pipeline_layout_param>> _layouts;
+    std::map<uint64_t, reshade::api::resource_view> _views;
+    std::vector<TraceInitPipeline> _pipelines;
+    std::vector<ReplayRecord> _records;
+    std::vector<uint64_t> _data;
+    uint32_t _frames = 0;
+    bool _attached = false;
+};
+}
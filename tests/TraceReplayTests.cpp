@@ -0,0 +1,61 @@
+#include "TraceReplay.h"
+#include "crc32_hash.hpp"
+#include <gtest/gtest.h>
+
+using namespace ShaderToggler;
+using namespace ShaderToggler::Tests;
+
+namespace {
+constexpr uint32_t TECHNIQUES = 4;
+
+// The add-on is loaded once for all tests with the configuration of the synthetic trace, every test replays its own trace on a fresh device
+class TraceReplayTest : public ::testing::Test {
+  protected:
+    static void SetUpTestSuite() { AttachAddon(SyntheticTraceDesc().Config()); }
+
+    void SetUp() override {
+        path = std::filesystem::temp_directory_path() / "shadertoggler_replay_test.trace";
+        ASSERT_TRUE(WriteSyntheticTrace(path, desc));
+        ASSERT_TRUE(replay.Load(path));
+
+        for (uint32_t i = 0; i < TECHNIQUES; i++) {
+            replay.GetRuntime().AddTechnique("Technique" + std::to_string(i), "Effect.fx", true);
+        }
+
+        replay.Attach();
+    }
+
+    void TearDown() override {
+        replay.Detach();
+        std::filesystem::remove(path);
+    }
+
+    SyntheticTraceDesc desc;
+    std::filesystem::path path;
+    TraceReplay replay;
+};
+}
+
+TEST(ShaderCodeForHashTest, CodeHashesToRequestedValue) {
+    for (const uint32_t hash : { 0u, 1u, 0xA0001u, 0x12345678u, 0xDEADBEEFu, 0xFFFFFFFFu }) {
+        const std::vector<uint8_t> code = ShaderCodeForHash(hash);
+        EXPECT_EQ(compute_crc32(code.data(), code.size()), hash);
+    }
+}
+
+TEST_F(TraceReplayTest, SyntheticTraceValidates) {
+    TraceSummary summary;
+    EXPECT_EQ(ValidateEventTrace(path, summary), "");
+    EXPECT_EQ(summary.frames, desc.frames);
+    EXPECT_EQ(summary.records[static_cast<size_t>(TraceRecordType::INIT_PIPELINE)], desc.pipelines);
+    EXPECT_EQ(summary.records[static_cast<size_t>(TraceRecordType::DRAW_INDEXED)], desc.frames * desc.commandLists * desc.drawsPerCommandList);
+}
+
+TEST_F(TraceReplayTest, EveryTechniqueRendersOncePerFrame) {
+    // The groups match pixel shaders of the trace, so every enabled technique is rendered on the command list that draws with one first
+    replay.Replay();
+    EXPECT_EQ(replay.GetRuntime().techniqueRenders, desc.frames * TECHNIQUES);
+
+    replay.Replay();
+    EXPECT_EQ(replay.GetRuntime().techniqueRenders, 2 * desc.frames * TECHNIQUES);
+}
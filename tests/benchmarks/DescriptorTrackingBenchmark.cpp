@@ -0,0 +1,97 @@
+#include "DescriptorTracking.h"
+#include "MockDevice.h"
+#include <benchmark/benchmark.h>
+#include <vector>
+
+using namespace reshade::api;
+using namespace ShaderToggler::Tests;
+
+// descriptor_tracking is used directly, none of its event handlers are registered. Each iteration writes one table of state.range(0)
+// descriptors, the same call shape the update_descriptor_tables and copy_descriptor_tables events have.
+
+static void BM_UpdateDescriptors(benchmark::State& state) {
+    MockDevice device;
+    descriptor_tracking tracking;
+    const uint32_t count = static_cast<uint32_t>(state.range(0));
+
+    std::vector<resource_view> views(count);
+    for (uint32_t i = 0; i < count; i++) {
+        views[i] = { 100u + i };
+    }
+
+    uint32_t offset = 0;
+    for (auto _ : state) {
+        descriptor_table_update update;
+        update.table = MockDevice::MakeTable(1, offset);
+        update.count = count;
+        update.type = descriptor_type::shader_resource_view;
+        update.descriptors = views.data();
+        tracking.update_descriptors(&device, 1, &update);
+
+        // Walk a 64k descriptor window, like a ring of transient tables
+        offset = (offset + count) & 0xFFFF;
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_UpdateDescriptors)->Arg(1)->Arg(16)->Arg(1024);
+
+static void BM_CopyDescriptors(benchmark::State& state) {
+    MockDevice device;
+    descriptor_tracking tracking;
+    const uint32_t count = static_cast<uint32_t>(state.range(0));
+
+    std::vector<resource_view> views(0x10000);
+    for (uint32_t i = 0; i < views.size(); i++) {
+        views[i] = { 100u + i };
+    }
+
+    descriptor_table_update update;
+    update.table = MockDevice::MakeTable(1, 0);
+    update.count = static_cast<uint32_t>(views.size());
+    update.type = descriptor_type::shader_resource_view;
+    update.descriptors = views.data();
+    tracking.update_descriptors(&device, 1, &update);
+
+    uint32_t offset = 0;
+    for (auto _ : state) {
+        descriptor_table_copy copy;
+        copy.source_table = MockDevice::MakeTable(1, offset);
+        copy.dest_table = MockDevice::MakeTable(2, offset);
+        copy.count = count;
+        tracking.copy_descriptors(&device, 1, &copy);
+
+        offset = (offset + count) & 0xFFFF & ~(count - 1);
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_CopyDescriptors)->Arg(1)->Arg(16)->Arg(1024);
+
+static void BM_GetShaderResourceView(benchmark::State& state) {
+    MockDevice device;
+    descriptor_tracking tracking;
+
+    std::vector<resource_view> views(0x10000);
+    for (uint32_t i = 0; i < views.size(); i++) {
+        views[i] = { 100u + i };
+    }
+
+    descriptor_table_update update;
+    update.table = MockDevice::MakeTable(1, 0);
+    update.count = static_cast<uint32_t>(views.size());
+    update.type = descriptor_type::shader_resource_view;
+    update.descriptors = views.data();
+    tracking.update_descriptors(&device, 1, &update);
+
+    uint32_t offset = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tracking.get_shader_resource_view({ 1 }, offset));
+        offset = (offset + 97) & 0xFFFF;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetShaderResourceView);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,146 @@
+#include "TraceReplay.h"
+#include <benchmark/benchmark.h>
+#include <utility>
+#include <vector>
+
+using namespace reshade;
+using namespace ShaderToggler::Tests;
+
+// Cost of the bind and draw events a game raises while the add-on has nothing to do: its only group is inactive, nothing is collected or
+// edited. The event source is a mock command list raising a pipeline bind before every fourth indexed draw, against the handlers Main.cpp,
+// state tracking and the trace recorder registered at load.
+//
+// The benchmarks run in registration order. The add-on's hot path starts out active and goes idle once HOT_PATH_IDLE_FRAMES presents passed
+// without a consumer, which BM_HotPathIdle raises upfront. Without an active group nothing resumes it afterwards.
+
+namespace {
+constexpr uint32_t PIPELINES = 256;
+constexpr uint32_t STREAM = 0x10000;
+constexpr uint32_t IDLE_PRESENTS = 64; // more than HOT_PATH_IDLE_FRAMES in Main.cpp
+
+// The group holds the pixel shader of pipeline 1, 0xA0001
+constexpr const char* CONFIG = "[General]\nAmountGroups=1\n"
+                               "[Group0]\nName=Inactive\nActive=0\nAllowAllTechniques=1\n"
+                               "[Group0_PixelShaders]\nAmountHashes=1\nShaderHash0=655361\n";
+
+struct event_source {
+    event_source()
+      : runtime(&device)
+      , cmdList(&device) {
+        AttachAddon(CONFIG);
+
+        invoke_addon_event<addon_event::init_device>(&device);
+        invoke_addon_event<addon_event::init_effect_runtime>(&runtime);
+        invoke_addon_event<addon_event::init_command_list>(&cmdList);
+
+        for (uint32_t i = 0; i < PIPELINES; i++) {
+            const std::vector<uint8_t> psCode = ShaderCodeForHash(0xA0000 + i);
+            const std::vector<uint8_t> vsCode = ShaderCodeForHash(0xB0000 + i % 64);
+            api::shader_desc ps = { psCode.data(), psCode.size() };
+            api::shader_desc vs = { vsCode.data(), vsCode.size() };
+            api::pipeline_subobject subobjects[] = { { api::pipeline_subobject_type::pixel_shader, 1, &ps },
+                                                     { api::pipeline_subobject_type::vertex_shader, 1, &vs } };
+
+            invoke_addon_event<addon_event::init_pipeline>(&device, api::pipeline_layout{ 0 }, 2u, subobjects, Pipeline(i));
+        }
+
+        uint32_t seed = 1;
+        stream.resize(STREAM);
+        for (auto& pipeline : stream) {
+            seed = seed * 1664525 + 1013904223;
+            pipeline = Pipeline((seed >> 8) % PIPELINES);
+        }
+    }
+
+    static api::pipeline Pipeline(uint32_t i) { return { 0x10000 + i * 16ull }; }
+
+    // A pipeline bind before every fourth draw, returns the amount of events raised
+    uint32_t Raise(size_t i) {
+        uint32_t events = 1;
+
+        if (i % 4 == 0) {
+            invoke_addon_event<addon_event::bind_pipeline>(&cmdList, api::pipeline_stage::all_graphics, stream[i & (STREAM - 1)]);
+            events++;
+        }
+
+        invoke_addon_event<addon_event::draw_indexed>(&cmdList, 36u, 1u, 0u, 0, 0u);
+        return events;
+    }
+
+    MockDevice device;
+    MockEffectRuntime runtime;
+    MockCommandList cmdList;
+    std::vector<api::pipeline> stream;
+};
+
+event_source& GetEventSource() {
+    static event_source s_source;
+    return s_source;
+}
+
+bool g_idle = false;
+
+template<addon_event ev>
+struct registry_swap {
+    registry_swap() { std::swap(saved, addon_event_callbacks<ev>()); }
+    ~registry_swap() { std::swap(saved, addon_event_callbacks<ev>()); }
+
+    std::vector<typename addon_event_traits<ev>::decl> saved;
+};
+}
+
+// What the events cost ReShade with nothing registered for them
+static void BM_HotPathNoHandlers(benchmark::State& state) {
+    event_source& source = GetEventSource();
+    registry_swap<addon_event::bind_pipeline> binds;
+    registry_swap<addon_event::draw_indexed> draws;
+    uint64_t events = 0;
+    size_t i = 0;
+
+    for (auto _ : state) {
+        events += source.Raise(i++);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(events));
+}
+BENCHMARK(BM_HotPathNoHandlers);
+
+// The handlers doing their bookkeeping, like they did before the hot path could go idle
+static void BM_HotPathActive(benchmark::State& state) {
+    if (g_idle) {
+        state.SkipWithError("The hot path doesn't resume without a consumer, run before BM_HotPathIdle");
+        return;
+    }
+
+    event_source& source = GetEventSource();
+    uint64_t events = 0;
+    size_t i = 0;
+
+    for (auto _ : state) {
+        events += source.Raise(i++);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(events));
+}
+BENCHMARK(BM_HotPathActive);
+
+static void BM_HotPathIdle(benchmark::State& state) {
+    event_source& source = GetEventSource();
+
+    for (uint32_t p = 0; p < IDLE_PRESENTS; p++) {
+        invoke_addon_event<addon_event::reshade_present>(&source.runtime);
+    }
+    g_idle = true;
+
+    uint64_t events = 0;
+    size_t i = 0;
+
+    for (auto _ : state) {
+        events += source.Raise(i++);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(events));
+}
+BENCHMARK(BM_HotPathIdle);
+
+BENCHMARK_MAIN();
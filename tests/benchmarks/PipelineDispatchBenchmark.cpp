@@ -0,0 +1,118 @@
+#include "AddonUIData.h"
+#include "ShaderManager.h"
+#include "ToggleGroup.h"
+#include <benchmark/benchmark.h>
+#include <vector>
+
+using namespace ShaderToggler;
+using namespace AddonImGui;
+
+// The lookups onBindPipeline does for a stream of pipeline binds, without the command list bookkeeping around them. Pipelines carry a pixel and
+// a vertex shader, every eighth one a compute shader instead, and a few toggle groups hold some of the hashes.
+
+namespace {
+constexpr uint32_t PIPELINES = 4096;
+constexpr uint32_t GROUPS = 8;
+constexpr uint32_t STREAM = 0x10000;
+
+struct dispatch_fixture {
+    dispatch_fixture()
+      : uiData(&pixelShaderManager, &vertexShaderManager, &computeShaderManager, nullptr, &collectorFrameCounter) {
+        for (int g = 0; g < GROUPS; g++) {
+            std::unordered_set<uint32_t> psHashes;
+            std::unordered_set<uint32_t> vsHashes;
+            for (uint32_t i = g; i < PIPELINES; i += 64) {
+                psHashes.insert(PixelHash(i));
+                vsHashes.insert(VertexHash(i));
+            }
+
+            ToggleGroup group("group", g);
+            group.storeCollectedHashes(psHashes, vsHashes, {});
+            uiData.GetToggleGroups().emplace(g, group);
+        }
+        uiData.UpdateToggleGroupsForShaderHashes();
+
+        for (uint32_t i = 0; i < PIPELINES; i++) {
+            const uint32_t ps = i % 8 == 7 ? 0 : PixelHash(i);
+            const uint32_t vs = i % 8 == 7 ? 0 : VertexHash(i);
+            const uint32_t cs = i % 8 == 7 ? 0xC0000 + i : 0;
+
+            if (ps != 0)
+                pixelShaderManager.addHashHandlePair(ps, Handle(i));
+            if (vs != 0)
+                vertexShaderManager.addHashHandlePair(vs, Handle(i));
+            if (cs != 0)
+                computeShaderManager.addHashHandlePair(cs, Handle(i));
+
+            uiData.AddPipelineDispatchData(Handle(i), ps, vs, cs);
+        }
+
+        // Games rebind a working set of pipelines in no particular order
+        uint32_t seed = 1;
+        stream.resize(STREAM);
+        for (auto& handle : stream) {
+            seed = seed * 1664525 + 1013904223;
+            handle = Handle((seed >> 8) % PIPELINES);
+        }
+    }
+
+    static uint64_t Handle(uint32_t i) { return 0x10000 + i * 16ull; }
+    static uint32_t PixelHash(uint32_t i) { return 0xA0000 + i; }
+    static uint32_t VertexHash(uint32_t i) { return 0xB0000 + i % 512; }
+
+    ShaderManager pixelShaderManager;
+    ShaderManager vertexShaderManager;
+    ShaderManager computeShaderManager;
+    std::atomic_uint32_t collectorFrameCounter = 0;
+    AddonUIData uiData;
+    std::vector<uint64_t> stream;
+};
+}
+
+// A hash lookup per shader manager and a group lookup per attached shader, how binds were resolved before the dispatch records
+static void BM_BindPerStageLookups(benchmark::State& state) {
+    dispatch_fixture fixture;
+    size_t i = 0;
+
+    for (auto _ : state) {
+        const uint64_t handle = fixture.stream[i++ & (STREAM - 1)];
+
+        const uint32_t ps = fixture.pixelShaderManager.safeGetShaderHash(handle);
+        const uint32_t vs = fixture.vertexShaderManager.safeGetShaderHash(handle);
+        const uint32_t cs = fixture.computeShaderManager.safeGetShaderHash(handle);
+
+        const std::vector<ToggleGroup*>* psGroups = ps ? fixture.uiData.GetToggleGroupsForPixelShaderHash(ps) : nullptr;
+        const std::vector<ToggleGroup*>* vsGroups = vs ? fixture.uiData.GetToggleGroupsForVertexShaderHash(vs) : nullptr;
+        const std::vector<ToggleGroup*>* csGroups = cs ? fixture.uiData.GetToggleGroupsForComputeShaderHash(cs) : nullptr;
+
+        benchmark::DoNotOptimize(ps);
+        benchmark::DoNotOptimize(vs);
+        benchmark::DoNotOptimize(cs);
+        benchmark::DoNotOptimize(psGroups);
+        benchmark::DoNotOptimize(vsGroups);
+        benchmark::DoNotOptimize(csGroups);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BindPerStageLookups);
+
+static void BM_BindDispatchRecord(benchmark::State& state) {
+    dispatch_fixture fixture;
+    size_t i = 0;
+
+    for (auto _ : state) {
+        const uint64_t handle = fixture.stream[i++ & (STREAM - 1)];
+
+        PipelineDispatchData data;
+        const bool found = fixture.uiData.GetPipelineDispatchData(handle, data);
+
+        benchmark::DoNotOptimize(found);
+        benchmark::DoNotOptimize(data);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BindDispatchRecord);
+
+BENCHMARK_MAIN();
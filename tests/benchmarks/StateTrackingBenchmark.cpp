@@ -0,0 +1,116 @@
+#include "MockDevice.h"
+#include "StateTracking.h"
+#include <benchmark/benchmark.h>
+#include <vector>
+
+using namespace reshade::api;
+using namespace ShaderToggler::Tests;
+using namespace StateTracking;
+
+// state_block and descriptor_tracking are used directly, none of their event handlers are registered. Each iteration records a synthetic
+// command list of BINDS descriptor table binds and resets it, like on_reset_command_list does. peak_bytes is the descriptor memory the
+// command list holds at its end.
+
+namespace {
+constexpr uint32_t BINDS = 10000;
+constexpr uint32_t TABLES = 256; // distinct tables the binds cycle through
+constexpr uint32_t TABLE_SIZE = 8;
+constexpr pipeline_layout LAYOUT = { 0x100 };
+
+const descriptor_range RANGES[] = {
+    { 0, 0, 0, 6, shader_stage::all, 1, descriptor_type::shader_resource_view },
+    { 6, 6, 0, 2, shader_stage::all, 1, descriptor_type::constant_buffer },
+};
+
+struct bind_fixture {
+    bind_fixture() {
+        tracking = &device.create_private_data<descriptor_tracking>();
+
+        const pipeline_layout_param params[] = { pipeline_layout_param(2, RANGES), pipeline_layout_param(2, RANGES) };
+        tracking->register_pipeline_layout(LAYOUT, 2, params);
+
+        std::vector<resource_view> views(TABLES * TABLE_SIZE);
+        for (uint32_t i = 0; i < views.size(); i++) {
+            views[i] = { 100u + i };
+        }
+
+        descriptor_table_update update;
+        update.table = MockDevice::MakeTable(1, 0);
+        update.count = static_cast<uint32_t>(views.size());
+        update.type = descriptor_type::shader_resource_view;
+        update.descriptors = views.data();
+        tracking->update_descriptors(&device, 1, &update);
+
+        state.device = &device;
+        state.api = device_api::d3d12;
+    }
+
+    ~bind_fixture() { device.destroy_private_data<descriptor_tracking>(); }
+
+    MockDevice device;
+    descriptor_tracking* tracking = nullptr;
+    state_block state;
+};
+}
+
+// Every state.range(0)th bound table is read before it's replaced, like a draw the addon inspects. 0 reads none of them.
+static void BM_BindDescriptorTables(benchmark::State& state) {
+    bind_fixture fixture;
+    const uint32_t read_every = static_cast<uint32_t>(state.range(0));
+    size_t peak_bytes = 0;
+
+    for (auto _ : state) {
+        for (uint32_t i = 0; i < BINDS; i++) {
+            const descriptor_table table = MockDevice::MakeTable(1, (i % TABLES) * TABLE_SIZE);
+            fixture.state.bind_descriptor_tables(shader_stage::pixel, LAYOUT, i & 1, 1, &table);
+
+            if (read_every != 0 && i % read_every == 0) {
+                benchmark::DoNotOptimize(fixture.state.get_descriptor_at(0, i & 1, 0));
+            }
+        }
+
+        peak_bytes = std::max(peak_bytes, fixture.state.descriptor_storage.reserved_bytes());
+        fixture.state.clear();
+    }
+
+    state.SetItemsProcessed(state.iterations() * BINDS);
+    state.counters["peak_bytes"] = static_cast<double>(peak_bytes);
+}
+BENCHMARK(BM_BindDescriptorTables)->Arg(0)->Arg(16)->Arg(1);
+
+// Per bind vector snapshots kept until the command list is reset, how tables were captured before the arena. Reference for the numbers above.
+static void BM_BindDescriptorTablesVectorSnapshots(benchmark::State& state) {
+    bind_fixture fixture;
+    std::vector<std::vector<descriptor_tracking::descriptor_data>> snapshots;
+    size_t peak_bytes = 0;
+
+    for (auto _ : state) {
+        for (uint32_t i = 0; i < BINDS; i++) {
+            const descriptor_table table = MockDevice::MakeTable(1, (i % TABLES) * TABLE_SIZE);
+            std::vector<descriptor_tracking::descriptor_data> descriptors(TABLE_SIZE);
+
+            for (const descriptor_range& range : RANGES) {
+                uint32_t base_offset = 0;
+                descriptor_heap heap = { 0 };
+                fixture.device.get_descriptor_heap_offset(table, range.binding, 0, &heap, &base_offset);
+                fixture.tracking->set_all_descriptors(heap, base_offset, range.count, descriptors.data(), range.binding);
+            }
+
+            snapshots.push_back(std::move(descriptors));
+        }
+
+        size_t bytes = snapshots.capacity() * sizeof(snapshots[0]);
+        for (const auto& s : snapshots) {
+            bytes += s.capacity() * sizeof(descriptor_tracking::descriptor_data);
+        }
+
+        peak_bytes = std::max(peak_bytes, bytes);
+        snapshots.clear();
+    }
+
+    state.SetItemsProcessed(state.iterations() * BINDS);
+    state.counters["peak_bytes"] = static_cast<double>(peak_bytes);
+}
+BENCHMARK(BM_BindDescriptorTablesVectorSnapshots);
+
+BENCHMARK_MAIN();
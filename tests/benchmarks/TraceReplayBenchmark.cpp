@@ -0,0 +1,69 @@
+#include "TraceReplay.h"
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <sstream>
+
+using namespace ShaderToggler;
+using namespace ShaderToggler::Tests;
+
+// Replays an event trace through the handlers Main.cpp registers, against the mock device. Without SHADERTOGGLER_TRACE the trace is the
+// synthetic one from TraceReplay.h with the add-on configured by SyntheticTraceDesc::Config. A game capture is replayed by pointing
+// SHADERTOGGLER_TRACE at it, with the add-on's ini of that game next to it.
+
+namespace {
+constexpr uint32_t TECHNIQUES = 4;
+}
+
+static void BM_ReplayTrace(benchmark::State& state) {
+    const char* capture = std::getenv("SHADERTOGGLER_TRACE");
+    std::filesystem::path path;
+    std::string config;
+
+    if (capture != nullptr) {
+        path = std::filesystem::absolute(capture);
+
+        std::ifstream ini(path.parent_path() / HASH_FILE_NAME);
+        std::stringstream contents;
+        contents << ini.rdbuf();
+        config = contents.str();
+    } else {
+        const SyntheticTraceDesc desc;
+        path = std::filesystem::temp_directory_path() / "shadertoggler_replay_benchmark.trace";
+        WriteSyntheticTrace(path, desc);
+        config = desc.Config();
+    }
+
+    AttachAddon(config);
+
+    TraceReplay replay;
+    if (!replay.Load(path)) {
+        state.SkipWithError("Trace doesn't validate");
+        return;
+    }
+
+    for (uint32_t i = 0; i < TECHNIQUES; i++) {
+        replay.GetRuntime().AddTechnique("Technique" + std::to_string(i), "Effect.fx", true);
+    }
+
+    replay.Attach();
+
+    uint64_t events = 0;
+    for (auto _ : state) {
+        events += replay.Replay();
+    }
+
+    // items are events, techniques_per_frame shows whether the groups matched anything
+    const double frames = static_cast<double>(state.iterations()) * replay.GetFrames();
+    state.SetItemsProcessed(static_cast<int64_t>(events));
+    state.counters["frames"] = benchmark::Counter(frames, benchmark::Counter::kIsRate);
+    state.counters["techniques_per_frame"] = static_cast<double>(replay.GetRuntime().techniqueRenders) / frames;
+
+    replay.Detach();
+
+    if (capture == nullptr) {
+        std::filesystem::remove(path);
+    }
+}
+BENCHMARK(BM_ReplayTrace);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,31 @@
+// Stand-in for MinHook, hooks are never installed in tests, see windows.h
+
+#pragma once
+
+#include <windows.h>
+
+typedef enum MH_STATUS { MH_UNKNOWN = -1, MH_OK = 0, MH_ERROR_NOT_INITIALIZED = 2 } MH_STATUS;
+
+#define MH_ALL_HOOKS NULL
+
+inline MH_STATUS MH_Initialize() {
+    return MH_OK;
+}
+inline MH_STATUS MH_Uninitialize() {
+    return MH_OK;
+}
+inline MH_STATUS MH_CreateHook(LPVOID, LPVOID, LPVOID*) {
+    return MH_ERROR_NOT_INITIALIZED;
+}
+inline MH_STATUS MH_CreateHookApi(LPCWSTR, LPCSTR, LPVOID, LPVOID*) {
+    return MH_ERROR_NOT_INITIALIZED;
+}
+inline MH_STATUS MH_EnableHook(LPVOID) {
+    return MH_ERROR_NOT_INITIALIZED;
+}
+inline MH_STATUS MH_DisableHook(LPVOID) {
+    return MH_OK;
+}
+inline MH_STATUS MH_RemoveHook(LPVOID) {
+    return MH_OK;
+}
@@ -0,0 +1,20 @@
+// Stand-in for the few Direct3D 11 declarations the FFXIV shim uses, see windows.h
+
+#pragma once
+
+#include <windows.h>
+
+struct ID3D11Resource;
+
+enum D3D11_MAP { D3D11_MAP_READ = 1, D3D11_MAP_WRITE = 2, D3D11_MAP_READ_WRITE = 3, D3D11_MAP_WRITE_DISCARD = 4, D3D11_MAP_WRITE_NO_OVERWRITE = 5 };
+
+struct D3D11_MAPPED_SUBRESOURCE {
+    void* pData;
+    UINT RowPitch;
+    UINT DepthPitch;
+};
+
+struct ID3D11DeviceContext {
+    virtual HRESULT Map(ID3D11Resource* pResource, UINT Subresource, D3D11_MAP MapType, UINT MapFlags, D3D11_MAPPED_SUBRESOURCE* pMappedResource) = 0;
+    virtual void Unmap(ID3D11Resource* pResource, UINT Subresource) = 0;
+};
@@ -0,0 +1,19 @@
+// Stand-in for the D3D9 state block interface StateTracking uses, see windows.h
+
+#pragma once
+
+#include <windows.h>
+
+enum D3DSTATEBLOCKTYPE { D3DSBT_ALL = 1, D3DSBT_PIXELSTATE = 2, D3DSBT_VERTEXSTATE = 3 };
+
+struct IDirect3DStateBlock9 {
+    virtual ~IDirect3DStateBlock9() = default;
+    virtual HRESULT Capture() = 0;
+    virtual HRESULT Apply() = 0;
+    virtual unsigned long Release() = 0;
+};
+
+struct IDirect3DDevice9 {
+    virtual ~IDirect3DDevice9() = default;
+    virtual HRESULT CreateStateBlock(D3DSTATEBLOCKTYPE type, IDirect3DStateBlock9** state_block) = 0;
+};
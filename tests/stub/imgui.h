@@ -0,0 +1,245 @@
+// Stand-in for Dear ImGui. Nothing is ever drawn in tests, every widget reports that it wasn't interacted with.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#ifndef ImTextureID
+#define ImTextureID unsigned long long
+#endif
+
+struct ImVec2 {
+    float x = 0.0f, y = 0.0f;
+    constexpr ImVec2() = default;
+    constexpr ImVec2(float x, float y)
+      : x(x)
+      , y(y) {}
+};
+
+struct ImVec4 {
+    float x = 0.0f, y = 0.0f, z = 0.0f, w = 0.0f;
+    constexpr ImVec4() = default;
+    constexpr ImVec4(float x, float y, float z, float w)
+      : x(x)
+      , y(y)
+      , z(z)
+      , w(w) {}
+};
+
+#define IM_ARRAYSIZE(a) (static_cast<int>(sizeof(a) / sizeof(*(a))))
+
+typedef int ImGuiKey;
+typedef int ImGuiCol;
+typedef int ImGuiCond;
+typedef int ImGuiStyleVar;
+typedef int ImGuiWindowFlags;
+typedef int ImGuiChildFlags;
+typedef int ImGuiComboFlags;
+typedef int ImGuiSelectableFlags;
+typedef int ImGuiSliderFlags;
+typedef int ImGuiInputTextFlags;
+typedef int ImGuiTableFlags;
+typedef int ImGuiTableColumnFlags;
+typedef int ImGuiTabBarFlags;
+typedef int ImGuiTabItemFlags;
+typedef int ImGuiTreeNodeFlags;
+typedef int ImGuiMouseButton;
+typedef int ImGuiHoveredFlags;
+
+enum { ImGuiKey_Backspace = 523, ImGuiKey_Enter = 525 };
+enum { ImGuiCol_Text = 0 };
+enum { ImGuiCond_Once = 1 << 1 };
+enum { ImGuiStyleVar_ItemSpacing = 13 };
+enum { ImGuiWindowFlags_None = 0, ImGuiWindowFlags_NoScrollbar = 1 << 3, ImGuiWindowFlags_AlwaysAutoResize = 1 << 6 };
+enum { ImGuiChildFlags_None = 0, ImGuiChildFlags_AlwaysAutoResize = 1 << 6 };
+enum { ImGuiComboFlags_None = 0 };
+enum { ImGuiSelectableFlags_None = 0, ImGuiSelectableFlags_AllowDoubleClick = 1 << 2 };
+enum { ImGuiSliderFlags_None = 0, ImGuiSliderFlags_AlwaysClamp = 1 << 4 };
+enum {
+    ImGuiInputTextFlags_None = 0,
+    ImGuiInputTextFlags_CharsHexadecimal = 1 << 1,
+    ImGuiInputTextFlags_ReadOnly = 1 << 14,
+    ImGuiInputTextFlags_NoHorizontalScroll = 1 << 12,
+    ImGuiInputTextFlags_NoUndoRedo = 1 << 16
+};
+enum {
+    ImGuiTableFlags_None = 0,
+    ImGuiTableFlags_Resizable = 1 << 0,
+    ImGuiTableFlags_RowBg = 1 << 6,
+    ImGuiTableFlags_Borders = 0xF << 7,
+    ImGuiTableFlags_NoBordersInBody = 1 << 11,
+    ImGuiTableFlags_SizingStretchProp = 4 << 13,
+    ImGuiTableFlags_ScrollY = 1 << 25
+};
+enum { ImGuiTableColumnFlags_None = 0, ImGuiTableColumnFlags_WidthFixed = 1 << 4, ImGuiTableColumnFlags_NoHeaderLabel = 1 << 12 };
+enum { ImGuiTabBarFlags_None = 0 };
+enum { ImGuiTreeNodeFlags_None = 0, ImGuiTreeNodeFlags_DefaultOpen = 1 << 5 };
+
+struct ImGuiStyle {
+    ImVec2 ItemSpacing;
+    ImVec2 ItemInnerSpacing;
+    ImVec2 FramePadding;
+    ImVec2 WindowPadding;
+    float IndentSpacing = 0.0f;
+};
+
+struct ImGuiIO {
+    float DeltaTime = 1.0f / 60.0f;
+    ImVec2 DisplaySize;
+    ImVec2 MousePos;
+    ImVec2 MouseDelta;
+    bool KeyCtrl = false;
+    bool KeyShift = false;
+    bool KeyAlt = false;
+};
+
+struct ImGuiListClipper {
+    int DisplayStart = 0;
+    int DisplayEnd = 0;
+    void Begin(int, float = -1.0f) {}
+    bool Step() { return false; }
+    void End() {}
+};
+
+namespace ImGui {
+inline ImGuiStyle& GetStyle() {
+    static ImGuiStyle s_style;
+    return s_style;
+}
+inline ImGuiIO& GetIO() {
+    static ImGuiIO s_io;
+    return s_io;
+}
+
+inline bool Begin(const char*, bool* = nullptr, ImGuiWindowFlags = 0) {
+    return false;
+}
+inline void End() {}
+inline bool BeginChild(const char*, const ImVec2& = ImVec2(), ImGuiChildFlags = 0, ImGuiWindowFlags = 0) {
+    return false;
+}
+inline void EndChild() {}
+inline void SetNextWindowSize(const ImVec2&, ImGuiCond = 0) {}
+inline void SetNextWindowBgAlpha(float) {}
+inline float GetWindowWidth() {
+    return 0.0f;
+}
+inline float GetWindowHeight() {
+    return 0.0f;
+}
+inline ImVec2 GetCursorPos() {
+    return {};
+}
+inline void SetCursorPos(const ImVec2&) {}
+inline void SetCursorPosX(float) {}
+
+inline void PushID(const char*) {}
+inline void PushID(const void*) {}
+inline void PushID(int) {}
+inline void PopID() {}
+inline void PushStyleVar(ImGuiStyleVar, float) {}
+inline void PushStyleVar(ImGuiStyleVar, const ImVec2&) {}
+inline void PopStyleVar(int = 1) {}
+inline void PushStyleColor(ImGuiCol, const ImVec4&) {}
+inline void PushStyleColor(ImGuiCol, uint32_t) {}
+inline void PopStyleColor(int = 1) {}
+inline void PushItemWidth(float) {}
+inline void PopItemWidth() {}
+inline void PushTextWrapPos(float = 0.0f) {}
+inline void PopTextWrapPos() {}
+
+inline void Separator() {}
+inline void SameLine(float = 0.0f, float = -1.0f) {}
+inline void AlignTextToFramePadding() {}
+inline void Text(const char*, ...) {}
+inline void TextDisabled(const char*, ...) {}
+inline void TextWrapped(const char*, ...) {}
+inline void TextUnformatted(const char*, const char* = nullptr) {}
+inline void SetTooltip(const char*, ...) {}
+inline void BeginTooltip() {}
+inline void EndTooltip() {}
+
+inline bool Button(const char*, const ImVec2& = ImVec2()) {
+    return false;
+}
+inline bool SmallButton(const char*) {
+    return false;
+}
+inline bool Checkbox(const char*, bool*) {
+    return false;
+}
+inline bool Selectable(const char*, bool = false, ImGuiSelectableFlags = 0, const ImVec2& = ImVec2()) {
+    return false;
+}
+inline bool Selectable(const char*, bool*, ImGuiSelectableFlags = 0, const ImVec2& = ImVec2()) {
+    return false;
+}
+inline bool BeginCombo(const char*, const char*, ImGuiComboFlags = 0) {
+    return false;
+}
+inline void EndCombo() {}
+inline void SetItemDefaultFocus() {}
+inline bool SliderInt(const char*, int*, int, int, const char* = "%d", ImGuiSliderFlags = 0) {
+    return false;
+}
+inline bool SliderFloat(const char*, float*, float, float, const char* = "%.3f", ImGuiSliderFlags = 0) {
+    return false;
+}
+inline bool InputText(const char*, char*, size_t, ImGuiInputTextFlags = 0, void* = nullptr, void* = nullptr) {
+    return false;
+}
+inline bool InputTextWithHint(const char*, const char*, char*, size_t, ImGuiInputTextFlags = 0, void* = nullptr, void* = nullptr) {
+    return false;
+}
+inline void Image(ImTextureID, const ImVec2&, const ImVec2& = ImVec2(0, 0), const ImVec2& = ImVec2(1, 1), const ImVec4& = ImVec4(1, 1, 1, 1), const ImVec4& = ImVec4()) {}
+
+inline bool CollapsingHeader(const char*, ImGuiTreeNodeFlags = 0) {
+    return false;
+}
+inline bool BeginTabBar(const char*, ImGuiTabBarFlags = 0) {
+    return false;
+}
+inline void EndTabBar() {}
+inline bool BeginTabItem(const char*, bool* = nullptr, ImGuiTabItemFlags = 0) {
+    return false;
+}
+inline void EndTabItem() {}
+inline bool BeginTable(const char*, int, ImGuiTableFlags = 0, const ImVec2& = ImVec2(), float = 0.0f) {
+    return false;
+}
+inline void EndTable() {}
+inline void TableSetupColumn(const char*, ImGuiTableColumnFlags = 0, float = 0.0f, uint32_t = 0) {}
+inline void TableSetupScrollFreeze(int, int) {}
+inline void TableHeadersRow() {}
+inline void TableHeader(const char*) {}
+inline void TableNextRow(int = 0, float = 0.0f) {}
+inline bool TableNextColumn() {
+    return false;
+}
+inline void BeginDisabled(bool = true) {}
+inline void EndDisabled() {}
+
+inline void OpenPopup(const char*, int = 0) {}
+inline bool BeginPopupModal(const char*, bool* = nullptr, ImGuiWindowFlags = 0) {
+    return false;
+}
+inline void EndPopup() {}
+inline void CloseCurrentPopup() {}
+
+inline bool IsItemActive() {
+    return false;
+}
+inline bool IsItemFocused() {
+    return false;
+}
+inline bool IsItemHovered(ImGuiHoveredFlags = 0) {
+    return false;
+}
+inline bool IsMouseDoubleClicked(ImGuiMouseButton) {
+    return false;
+}
+inline bool IsKeyPressed(ImGuiKey, bool = true) {
+    return false;
+}
+}
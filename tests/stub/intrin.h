@@ -0,0 +1,14 @@
+// Stand-in for the compiler intrinsics the add-on uses, see windows.h
+
+#pragma once
+
+#include <windows.h>
+
+inline unsigned char _BitScanReverse(DWORD* index, DWORD mask) {
+    if (mask == 0) {
+        return 0;
+    }
+
+    *index = 31 - static_cast<DWORD>(__builtin_clz(mask));
+    return 1;
+}
@@ -0,0 +1,19 @@
+// Force included into every translation unit of the Linux build. Maps the Microsoft specific keywords used by the add-on to nothing and pulls in
+// the standard headers the Microsoft standard library includes transitively.
+
+#pragma once
+
+#define __declspec(x)
+#define __stdcall
+#define __cdecl
+#define __fastcall
+#define __forceinline inline
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <cstring>
+#include <string>
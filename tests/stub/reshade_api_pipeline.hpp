@@ -0,0 +1,334 @@
+/*
+ * Stand-in for the reshade add-on API, just enough of it to build the add-on sources on Linux for tests and benchmarks.
+ */
+
+#pragma once
+
+#include "reshade_api_resource.hpp"
+
+namespace reshade::api {
+enum class shader_stage : uint32_t {
+    vertex = 0x1,
+    hull = 0x2,
+    domain = 0x4,
+    geometry = 0x8,
+    pixel = 0x10,
+    compute = 0x20,
+    amplification = 0x40,
+    mesh = 0x80,
+    raygen = 0x100,
+    any_hit = 0x200,
+    closest_hit = 0x400,
+    miss = 0x800,
+    intersection = 0x1000,
+    callable = 0x2000,
+
+    all = 0x7FFFFFFF,
+    all_compute = compute,
+    all_graphics = vertex | hull | domain | geometry | pixel | amplification | mesh,
+    all_ray_tracing = raygen | any_hit | closest_hit | miss | intersection | callable
+};
+RESHADE_DEFINE_ENUM_FLAG_OPERATORS(shader_stage);
+
+enum class pipeline_stage : uint32_t {
+    vertex_shader = 0x8,
+    hull_shader = 0x10,
+    domain_shader = 0x20,
+    geometry_shader = 0x40,
+    pixel_shader = 0x80,
+    compute_shader = 0x800,
+    amplification_shader = 0x80000,
+    mesh_shader = 0x100000,
+    ray_tracing_shader = 0x200000,
+
+    input_assembler = 0x2,
+    stream_output = 0x4,
+    rasterizer = 0x100,
+    depth_stencil = 0x200,
+    output_merger = 0x400,
+
+    all = 0x7FFFFFFF,
+    all_compute = compute_shader,
+    all_graphics = vertex_shader | hull_shader | domain_shader | geometry_shader | pixel_shader | amplification_shader | mesh_shader | input_assembler |
+                   stream_output | rasterizer | depth_stencil | output_merger,
+    all_ray_tracing = ray_tracing_shader,
+    all_shader_stages = vertex_shader | hull_shader | domain_shader | geometry_shader | pixel_shader | compute_shader | amplification_shader |
+                        mesh_shader | ray_tracing_shader
+};
+RESHADE_DEFINE_ENUM_FLAG_OPERATORS(pipeline_stage);
+
+enum class descriptor_type : uint32_t {
+    sampler = 0,
+    sampler_with_resource_view = 1,
+    shader_resource_view = 2,
+    unordered_access_view = 3,
+    constant_buffer = 6,
+    shader_storage_buffer = 7,
+    acceleration_structure = 8
+};
+
+struct constant_range {
+    uint32_t offset = 0;
+    uint32_t binding = 0;
+    uint32_t dx_register_index = 0;
+    uint32_t dx_register_space = 0;
+    uint32_t count = 0;
+    shader_stage visibility = shader_stage::all;
+};
+
+struct descriptor_range {
+    uint32_t binding = 0;
+    uint32_t dx_register_index = 0;
+    uint32_t dx_register_space = 0;
+    uint32_t count = 0;
+    shader_stage visibility = shader_stage::all;
+    uint32_t array_size = 1;
+    descriptor_type type = descriptor_type::sampler;
+};
+
+enum class pipeline_layout_param_type : uint32_t { push_constants = 1, descriptor_table = 0, push_descriptors = 2, push_descriptors_with_ranges = 3 };
+
+struct pipeline_layout_param {
+    constexpr pipeline_layout_param()
+      : push_descriptors() {}
+    constexpr pipeline_layout_param(const constant_range& push_constants)
+      : type(pipeline_layout_param_type::push_constants)
+      , push_constants(push_constants) {}
+    constexpr pipeline_layout_param(const descriptor_range& push_descriptors)
+      : type(pipeline_layout_param_type::push_descriptors)
+      , push_descriptors(push_descriptors) {}
+    constexpr pipeline_layout_param(uint32_t count, const descriptor_range* ranges)
+      : type(pipeline_layout_param_type::descriptor_table)
+      , descriptor_table({ count, ranges }) {}
+
+    pipeline_layout_param_type type = pipeline_layout_param_type::push_descriptors;
+
+    union {
+        constant_range push_constants;
+        descriptor_range push_descriptors;
+        struct {
+            uint32_t count;
+            const descriptor_range* ranges;
+        } descriptor_table;
+    };
+};
+
+RESHADE_DEFINE_HANDLE(pipeline_layout);
+
+struct shader_desc {
+    const void* code = nullptr;
+    size_t code_size = 0;
+    const char* entry_point = nullptr;
+    uint32_t spec_constants = 0;
+    const uint32_t* spec_constant_ids = nullptr;
+    const uint32_t* spec_constant_values = nullptr;
+};
+
+struct input_element {
+    uint32_t location = 0;
+    const char* semantic = nullptr;
+    uint32_t semantic_index = 0;
+    api::format format = api::format::unknown;
+    uint32_t buffer_binding = 0;
+    uint32_t offset = UINT32_MAX;
+    uint32_t stride = 0;
+    uint32_t instance_step_rate = 0;
+};
+
+enum class blend_factor : uint32_t { zero, one, source_color, one_minus_source_color, dest_color, one_minus_dest_color, source_alpha, one_minus_source_alpha };
+enum class blend_op : uint32_t { add, subtract, reverse_subtract, min, max };
+enum class logic_op : uint32_t { clear, bitwise_and, noop = 5, copy = 3 };
+
+struct blend_desc {
+    bool alpha_to_coverage_enable = false;
+    bool blend_enable[8] = { false, false, false, false, false, false, false, false };
+    bool logic_op_enable[8] = { false, false, false, false, false, false, false, false };
+    blend_factor source_color_blend_factor[8] = { blend_factor::one, blend_factor::one, blend_factor::one, blend_factor::one,
+                                                  blend_factor::one, blend_factor::one, blend_factor::one, blend_factor::one };
+    blend_factor dest_color_blend_factor[8] = {};
+    blend_op color_blend_op[8] = {};
+    blend_factor source_alpha_blend_factor[8] = { blend_factor::one, blend_factor::one, blend_factor::one, blend_factor::one,
+                                                  blend_factor::one, blend_factor::one, blend_factor::one, blend_factor::one };
+    blend_factor dest_alpha_blend_factor[8] = {};
+    blend_op alpha_blend_op[8] = {};
+    api::logic_op logic_op[8] = { api::logic_op::noop, api::logic_op::noop, api::logic_op::noop, api::logic_op::noop,
+                                  api::logic_op::noop, api::logic_op::noop, api::logic_op::noop, api::logic_op::noop };
+    uint32_t blend_constant = 0xFFFFFFFF;
+    uint8_t render_target_write_mask[8] = { 0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF, 0xF };
+};
+
+enum class primitive_topology : uint32_t {
+    undefined = 0,
+    point_list = 1,
+    line_list = 2,
+    line_strip = 3,
+    triangle_list = 4,
+    triangle_strip = 5,
+    triangle_fan = 6,
+    quad_list = 7,
+    quad_strip = 8,
+    line_list_adj = 10,
+    line_strip_adj = 11,
+    triangle_list_adj = 12,
+    triangle_strip_adj = 13,
+    patch_list_01_cp = 33
+};
+
+enum class pipeline_subobject_type : uint32_t {
+    unknown,
+    vertex_shader,
+    hull_shader,
+    domain_shader,
+    geometry_shader,
+    pixel_shader,
+    compute_shader,
+    input_layout,
+    stream_output_state,
+    blend_state,
+    rasterizer_state,
+    depth_stencil_state,
+    primitive_topology,
+    depth_stencil_format,
+    render_target_formats,
+    sample_mask,
+    sample_count,
+    viewport_count,
+    dynamic_pipeline_states,
+    max_vertex_count,
+    amplification_shader,
+    mesh_shader
+};
+
+struct pipeline_subobject {
+    pipeline_subobject_type type = pipeline_subobject_type::unknown;
+    uint32_t count = 0;
+    void* data = nullptr;
+};
+
+RESHADE_DEFINE_HANDLE(pipeline);
+
+struct sampler_with_resource_view {
+    api::sampler sampler = {};
+    resource_view view = {};
+};
+
+struct buffer_range {
+    resource buffer = {};
+    uint64_t offset = 0;
+    uint64_t size = UINT64_MAX;
+};
+
+RESHADE_DEFINE_HANDLE(descriptor_table);
+
+struct descriptor_table_copy {
+    descriptor_table source_table = {};
+    uint32_t source_binding = 0;
+    uint32_t source_array_offset = 0;
+    descriptor_table dest_table = {};
+    uint32_t dest_binding = 0;
+    uint32_t dest_array_offset = 0;
+    uint32_t count = 0;
+};
+
+struct descriptor_table_update {
+    descriptor_table table = {};
+    uint32_t binding = 0;
+    uint32_t array_offset = 0;
+    uint32_t count = 0;
+    descriptor_type type = descriptor_type::sampler;
+    const void* descriptors = nullptr;
+};
+
+RESHADE_DEFINE_HANDLE(descriptor_heap);
+RESHADE_DEFINE_HANDLE(query_heap);
+
+enum class query_type { occlusion = 0, binary_occlusion = 1, timestamp = 2 };
+
+enum class dynamic_state : uint32_t {
+    unknown = 0,
+    alpha_test_enable = 1,
+    alpha_reference_value = 2,
+    alpha_func = 3,
+    srgb_write_enable = 4,
+    primitive_topology = 5,
+    sample_mask = 6,
+    alpha_to_coverage_enable = 7,
+    blend_enable = 8,
+    logic_op_enable = 9,
+    color_blend_op = 10,
+    source_color_blend_factor = 11,
+    dest_color_blend_factor = 12,
+    alpha_blend_op = 13,
+    source_alpha_blend_factor = 14,
+    dest_alpha_blend_factor = 15,
+    logic_op = 16,
+    blend_constant = 17,
+    render_target_write_mask = 18,
+    fill_mode = 19,
+    cull_mode = 20,
+    front_counter_clockwise = 21,
+    depth_bias = 22,
+    depth_bias_clamp = 23,
+    depth_bias_slope_scaled = 24,
+    depth_clip_enable = 25,
+    scissor_enable = 26,
+    multisample_enable = 27,
+    antialiased_line_enable = 28,
+    depth_enable = 29,
+    depth_write_mask = 30,
+    depth_func = 31,
+    stencil_enable = 32,
+    front_stencil_read_mask = 33,
+    front_stencil_write_mask = 34,
+    front_stencil_reference_value = 35,
+    front_stencil_func = 36,
+    front_stencil_pass_op = 37,
+    front_stencil_fail_op = 38,
+    front_stencil_depth_fail_op = 39,
+    back_stencil_read_mask = 40,
+    back_stencil_write_mask = 41,
+    back_stencil_reference_value = 42,
+    back_stencil_func = 43,
+    back_stencil_pass_op = 44,
+    back_stencil_fail_op = 45,
+    back_stencil_depth_fail_op = 46
+};
+
+struct viewport {
+    float x, y;
+    float width, height;
+    float min_depth, max_depth;
+};
+
+struct rect {
+    int32_t left, top;
+    int32_t right, bottom;
+};
+
+enum class render_pass_load_op : uint32_t { load, clear, discard, no_access };
+enum class render_pass_store_op : uint32_t { store, discard, no_access };
+
+struct render_pass_depth_stencil_desc {
+    resource_view view = {};
+    render_pass_load_op depth_load_op = render_pass_load_op::load;
+    render_pass_store_op depth_store_op = render_pass_store_op::store;
+    render_pass_load_op stencil_load_op = render_pass_load_op::load;
+    render_pass_store_op stencil_store_op = render_pass_store_op::store;
+    float clear_depth = 0.0f;
+    uint8_t clear_stencil = 0;
+};
+
+struct render_pass_render_target_desc {
+    resource_view view = {};
+    render_pass_load_op load_op = render_pass_load_op::load;
+    render_pass_store_op store_op = render_pass_store_op::store;
+    float clear_color[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+};
+
+RESHADE_DEFINE_HANDLE(fence);
+
+enum class fence_flags : uint32_t { none = 0, shared = (1 << 1), shared_nt_handle = (1 << 11), non_monitored = (1 << 12) };
+RESHADE_DEFINE_ENUM_FLAG_OPERATORS(fence_flags);
+
+enum class indirect_command { unknown, draw, draw_indexed, dispatch, dispatch_mesh, dispatch_rays, copy_acceleration_structure };
+}
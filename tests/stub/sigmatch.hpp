@@ -0,0 +1,43 @@
+// Stand-in for sigmatch, signatures never match in tests, see windows.h
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace sigmatch {
+class signature {
+  public:
+    signature() = default;
+    explicit signature(const char* pattern)
+      : _pattern(pattern) {}
+
+  private:
+    std::string _pattern;
+};
+
+class search_result {
+  public:
+    const std::vector<const std::byte*>& matches() const { return _matches; }
+
+  private:
+    std::vector<const std::byte*> _matches;
+};
+
+class module_target {
+  public:
+    search_result search(const signature&) const { return {}; }
+};
+
+class this_process_target {
+  public:
+    module_target in_module(const std::string&) const { return {}; }
+};
+}
+
+namespace sigmatch_literals {
+inline sigmatch::signature operator""_sig(const char* pattern, size_t) {
+    return sigmatch::signature(pattern);
+}
+}
@@ -0,0 +1,5 @@
+// Empty stand-in, see windows.h
+
+#pragma once
+
+#include <windows.h>
@@ -0,0 +1,39 @@
+// Stand-in for tsl::robin_map on top of the standard unordered_map. Iterators add value(), the rest of the interface the add-on uses is the same.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+namespace tsl {
+template<class Key, class T, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+class robin_map : public std::unordered_map<Key, T, Hash, KeyEqual> {
+    using base = std::unordered_map<Key, T, Hash, KeyEqual>;
+
+  public:
+    struct iterator : base::iterator {
+        iterator(typename base::iterator it)
+          : base::iterator(it) {}
+        T& value() const { return (*this)->second; }
+    };
+    struct const_iterator : base::const_iterator {
+        const_iterator(typename base::const_iterator it)
+          : base::const_iterator(it) {}
+        const_iterator(iterator it)
+          : base::const_iterator(it) {}
+        const T& value() const { return (*this)->second; }
+    };
+
+    using base::base;
+
+    iterator begin() { return base::begin(); }
+    iterator end() { return base::end(); }
+    const_iterator begin() const { return base::begin(); }
+    const_iterator end() const { return base::end(); }
+    iterator find(const Key& key) { return base::find(key); }
+    const_iterator find(const Key& key) const { return base::find(key); }
+    iterator erase(const_iterator it) { return base::erase(it); }
+    size_t erase(const Key& key) { return base::erase(key); }
+};
+}
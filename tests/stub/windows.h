@@ -0,0 +1,108 @@
+// Stand-in for the few Win32 declarations the add-on sources use, so they build on Linux for tests and benchmarks.
+
+#pragma once
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <strings.h>
+
+typedef int BOOL;
+// Windows is LLP64, DWORD stays 32 bit
+typedef uint32_t DWORD;
+typedef unsigned int UINT;
+typedef void* LPVOID;
+typedef void* HANDLE;
+typedef void* HMODULE;
+typedef void* HRSRC;
+typedef void* HGLOBAL;
+typedef void* HWND;
+typedef const char* LPCSTR;
+typedef const char* LPCTSTR;
+typedef const wchar_t* LPCWSTR;
+typedef char* LPSTR;
+typedef wchar_t WCHAR;
+typedef long HRESULT;
+
+#define ARRAYSIZE(a) (sizeof(a) / sizeof((a)[0]))
+
+#define TRUE 1
+#define FALSE 0
+#define APIENTRY
+#define WINAPI
+#define MAX_PATH 260
+
+#define DLL_PROCESS_DETACH 0
+#define DLL_PROCESS_ATTACH 1
+
+#define SUCCEEDED(hr) (static_cast<HRESULT>(hr) >= 0)
+#define FAILED(hr) (static_cast<HRESULT>(hr) < 0)
+
+#define GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS 0x4
+#define MAKEINTRESOURCE(i) (reinterpret_cast<LPCSTR>(static_cast<uintptr_t>(static_cast<uint16_t>(i))))
+#define RT_RCDATA MAKEINTRESOURCE(10)
+
+#define VK_XBUTTON2 0x06
+#define VK_SHIFT 0x10
+#define VK_CONTROL 0x11
+#define VK_MENU 0x12
+#define VK_CAPITAL 0x14
+#define VK_NUMPAD0 0x60
+#define VK_NUMPAD1 0x61
+#define VK_NUMPAD2 0x62
+#define VK_NUMPAD3 0x63
+#define VK_NUMPAD4 0x64
+#define VK_NUMPAD5 0x65
+#define VK_NUMPAD6 0x66
+#define VK_NUMPAD7 0x67
+#define VK_NUMPAD8 0x68
+#define VK_NUMPAD9 0x69
+#define VK_ADD 0x6B
+#define VK_SUBTRACT 0x6D
+
+inline BOOL GetModuleHandleEx(DWORD, LPCSTR, HMODULE* module) {
+    *module = nullptr;
+    return FALSE;
+}
+inline DWORD GetModuleFileNameA(HMODULE, char* name, DWORD size) {
+    if (size > 0) {
+        name[0] = '\0';
+    }
+    return 0;
+}
+inline DWORD GetModuleFileNameW(HMODULE, wchar_t* name, DWORD size) {
+    if (size > 0) {
+        name[0] = L'\0';
+    }
+    return 0;
+}
+inline HRSRC FindResource(HMODULE, LPCSTR, LPCSTR) {
+    return nullptr;
+}
+inline DWORD SizeofResource(HMODULE, HRSRC) {
+    return 0;
+}
+inline HGLOBAL LoadResource(HMODULE, HRSRC) {
+    return nullptr;
+}
+inline void* LockResource(HGLOBAL) {
+    return nullptr;
+}
+
+#define _stricmp strcasecmp
+#define strtok_s strtok_r
+
+inline int strncpy_s(char* dest, size_t destSize, const char* src, size_t count) {
+    const size_t length = std::min(strnlen(src, count), destSize - 1);
+    memcpy(dest, src, length);
+    dest[length] = '\0';
+    return 0;
+}
+#define _strnicmp strncasecmp
+#define _snprintf snprintf
+#define _vsnprintf vsnprintf
+#define _snprintf_s(buffer, size, ...) snprintf(buffer, size, __VA_ARGS__)
+#define _vsnprintf_s(buffer, size, format, args) vsnprintf(buffer, size, format, args)